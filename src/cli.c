@@ -8,27 +8,197 @@
 
 // Helper of `print_page()`. Return a statically allocated string that contains
 // a terminal escape sequence that matches the color of `link`.
-wchar_t *link_escseq(link_t link) {
+char *link_escseq(link_t link) {
   switch (link.type) {
   case LT_MAN:
-    return L"\e[1;32m";
+    return "\e[1;32m";
     break;
   case LT_HTTP:
-    return L"\e[1;35m";
+    return "\e[1;35m";
     break;
   case LT_EMAIL:
-    return L"\e[1;35m";
+    return "\e[1;35m";
     break;
   case LT_FILE:
-    return L"\e[1;34m";
+    return "\e[1;34m";
     break;
   default:
   case LT_LS:
-    return L"\e[1;33m";
+    return "\e[1;33m";
     break;
   }
 }
 
+// Helper of `print_line()`. Append string `src` to `out_buf`, flushing it first
+// if necessary.
+void out_puts(const char *src) {
+  const unsigned len = strlen(src); // length of `src`
+
+  if (out_len + len > BS_LONG)
+    print_flush();
+  memcpy(&out_buf[out_len], src, len);
+  out_len += len;
+}
+
+// Helper of `print_line()`. Append the multibyte representation of wide
+// character `c` to `out_buf`, flushing it first if necessary.
+void out_putwc(wchar_t c) {
+  if (out_len + MB_LEN_MAX > BS_LONG)
+    print_flush();
+
+  if (c < 0x80)
+    out_buf[out_len++] = c;
+  else {
+    mbstate_t mbs; // conversion state
+    memset(&mbs, 0, sizeof(mbs));
+    const size_t len = wcrtomb(&out_buf[out_len], c, &mbs); // bytes written
+    if ((size_t)-1 == len)
+      out_buf[out_len++] = '?';
+    else
+      out_len += len;
+  }
+}
+
+// Helper of `cli_batch()`. Read page names from `batch_path` (or from standard
+// input, if `batch_path` is `-`), one per line, and place them into `*dst`.
+// Return the number of page names. Empty lines are ignored.
+unsigned batch_read(wchar_t ***dst) {
+  char tmps[BS_LINE];    // current line
+  wchar_t tmpw[BS_LINE]; // current line (decoded)
+  unsigned ln = 0;       // number of page names
+
+  FILE *fp = 0 == strcmp(batch_path, "-") ? stdin : xfopen(batch_path, "r");
+  unsigned res_len = BS_SHORT;                // result buffer length
+  wchar_t **res = aalloc(res_len, wchar_t *); // result buffer
+
+  while (NULL != xfgets(tmps, BS_LINE, fp)) {
+    xmbstowcs(tmpw, tmps, BS_LINE);
+    wmargtrim(tmpw, NULL);
+    const unsigned start = wmargend(tmpw, NULL); // first non-whitespace char.
+    if (L'\0' == tmpw[start])
+      continue;
+    if (ln == res_len) {
+      res_len *= 2;
+      res = xreallocarray(res, res_len, sizeof(wchar_t *));
+    }
+    res[ln++] = xwcsdup(&tmpw[start]);
+  }
+
+  if (stdin != fp)
+    xfclose(fp);
+
+  *dst = res;
+  return ln;
+}
+
+// Helper of `batch_fnames()`. Place the path of the file that page `name` will
+// be written to (inside `batch_dir`) into `dst` (of length `BS_LINE`).
+void batch_fname(char *dst, const wchar_t *name) {
+  char tmp[BS_SHORT]; // `name`, as a filesystem-safe string
+  unsigned i;        // iterator
+
+  xwcstombs(tmp, name, BS_SHORT);
+  for (i = 0; '\0' != tmp[i]; i++)
+    if ((unsigned char)tmp[i] < 0x80 && !isalnum(tmp[i]) &&
+        NULL == strchr(".-_+", tmp[i]))
+      tmp[i] = '_';
+
+  snprintf(dst, BS_LINE, "%s/%s.txt", batch_dir, tmp);
+}
+
+// Helper of `batch_fnames()`. Compare the file names that `a` and `b` point to,
+// and then their positions.
+int batch_fname_cmp(const void *a, const void *b) {
+  char *const *fa = *(char *const *const *)a; // first file name
+  char *const *fb = *(char *const *const *)b; // second file name
+  const int res = strcmp(*fa, *fb);           // return value
+
+  return 0 != res ? res : (fa > fb) - (fa < fb);
+}
+
+// Helper of `cli_batch()`. Place the paths of the files that pages `names` (of
+// length `names_len`) will be written to into `*dst`. Names that map to the
+// same file (e.g. `ls(1)` and `ls 1`) would overwrite each other, so all but
+// the first of them get their position in `names` appended, after a `~` (which
+// `batch_fname()` never leaves in a name).
+void batch_fnames(char ***dst, wchar_t **names, unsigned names_len) {
+  char path[BS_LINE];                         // current path
+  char **res = aalloc(names_len, char *);     // result
+  char ***order = aalloc(names_len, char **); // `res` entries, sorted
+  unsigned i;                                 // iterator
+
+  for (i = 0; i < names_len; i++) {
+    batch_fname(path, names[i]);
+    res[i] = xstrdup(path);
+    order[i] = &res[i];
+  }
+  qsort(order, names_len, sizeof(char **), batch_fname_cmp);
+
+  char **first = order[0]; // first entry of the current run of equal names
+  for (i = 1; i < names_len; i++) {
+    if (0 != strcmp(*order[i], *first)) {
+      first = order[i];
+      continue;
+    }
+    snprintf(path, BS_LINE, "%.*s~%u.txt", (int)strlen(*order[i]) - 4,
+             *order[i], (unsigned)(order[i] - res) + 1);
+    free(*order[i]);
+    *order[i] = xstrdup(path);
+  }
+
+  free(order);
+  *dst = res;
+}
+
+// Helper of `cli_batch()`. Code run by batch mode worker `w` (out of `n`
+// workers): render pages `names[w]`, `names[w + n]`, `names[w + 2n]`, etc. (of
+// `names_len` pages total), and print them to standard output, following each
+// one with a NUL character. If `batch_dir` is set, write each page to its own
+// file instead, named after the matching entry of `fnames`. Return the number
+// of pages that could not be rendered.
+unsigned batch_worker(wchar_t **names, char **fnames, unsigned names_len,
+                      unsigned w, unsigned n) {
+  unsigned failed = 0; // number of pages that could not be rendered
+  unsigned i;          // iterator
+
+  for (i = w; i < names_len; i += n) {
+    page_len = man(&page, names[i], false);
+    if (err) {
+      fwprintf(stderr, L"%ls\n", err_msg);
+      failed++;
+    } else if (NULL != batch_dir) {
+      if (NULL == freopen(fnames[i], "w", stdout)) {
+        static wchar_t errmsg[BS_LINE];
+        wchar_t errpre[BS_LINE];
+        swprintf(errpre, BS_LINE, L"Unable to write to '%s'", fnames[i]);
+        serror(errmsg, errpre);
+        winddown(ES_OPER_ERROR, errmsg);
+      }
+      print_page(page, page_len);
+    } else
+      print_page(page, page_len);
+
+    if (NULL == batch_dir)
+      fputwc(L'\0', stdout);
+    fflush(stdout);
+
+    if (NULL != page && page_len > 0)
+      lines_free(page, page_len);
+    page = NULL;
+    page_len = 0;
+  }
+
+  return failed;
+}
+
+//
+// Global variables
+//
+
+char out_buf[BS_LONG];
+
+unsigned out_len = 0;
+
 //
 // Functions (generic)
 //
@@ -65,110 +235,254 @@ bool inside_term() {
     return isatty(STDOUT_FILENO);
 }
 
-void print_page(const line_t *lines, unsigned lines_len) {
-  unsigned ln, c, l;    // current line number, character number, link number
+void print_flush() {
+  const char *p = out_buf; // current position in `out_buf`
+  size_t len = out_len;    // number of bytes yet to be written
+
+  // Anything already buffered by stdio must precede our output
+  fflush(stdout);
+
+  while (len > 0) {
+    const ssize_t cnt = write(fileno(stdout), p, len);
+    if (-1 == cnt) {
+      if (EINTR == errno)
+        continue;
+      static wchar_t errmsg[BS_SHORT];
+      serror(errmsg, L"Unable to write()");
+      winddown(ES_OPER_ERROR, errmsg);
+    }
+    p += cnt;
+    len -= cnt;
+  }
+
+  out_len = 0;
+}
+
+void print_line(const line_t *line, const line_t *prev) {
+  unsigned c, l = 0;    // current character number, link number
   bool in_link = false; // current character is inside a link
   bool has_hyph_link =
       false;        // there's a hyphenated link from the previous line
   link_t hyph_link; // said hyphenated link
-  wchar_t *reg_escseq =
-      L""; // sequence to return from non-regular to regular text
-
-  // For each line...
-  for (ln = 0; ln < lines_len; ln++) {
-    if (inside_term()) {
-      // If inside a terminal, format the line's text using terminal escape
-      // sequences
-
-      // For each line character...
-      l = 0;
-      for (c = 0; lines[ln].text[c] != L'\0' && c < lines[ln].length; c++) {
-        // Colorize text inside links
-        if (has_hyph_link && c == hyph_link.start_next) {
-          // Hyphenated link (from previous line) start
-          in_link = true;
-          fputws(link_escseq(hyph_link), stdout);
-        } else if (has_hyph_link && c == hyph_link.end_next) {
-          // Hyphenated link (from previous line) end
-          in_link = false;
-          has_hyph_link = false;
-          fputws(L"\e[0;39m", stdout);
-        } else if (l < lines[ln].links_length &&
-                   c == lines[ln].links[l].start) {
-          // Link start
-          in_link = true;
-          fputws(link_escseq(lines[ln].links[l]), stdout);
-        } else if (l < lines[ln].links_length && c == lines[ln].links[l].end) {
-          // Link end
-          in_link = false;
-          fputws(L"\e[0;39m", stdout);
-          if (lines[ln].links[l].in_next) {
-            has_hyph_link = true;
-            hyph_link = lines[ln].links[l];
-          }
-          l++;
-        }
+  char *reg_escseq =
+      ""; // sequence to return from non-regular to regular text
+  char *cur_escseq =
+      NULL; // sequence in effect for non-regular text, if any
 
-        // For text that is outside links, make text
-        // regular/bold/italic/underline as required
-        if (!in_link) {
-          if (bget(lines[ln].reg, c)) {
-            // Regular
-            fputws(reg_escseq, stdout);
-            reg_escseq = L"";
-          } else if (bget(lines[ln].bold, c)) {
-            // Bold
-            fputws(L"\e[1m", stdout);
-            reg_escseq = L"\e[0m";
-          } else if (bget(lines[ln].italic, c)) {
-            // Italic
-            fputws(L"\e[3m", stdout);
-            reg_escseq = L"\e[23m";
-          } else if (bget(lines[ln].uline, c)) {
-            // Underline
-            fputws(L"\e[4m", stdout);
-            reg_escseq = L"\e[24m";
-          }
-        }
+  // A hyphenated link can only be the last link of its line
+  if (NULL != prev && prev->links_length > 0 &&
+      prev->links[prev->links_length - 1].in_next) {
+    has_hyph_link = true;
+    hyph_link = prev->links[prev->links_length - 1];
+  }
 
-        // Print the character
-        fputwc(lines[ln].text[c], stdout);
-      }
+  if (inside_term()) {
+    // If inside a terminal, format the line's text using terminal escape
+    // sequences
 
-      // The code above might ignore links that end at the very end of their
-      // line, therefore we handle them here
-      if (in_link) {
+    // For each line character...
+    for (c = 0; line->text[c] != L'\0' && c < line->length; c++) {
+      // Colorize text inside links
+      if (has_hyph_link && c == hyph_link.start_next) {
+        // Hyphenated link (from previous line) start
+        in_link = true;
+        out_puts(link_escseq(hyph_link));
+      } else if (has_hyph_link && c == hyph_link.end_next) {
+        // Hyphenated link (from previous line) end
         in_link = false;
-        fputws(L"\e[0;39m", stdout);
-        if (l >= 1 && l - 1 < lines[ln].links_length &&
-            lines[ln].links[l - 1].in_next) {
-          has_hyph_link = true;
-          hyph_link = lines[ln].links[l - 1];
+        has_hyph_link = false;
+        out_puts("\e[0;39m");
+        cur_escseq = NULL;
+      } else if (l < line->links_length && c == line->links[l].start) {
+        // Link start
+        in_link = true;
+        out_puts(link_escseq(line->links[l]));
+      } else if (l < line->links_length && c == line->links[l].end) {
+        // Link end
+        in_link = false;
+        out_puts("\e[0;39m");
+        cur_escseq = NULL;
+        l++;
+      }
+
+      // For text that is outside links, make text
+      // regular/bold/italic/underline as required. Escape sequences are only
+      // output when the style changes, so that each run of identically styled
+      // characters is preceded by a single sequence.
+      if (!in_link) {
+        char *escseq = NULL; // sequence for the current character
+        if (bget(line->reg, c)) {
+          // Regular
+          out_puts(reg_escseq);
+          reg_escseq = "";
+          cur_escseq = NULL;
+        } else if (bget(line->bold, c)) {
+          // Bold
+          escseq = "\e[1m";
+          reg_escseq = "\e[0m";
+        } else if (bget(line->italic, c)) {
+          // Italic
+          escseq = "\e[3m";
+          reg_escseq = "\e[23m";
+        } else if (bget(line->uline, c)) {
+          // Underline
+          escseq = "\e[4m";
+          reg_escseq = "\e[24m";
+        }
+        if (NULL != escseq && escseq != cur_escseq) {
+          out_puts(escseq);
+          cur_escseq = escseq;
         }
       }
-    } else {
-      // Otherwise, print the line's text without formatting
 
-      fputws(lines[ln].text, stdout);
+      // Print the character
+      out_putwc(line->text[c]);
     }
 
-    // At line end, restore text to regular and print a newline
-    fputws(reg_escseq, stdout);
-    fputwc(L'\n', stdout);
+    // The code above might ignore links that end at the very end of their
+    // line, therefore we handle them here
+    if (in_link)
+      out_puts("\e[0;39m");
+  } else {
+    // Otherwise, print the line's text without formatting
+
+    for (c = 0; line->text[c] != L'\0' && c < line->length; c++)
+      out_putwc(line->text[c]);
   }
+
+  // At line end, restore text to regular and print a newline
+  out_puts(reg_escseq);
+  out_putwc(L'\n');
+}
+
+void print_page(const line_t *lines, unsigned lines_len) {
+  unsigned ln; // iterator
+
+  for (ln = 0; ln < lines_len; ln++)
+    print_line(line_at(lines, ln), ln > 0 ? line_at(lines, ln - 1) : NULL);
+
+  print_flush();
 }
 
 //
 // Functions (handlers)
 //
 
+void cli_batch() {
+  wchar_t **names;                               // page names
+  const unsigned names_len = batch_read(&names); // number of page names
+  char **fnames = NULL; // output file paths (if `batch_dir` is set)
+  bool failed = false;  // some pages could not be rendered
+  unsigned i, w;       // iterators
+  int c;               // current output character
+  int status;          // worker exit status
+
+  if (0 == names_len) {
+    free(names);
+    return;
+  }
+
+  // Number of workers
+  const unsigned n = MIN(
+      names_len,
+      batch_jobs > 0 ? batch_jobs : MAX(1, sysconf(_SC_NPROCESSORS_ONLN)));
+  pid_t *pids = aalloc(n, pid_t);   // worker process IDs
+  FILE **pipes = aalloc(n, FILE *); // pipes workers write their output to
+
+  // Workers don't write to a terminal, so they need to be told whether to use
+  // terminal escape sequences. Otherwise, each page gets its own file name.
+  if (NULL == batch_dir)
+    config.misc.cli_force_color = inside_term();
+  else
+    batch_fnames(&fnames, names, names_len);
+
+  // Start the workers
+  fflush(stdout);
+  fflush(stderr);
+  for (w = 0; w < n; w++) {
+    int fds[2]; // pipe file descriptors
+    if (NULL == batch_dir)
+      xpipe(fds);
+    pids[w] = xfork();
+    if (0 == pids[w]) {
+      if (NULL == batch_dir) {
+        for (i = 0; i < w; i++)
+          fclose(pipes[i]);
+        close(fds[0]);
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[1]);
+      }
+      const unsigned worker_failed =
+          batch_worker(names, fnames, names_len, w, n);
+      wafree(names, names_len);
+      if (NULL != fnames)
+        safree(fnames, names_len);
+      free(pids);
+      free(pipes);
+      winddown(worker_failed > 0 ? ES_NOT_FOUND : ES_SUCCESS, NULL);
+    }
+    if (NULL == batch_dir) {
+      close(fds[1]);
+      pipes[w] = fdopen(fds[0], "r");
+    }
+  }
+
+  // Copy the workers' output to standard output, in the order pages were
+  // requested. Page `i` has been rendered by worker `i % n`.
+  if (NULL == batch_dir) {
+    for (i = 0; i < names_len; i++) {
+      w = i % n;
+      if (NULL == pipes[w])
+        continue;
+      while (EOF != (c = getc(pipes[w])) && '\0' != c)
+        putc(c, stdout);
+      if (EOF == c) {
+        // The worker has died
+        fclose(pipes[w]);
+        pipes[w] = NULL;
+      }
+    }
+    fflush(stdout);
+  }
+
+  // Wait for the workers to finish
+  for (w = 0; w < n; w++) {
+    if (NULL != pipes[w])
+      fclose(pipes[w]);
+    if (-1 == waitpid(pids[w], &status, 0) || !WIFEXITED(status) ||
+        ES_SUCCESS != WEXITSTATUS(status))
+      failed = true;
+  }
+
+  wafree(names, names_len);
+  if (NULL != fnames)
+    safree(fnames, names_len);
+  free(pids);
+  free(pipes);
+
+  if (failed)
+    winddown(ES_NOT_FOUND, NULL);
+}
+
 // Main handler for the CLI
 void cli() {
   configure();
-  late_init();
   init_cli();
 
-  populate_page();
+  // Global apropos/whatis output can be huge, so it is rendered locally and
+  // printed as it is produced. Otherwise, let a running server render the page,
+  // if possible, and only render it ourselves if not.
+  const bool global = config.misc.global_apropos || config.misc.global_whatis;
+  if (NULL != batch_path || global || !server_fetch()) {
+    late_init();
+    if (NULL != batch_path) {
+      cli_batch();
+      return;
+    }
+    page_stream = true;
+    populate_page();
+    print_flush();
+  }
   if (err)
     winddown(ES_NOT_FOUND, err_msg);
 
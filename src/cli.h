@@ -6,6 +6,14 @@
 
 #include "lib.h"
 
+//
+// Global variables
+//
+
+// Output buffer of `print_line()`, and number of bytes in it
+extern char out_buf[BS_LONG];
+extern unsigned out_len;
+
 //
 // Functions (generic)
 //
@@ -18,13 +26,28 @@ extern void init_cli();
 // return value of `isatty()`.
 extern bool inside_term();
 
-// Print the contents of `lines` (of length `lines_len`) to standard output
+// Write out any output buffered by `print_line()`
+extern void print_flush();
+
+// Print `line` to standard output, given that the line printed before it was
+// `prev` (or NULL, for the first line). Output is buffered; it is written out
+// when the buffer is full, or when `print_flush()` is called.
+extern void print_line(const line_t *line, const line_t *prev);
+
+// Print the contents of `lines` (of length `lines_len`) to standard output, and
+// flush any output buffered by `print_line()`
 extern void print_page(const line_t *lines, unsigned lines_len);
 
 //
 // Functions (handlers)
 //
 
+// Handler for the CLI's batch mode (`-B`). Read page names from `batch_path`,
+// render them using `batch_jobs` worker processes, and print them to standard
+// output (in the order they were requested), or write them to separate files
+// inside `batch_dir`.
+extern void cli_batch();
+
 // Main handler for the CLI
 extern void cli();
 
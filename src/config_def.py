@@ -76,6 +76,9 @@ config_def = {
         "fallback": (("colour",), ("white", "black", "false"), False, "Fallback for B&W terminals"),
         "text": (("colour",), ("white", "black", "false"), True, "Page text"),
         "search": (("colour",), ("black", "white", "false"), True, "Matched search terms in page text"),
+        "search_2": (("colour",), ("black", "yellow", "false"), True, "Matched search terms in page text (second term)"),
+        "search_3": (("colour",), ("black", "green", "false"), True, "Matched search terms in page text (third term)"),
+        "search_4": (("colour",), ("black", "magenta", "false"), True, "Matched search terms in page text (fourth term)"),
         "mark": (("colour",), ("white", "cyan", "false"), True, "Marked text"),
         "link_man": (("colour",), ("green", "black", "false"), True, "Links to manual pages"),
         "link_man_f": (("colour",), ("black", "green", "false"), True, "Links to manual pages (focused)"),
@@ -126,6 +129,7 @@ config_def = {
         "sp_open": (("key",), ("O"), True, "Open a manual page using a dialog"),
         "sp_apropos": (("key",), ("A"), True, "Perform apropos using a dialog"),
         "sp_whatis": (("key",), ("W"), True, "Perform whatis using a dialog"),
+        "sp_fulltext": (("key",), ("F"), True, "Perform full-text search using a dialog"),
         "index": (("key",), ("i", "I"), True, "Go to index (home) page"),
         "back": (("key",), ("KEY_BACKSPACE", "BS", "["), True, "Go back one step in history"),
         "fwrd": (("key",), ("]"), True, "Go forward one step in history"),
@@ -170,7 +174,9 @@ config_def = {
         "hyphenate": (("bool",), ("true",), True, "Hyphenate long words in manual pages"),
         "justify": (("bool",), ("true",), True, "Justify manual pages text"),
         "icase_search": (("bool",), ("true",), True, "Ignore case for page text search"),
+        "regex_search": (("bool",), ("false",), True, "Treat page text search strings as extended regular expressions"),
         "sp_substrings": (("bool",), ("true",), True, "Include substring matches in incremental search results"),
+        "sp_fuzzy": (("bool",), ("false",), True, "Rank incremental search results by fuzzy matching"),
     },
     "misc": {
         "program_name": (("string",), None, False, "Program executable basename (discovered automatically)"),
@@ -189,6 +195,8 @@ config_def = {
         "reset_after_viewer": (("bool",), ("true",), True, "Re-initialize curses after viewing a file"),
         "terminfo_reset": (("bool",), ("false",), True, "Reset the terminal using the strings provided by terminfo on shutdown"),
         "history_size": (("int", 0, 256 * 1024), ("65536",), True, "Maximum number of history entries"),
+        "builtin_formatter": (("bool",), ("false",), True, "Format manual pages without invoking man(1) whenever possible"),
+        "save_session": (("bool",), ("false",), True, "Save history and the current page on exit, for -R / --resume"),
         "cli_force_color": (("bool",), ("false",), False, "-z / --cli-force-color option was passed"),
         "global_whatis": (("bool",), ("false",), False, "-a / --all option was passed"),
         "global_apropos": (("bool",), ("false",), False, "-k / --global-whatis option was passed")
@@ -0,0 +1,714 @@
+// Full-text index of all manual pages (implementation)
+
+#include "lib.h"
+
+//
+// Types
+//
+
+// A term, as gathered by `ft_update()`
+typedef struct {
+  char *word;         // the term
+  unsigned *docs;     // documents it appears in
+  unsigned *offs;     // offsets of its first occurrence in each document
+  unsigned docs_len;  // length of `docs` and `offs`
+  unsigned docs_size; // allocated length of `docs` and `offs`
+} ft_bterm_t;
+
+// The terms gathered by `ft_update()`, as a hash table with linear probing
+typedef struct {
+  ft_bterm_t *terms; // the table
+  unsigned len;      // number of terms
+  unsigned size;     // table size (a power of two)
+} ft_btable_t;
+
+//
+// Global variables
+//
+
+ft_t ft = {NULL, 0, NULL, NULL, NULL, NULL, NULL};
+
+//
+// Helper macros and functions
+//
+
+// Helper of `ft_update()`. Place `v` into `buf` (of length `buf_len` and
+// allocated length `buf_size`) as a variable-length integer.
+#define ft_put_varint(buf, buf_len, buf_size, v)                               \
+  {                                                                            \
+    unsigned vv = v;                                                           \
+    if (buf_len + 5 > buf_size) {                                              \
+      buf_size *= 2;                                                           \
+      buf = xreallocarray(buf, buf_size, sizeof(char));                        \
+    }                                                                          \
+    while (vv >= 0x80) {                                                       \
+      buf[buf_len++] = (char)(0x80 | (vv & 0x7f));                             \
+      vv >>= 7;                                                                \
+    }                                                                          \
+    buf[buf_len++] = (char)vv;                                                 \
+  }
+
+// Helper of `ft_query()`. Read a variable-length integer from `*p`, and advance
+// `*p` past it.
+unsigned ft_get_varint(const char **p) {
+  unsigned res = 0; // return value
+  unsigned shift = 0;
+
+  while (true) {
+    const unsigned char b = **p;
+    (*p)++;
+    res |= (b & 0x7f) << shift;
+    if (0 == (b & 0x80))
+      return res;
+    shift += 7;
+  }
+}
+
+// Helper of `ft_add()`. Return the FNV-1a hash of `word`.
+unsigned ft_hash(const char *word) {
+  unsigned res = 2166136261u; // return value
+
+  for (; '\0' != *word; word++)
+    res = (res ^ (unsigned char)*word) * 16777619u;
+
+  return res;
+}
+
+// Helper of `ft_text()`. Record that `word` appears in document `doc` at offset
+// `off`, unless it has already been seen in that document.
+void ft_add(ft_btable_t *bt, const char *word, unsigned doc, unsigned off) {
+  unsigned i; // iterator
+
+  // Grow the table, if it's more than half full
+  if (2 * (bt->len + 1) > bt->size) {
+    const unsigned old_size = bt->size;  // old table size
+    ft_bterm_t *old_terms = bt->terms;   // old table
+    bt->size = 0 == old_size ? 1 << 16 : 2 * old_size;
+    bt->terms = aalloc(bt->size, ft_bterm_t);
+    for (i = 0; i < old_size; i++)
+      if (NULL != old_terms[i].word) {
+        unsigned h = ft_hash(old_terms[i].word) & (bt->size - 1);
+        while (NULL != bt->terms[h].word)
+          h = (h + 1) & (bt->size - 1);
+        bt->terms[h] = old_terms[i];
+      }
+    if (NULL != old_terms)
+      free(old_terms);
+  }
+
+  // Find `word`, adding it if necessary
+  unsigned h = ft_hash(word) & (bt->size - 1); // position of `word`
+  while (NULL != bt->terms[h].word && 0 != strcmp(bt->terms[h].word, word))
+    h = (h + 1) & (bt->size - 1);
+  ft_bterm_t *t = &bt->terms[h]; // entry for `word`
+  if (NULL == t->word) {
+    t->word = xstrdup(word);
+    t->docs_size = 4;
+    t->docs = aalloc(t->docs_size, unsigned);
+    t->offs = aalloc(t->docs_size, unsigned);
+    bt->len++;
+  } else if (t->docs[t->docs_len - 1] == doc)
+    return;
+
+  // Add the posting
+  if (t->docs_len == t->docs_size) {
+    t->docs_size *= 2;
+    t->docs = xreallocarray(t->docs, t->docs_size, sizeof(unsigned));
+    t->offs = xreallocarray(t->offs, t->docs_size, sizeof(unsigned));
+  }
+  t->docs[t->docs_len] = doc;
+  t->offs[t->docs_len] = off;
+  t->docs_len++;
+}
+
+// Helper of `ft_update()`. Add the words in `text` (the UTF-8 text of document
+// `doc`) to `bt`.
+void ft_text(ft_btable_t *bt, const char *text, unsigned doc) {
+  const char *p = text;         // current position in `text`
+  wchar_t wword[FT_WORD + 1];   // current word
+  unsigned wword_len = 0;       // length of `wword`
+  unsigned wword_off = 0;       // offset of `wword` in `text`
+  bool overlong = false;        // current word is longer than `FT_WORD`
+  char word[MB_LEN_MAX * (FT_WORD + 1)]; // `wword`, UTF-8 encoded
+  mbstate_t mbs;                // conversion state
+  wchar_t c;                    // current character
+
+  memset(&mbs, 0, sizeof(mbs));
+  while (true) {
+    size_t clen = mbrtowc(&c, p, MB_LEN_MAX, &mbs); // length of `c` in `text`
+    if ((size_t)-1 == clen || (size_t)-2 == clen) {
+      memset(&mbs, 0, sizeof(mbs));
+      c = L'?';
+      clen = 1;
+    }
+    if (L'\0' != c && (iswalnum(c) || L'_' == c)) {
+      // Inside a word
+      if (0 == wword_len && !overlong)
+        wword_off = p - text;
+      if (wword_len < FT_WORD)
+        wword[wword_len++] = towlower(c);
+      else
+        overlong = true;
+    } else {
+      // Outside a word; record the one that just ended
+      if (wword_len > 1 && !overlong) {
+        wword[wword_len] = L'\0';
+        if ((size_t)-1 != wcstombs(word, wword, sizeof(word)))
+          ft_add(bt, word, doc, wword_off);
+      }
+      wword_len = 0;
+      overlong = false;
+      if (L'\0' == c)
+        break;
+    }
+    p += clen;
+  }
+}
+
+// Helper of `ft_update()`. Place the text of `lines` (of length `lines_len`),
+// except for the first and last line (i.e. the page's header and footer), with
+// all runs of white space replaced by a single space, into `*dst`, UTF-8
+// encoded.
+void ft_lines_text(char **dst, const line_t *lines, unsigned lines_len) {
+  unsigned ln, c;            // iterators
+  unsigned len = 0;          // length of `res`
+  unsigned res_size = BS_LONG; // allocated length of `res`
+  char *res = aalloc(res_size, char); // result
+  char tmp[MB_LEN_MAX];      // current character, UTF-8 encoded
+  mbstate_t mbs;             // conversion state
+  bool space = false;        // a space is pending
+
+  for (ln = 1; ln + 1 < lines_len; ln++) {
+    for (c = 0; c <= lines[ln].length; c++) {
+      const wchar_t wc = c < lines[ln].length ? lines[ln].text[c] : L' ';
+      if (L'\0' == wc || iswspace(wc)) {
+        space = len > 0;
+        continue;
+      }
+      memset(&mbs, 0, sizeof(mbs));
+      size_t clen = wcrtomb(tmp, wc, &mbs); // length of `tmp`
+      if ((size_t)-1 == clen) {
+        tmp[0] = '?';
+        clen = 1;
+      }
+      if (len + clen + 2 > res_size) {
+        res_size *= 2;
+        res = xreallocarray(res, res_size, sizeof(char));
+      }
+      if (space)
+        res[len++] = ' ';
+      space = false;
+      memcpy(&res[len], tmp, clen);
+      len += clen;
+    }
+  }
+  res[len] = '\0';
+
+  *dst = res;
+}
+
+// Helper of `ft_update()`. Write `str` (and its terminating '\0') into `fp`,
+// and return the offset it was written at.
+size_t ft_put_str(FILE *fp, const char *str) {
+  const size_t res = ftell(fp); // return value
+
+  xfwrite(str, sizeof(char), strlen(str) + 1, fp);
+  return res;
+}
+
+// Helper of `ft_update()`. Compare `aw_all` members at the indexes pointed to
+// by `a` and `b`, by page name and section.
+int ft_aw_cmp(const void *a, const void *b) {
+  const aprowhat_t *awa = &aw_all[*(const unsigned *)a];
+  const aprowhat_t *awb = &aw_all[*(const unsigned *)b];
+  const int res = wcscmp(awa->page, awb->page); // return value
+
+  return 0 != res ? res : wcscmp(awa->section, awb->section);
+}
+
+// Helper of `ft_update()`. Compare the terms pointed to by `a` and `b`.
+int ft_bterm_cmp(const void *a, const void *b) {
+  return strcmp((*(ft_bterm_t *const *)a)->word,
+                (*(ft_bterm_t *const *)b)->word);
+}
+
+// Helper of `ft_update()`. Return the number of the document in `ft` for the
+// page called `page` in section `section`, or -1 if there's none.
+int ft_find_doc(const char *page, const char *section) {
+  int lo = 0, hi = NULL == ft.data ? -1 : (int)ft.hdr->docs_len - 1; // bounds
+
+  while (lo <= hi) {
+    const int mid = lo + (hi - lo) / 2;
+    int res = strcmp(page, &ft.str[ft.docs[mid].page]);
+    if (0 == res)
+      res = strcmp(section, &ft.str[ft.docs[mid].section]);
+    if (0 == res)
+      return mid;
+    if (res < 0)
+      hi = mid - 1;
+    else
+      lo = mid + 1;
+  }
+
+  return -1;
+}
+
+// Helper of `ft_query()`. Return the term in `ft` that is equal to `word`, or
+// NULL if there's none.
+const ft_term_t *ft_find_term(const char *word) {
+  int lo = 0, hi = (int)ft.hdr->terms_len - 1; // bounds of the range to search
+
+  while (lo <= hi) {
+    const int mid = lo + (hi - lo) / 2;
+    const int res = strcmp(word, &ft.str[ft.terms[mid].word]);
+    if (0 == res)
+      return &ft.terms[mid];
+    if (res < 0)
+      hi = mid - 1;
+    else
+      lo = mid + 1;
+  }
+
+  return NULL;
+}
+
+// Helper of `ft_query()`. Place up to `FT_SNIPPET` characters of `text`,
+// starting `FT_CONTEXT` characters before offset `off`, into `dst` (of length
+// `dst_len`).
+void ft_snippet(wchar_t *dst, unsigned dst_len, const char *text,
+                unsigned off) {
+  unsigned beg = off, end = off; // snippet bounds in `text`
+  unsigned cnt;                  // number of characters
+  char tmp[MB_LEN_MAX * FT_SNIPPET + 1]; // the snippet, UTF-8 encoded
+  wchar_t wtmp[FT_SNIPPET + 1];          // the snippet
+
+  // Move `beg` back by `FT_CONTEXT` characters (skipping UTF-8 continuation
+  // bytes), and `end` forward so that the snippet is `FT_SNIPPET` characters
+  // long
+  for (cnt = 0; beg > 0 && cnt < FT_CONTEXT; cnt++)
+    do
+      beg--;
+    while (beg > 0 && 0x80 == ((unsigned char)text[beg] & 0xc0));
+  end = beg;
+  for (cnt = 0; '\0' != text[end] && cnt < FT_SNIPPET; cnt++)
+    do
+      end++;
+    while (0x80 == ((unsigned char)text[end] & 0xc0));
+
+  memcpy(tmp, &text[beg], end - beg);
+  tmp[end - beg] = '\0';
+  if ((size_t)-1 == mbstowcs(wtmp, tmp, FT_SNIPPET + 1))
+    wcslcpy(wtmp, L"", FT_SNIPPET + 1);
+  wtmp[FT_SNIPPET] = L'\0';
+  swprintf(dst, dst_len, L"%ls%ls%ls", beg > 0 ? L"..." : L"", wtmp,
+           '\0' != text[end] ? L"..." : L"");
+}
+
+//
+// Functions (generic)
+//
+
+void ft_path(char *dst, unsigned dst_len) {
+  const char *dir = getenv("XDG_CACHE_HOME");
+
+  if (NULL != dir && '\0' != dir[0])
+    snprintf(dst, dst_len, "%s/qman/fulltext.idx", dir);
+  else
+    snprintf(dst, dst_len, "%s/.cache/qman/fulltext.idx",
+             NULL != getenv("HOME") ? getenv("HOME") : "");
+}
+
+void ft_mkdirs(const char *path) {
+  char tmp[BS_LINE]; // parent directory being created
+  char *p;           // current position in `tmp`
+
+  snprintf(tmp, BS_LINE, "%s", path);
+  for (p = &tmp[1]; '\0' != *p; p++)
+    if ('/' == *p) {
+      *p = '\0';
+      if (-1 == mkdir(tmp, S_IRWXU) && EEXIST != errno) {
+        static wchar_t errmsg[BS_LINE];
+        wchar_t errpre[BS_LINE];
+        swprintf(errpre, BS_LINE, L"Unable to create directory '%s'", tmp);
+        serror(errmsg, errpre);
+        winddown(ES_OPER_ERROR, errmsg);
+      }
+      *p = '/';
+    }
+}
+
+bool ft_open() {
+  char path[BS_LINE]; // index path
+  struct stat st;     // index file status
+
+  if (NULL != ft.data)
+    return true;
+
+  ft_path(path, BS_LINE);
+  const int fd = open(path, O_RDONLY);
+  if (-1 == fd)
+    return false;
+  if (-1 == fstat(fd, &st) || st.st_size < (off_t)sizeof(ft_header_t)) {
+    close(fd);
+    return false;
+  }
+  void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (MAP_FAILED == data)
+    return false;
+
+  // Make sure the file is an index, and that it's complete
+  const ft_header_t *hdr = data;
+  if (0 != memcmp(hdr->magic, FT_MAGIC, sizeof(hdr->magic)) ||
+      hdr->size != (size_t)st.st_size || hdr->str_off > hdr->size) {
+    munmap(data, st.st_size);
+    return false;
+  }
+
+  ft.data = data;
+  ft.size = st.st_size;
+  ft.hdr = hdr;
+  ft.docs = (const ft_doc_t *)&ft.data[hdr->docs_off];
+  ft.terms = (const ft_term_t *)&ft.data[hdr->terms_off];
+  ft.post = &ft.data[hdr->post_off];
+  ft.str = &ft.data[hdr->str_off];
+  return true;
+}
+
+void ft_close() {
+  if (NULL != ft.data)
+    munmap((void *)ft.data, ft.size);
+  ft.data = NULL;
+  ft.size = 0;
+}
+
+unsigned ft_query(aprowhat_t **dst, const wchar_t *args) {
+  unsigned i, j, k;                       // iterators
+  const ft_term_t *terms[BS_SHORT];       // terms that correspond to `args`
+  unsigned terms_len = 0;                 // length of `terms`
+  wchar_t wword[FT_WORD + 1];             // current word of `args`
+  unsigned wword_len = 0;                 // length of `wword`
+  char word[MB_LEN_MAX * (FT_WORD + 1)];  // `wword`, UTF-8 encoded
+  bool found = true;                      // all words of `args` are indexed
+
+  *dst = NULL;
+  err = false;
+
+  if (!ft_open()) {
+    err = true;
+    swprintf(err_msg, BS_LINE,
+             L"No full-text index found; run '%s --update-index' first",
+             config.misc.program_name);
+    return 0;
+  }
+
+  // Split `args` into words, and look each of them up
+  for (i = 0; terms_len < BS_SHORT; i++) {
+    const wchar_t c = args[i];
+    if (L'\0' != c && (iswalnum(c) || L'_' == c)) {
+      if (wword_len < FT_WORD)
+        wword[wword_len++] = towlower(c);
+      continue;
+    }
+    if (wword_len > 1) {
+      wword[wword_len] = L'\0';
+      xwcstombs(word, wword, sizeof(word));
+      terms[terms_len] = ft_find_term(word);
+      if (NULL == terms[terms_len])
+        found = false;
+      terms_len++;
+    }
+    wword_len = 0;
+    if (L'\0' == c)
+      break;
+  }
+  if (0 == terms_len || !found) {
+    err = true;
+    swprintf(err_msg, BS_LINE, L"Full-text search for %ls: nothing apropriate",
+             args);
+    return 0;
+  }
+
+  // Start with the postings of the rarest term, and keep only the documents
+  // that also appear in the postings of every other term
+  unsigned base = 0; // the rarest term
+  for (k = 1; k < terms_len; k++)
+    if (terms[k]->post_len < terms[base]->post_len)
+      base = k;
+  unsigned docs_len = terms[base]->post_len;    // number of documents
+  unsigned *docs = aalloc(docs_len, unsigned);  // documents
+  unsigned *offs = aalloc(docs_len, unsigned);  // first match in each
+  const char *p = &ft.post[terms[base]->post];  // current posting
+  unsigned doc = 0;                             // current document
+  for (i = 0; i < docs_len; i++) {
+    doc += ft_get_varint(&p);
+    docs[i] = doc;
+    offs[i] = ft_get_varint(&p);
+  }
+  for (k = 0; k < terms_len && docs_len > 0; k++) {
+    if (k == base)
+      continue;
+    p = &ft.post[terms[k]->post];
+    doc = 0;
+    unsigned left = terms[k]->post_len; // postings left
+    unsigned kept = 0;                  // documents kept
+    bool got = false;                   // `doc` has been read from `p`
+    for (i = 0; i < docs_len; i++) {
+      // (The last posting read may match a later document of `docs`, so the
+      // loop goes on after all postings have been read)
+      while (left > 0 && (!got || doc < docs[i])) {
+        doc += ft_get_varint(&p);
+        ft_get_varint(&p);
+        left--;
+        got = true;
+      }
+      if (got && doc == docs[i]) {
+        docs[kept] = docs[i];
+        offs[kept] = offs[i];
+        kept++;
+      }
+    }
+    docs_len = kept;
+  }
+
+  // Produce the results
+  aprowhat_t *res = aalloc(MAX(1, docs_len), aprowhat_t); // result
+  for (i = 0; i < docs_len; i++) {
+    const ft_doc_t *d = &ft.docs[docs[i]];
+    wchar_t tmp[BS_LINE]; // temporary
+    j = xmbstowcs(tmp, &ft.str[d->page], BS_LINE);
+    res[i].page = walloc(j);
+    wcslcpy(res[i].page, tmp, j + 1);
+    j = xmbstowcs(tmp, &ft.str[d->section], BS_LINE);
+    res[i].section = walloc(j);
+    wcslcpy(res[i].section, tmp, j + 1);
+    j = wcslen(res[i].page) + wcslen(res[i].section) + 2;
+    res[i].ident = walloc(j);
+    swprintf(res[i].ident, j + 1, L"%ls(%ls)", res[i].page, res[i].section);
+    ft_snippet(tmp, BS_LINE, &ft.str[d->text], offs[i]);
+    res[i].descr = xwcsdup(tmp);
+  }
+  free(docs);
+  free(offs);
+
+  if (0 == docs_len) {
+    free(res);
+    res = NULL;
+    err = true;
+    swprintf(err_msg, BS_LINE, L"Full-text search for %ls: nothing apropriate",
+             args);
+  }
+
+  *dst = res;
+  return docs_len;
+}
+
+unsigned fulltext(line_t **dst, const wchar_t *args, const wchar_t *key,
+                  const wchar_t *title) {
+  aprowhat_t *aw;
+  unsigned aw_len = ft_query(&aw, args);
+
+  wchar_t **sc;
+  unsigned sc_len = aprowhat_sections(&sc, aw, aw_len);
+
+  time_t now = time(NULL);
+  wchar_t date[BS_SHORT];
+  wcsftime(date, BS_SHORT, L"%x", gmtime(&now));
+
+  line_t *res;
+  unsigned res_len =
+      aprowhat_render(&res, aw, aw_len, (const wchar_t **)sc, sc_len, key,
+                      title, config.misc.program_version, date, true);
+
+  aw_last_keep(RT_FULLTEXT, args, sc, sc_len);
+
+  *dst = res;
+  return res_len;
+}
+
+//
+// Functions (handlers)
+//
+
+void ft_update() {
+  unsigned i, j;                 // iterators
+  char path[BS_LINE];            // index path
+  char tpath[BS_LINE + 8];       // temporary index path
+  char gpath[BS_LINE];           // current page's source path
+  wchar_t args[BS_LINE];         // current page's `man()` arguments
+  char page_mb[BS_LINE], section_mb[BS_LINE]; // current page and section
+  struct stat st;                // current page's source file status
+  ft_btable_t bt = {NULL, 0, 0}; // gathered terms
+  unsigned formatted = 0, reused = 0; // numbers of pages formatted and reused
+  const bool tty = isatty(STDERR_FILENO); // report progress
+
+  configure();
+  late_init();
+
+  // Pages are formatted without hyphenation or justification, and as wide as
+  // possible, so that words are kept whole
+  config.capabilities.hyphenate = false;
+  config.capabilities.justify = false;
+  config.capabilities.sections_on_top = false;
+  config.layout.main_width = BS_SHORT;
+  config.layout.lmargin = 0;
+  config.layout.rmargin = 0;
+
+  // The previous index (if any) supplies the text of unchanged pages
+  ft_path(path, BS_LINE);
+  ft_open();
+
+  // Visit pages in the order they will be stored in
+  unsigned *order = aalloc(MAX(1, aw_all_len), unsigned); // order of `aw_all`
+  for (i = 0; i < aw_all_len; i++)
+    order[i] = i;
+  qsort(order, aw_all_len, sizeof(unsigned), ft_aw_cmp);
+
+  unsigned docs_size = MAX(1, aw_all_len);          // allocated docs
+  ft_doc_t *docs = aalloc(docs_size, ft_doc_t);     // documents table
+  unsigned docs_len = 0;                            // number of documents
+  char **paths = aalloc(docs_size, char *);         // source path per document
+  FILE *sfp = xtmpfile();                           // strings
+
+  for (j = 0; j < aw_all_len; j++) {
+    const aprowhat_t *aw = &aw_all[order[j]];
+    char *text = NULL; // page text
+    if (tty)
+      fwprintf(stderr, L"\rIndexing page %u of %u", j + 1, aw_all_len);
+
+    // Skip duplicate entries
+    if (j > 0 && 0 == ft_aw_cmp(&order[j - 1], &order[j]))
+      continue;
+    xwcstombs(page_mb, aw->page, BS_LINE);
+    xwcstombs(section_mb, aw->section, BS_LINE);
+
+    // If the page was in the previous index and its source file hasn't
+    // changed, reuse its text; otherwise, locate and format the page
+    const int od = ft_find_doc(page_mb, section_mb);
+    if (-1 != od && 0 == stat(&ft.str[ft.docs[od].path], &st) &&
+        st.st_mtime == ft.docs[od].mtime) {
+      snprintf(gpath, BS_LINE, "%s", &ft.str[ft.docs[od].path]);
+      text = xstrdup(&ft.str[ft.docs[od].text]);
+      reused++;
+    } else {
+      swprintf(args, BS_LINE, L"'%ls'", aw->ident);
+      if (!man_loc(gpath, BS_LINE, args, false) || -1 == stat(gpath, &st))
+        continue;
+      line_t *lines;    // formatted page
+      unsigned lines_len = roff(&lines, gpath, config.layout.main_width, 0);
+      if (0 == lines_len) {
+        lines_len = man(&lines, args, false);
+        if (err) {
+          err = false;
+          continue;
+        }
+      }
+      ft_lines_text(&text, lines, lines_len);
+      lines_free(lines, lines_len);
+      formatted++;
+    }
+
+    // Pages that share their source file (i.e. aliases) are indexed once
+    bool dup = false;
+    for (i = docs_len; i > 0 && !dup; i--)
+      dup = 0 == strcmp(paths[i - 1], gpath);
+    if (dup) {
+      free(text);
+      continue;
+    }
+
+    // Store the document, and gather its words
+    docs[docs_len].page = ft_put_str(sfp, page_mb);
+    docs[docs_len].section = ft_put_str(sfp, section_mb);
+    docs[docs_len].path = ft_put_str(sfp, gpath);
+    docs[docs_len].mtime = st.st_mtime;
+    docs[docs_len].text = ft_put_str(sfp, text);
+    paths[docs_len] = xstrdup(gpath);
+    ft_text(&bt, text, docs_len);
+    free(text);
+    docs_len++;
+  }
+  if (tty)
+    fwprintf(stderr, L"\n");
+
+  // Sort the terms, and encode their postings
+  ft_bterm_t **bterms = aalloc(MAX(1, bt.len), ft_bterm_t *); // sorted terms
+  for (i = 0, j = 0; i < bt.size; i++)
+    if (NULL != bt.terms[i].word)
+      bterms[j++] = &bt.terms[i];
+  qsort(bterms, bt.len, sizeof(ft_bterm_t *), ft_bterm_cmp);
+  ft_term_t *terms = aalloc(MAX(1, bt.len), ft_term_t); // terms table
+  size_t post_len = 0, post_size = BS_LONG; // length and size of `post`
+  char *post = aalloc(post_size, char);     // postings
+  for (i = 0; i < bt.len; i++) {
+    ft_bterm_t *t = bterms[i];
+    terms[i].word = ft_put_str(sfp, t->word);
+    terms[i].post = post_len;
+    terms[i].post_len = t->docs_len;
+    unsigned prev = 0; // previous document
+    for (j = 0; j < t->docs_len; j++) {
+      ft_put_varint(post, post_len, post_size, t->docs[j] - prev);
+      ft_put_varint(post, post_len, post_size, t->offs[j]);
+      prev = t->docs[j];
+    }
+    free(t->word);
+    free(t->docs);
+    free(t->offs);
+  }
+
+  // Write the index into a temporary file, and move it into place
+  ft_header_t hdr;          // index header
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, FT_MAGIC, sizeof(hdr.magic));
+  hdr.docs_len = docs_len;
+  hdr.terms_len = bt.len;
+  hdr.docs_off = sizeof(ft_header_t);
+  hdr.terms_off = hdr.docs_off + docs_len * sizeof(ft_doc_t);
+  hdr.post_off = hdr.terms_off + bt.len * sizeof(ft_term_t);
+  hdr.str_off = hdr.post_off + post_len;
+  hdr.size = hdr.str_off + ftell(sfp);
+
+  ft_mkdirs(path);
+  snprintf(tpath, BS_LINE + 8, "%s.tmp", path);
+  FILE *fp = fopen(tpath, "w");
+  if (NULL == fp) {
+    static wchar_t errmsg[BS_LINE];
+    wchar_t errpre[BS_LINE];
+    swprintf(errpre, BS_LINE, L"Unable to create '%s'", tpath);
+    serror(errmsg, errpre);
+    winddown(ES_OPER_ERROR, errmsg);
+  }
+  xfwrite(&hdr, sizeof(ft_header_t), 1, fp);
+  xfwrite(docs, sizeof(ft_doc_t), docs_len, fp);
+  xfwrite(terms, sizeof(ft_term_t), bt.len, fp);
+  xfwrite(post, sizeof(char), post_len, fp);
+  rewind(sfp);
+  char buf[BS_LONG]; // copy buffer
+  size_t cnt;        // number of bytes in `buf`
+  while ((cnt = fread(buf, 1, BS_LONG, sfp)) > 0)
+    xfwrite(buf, 1, cnt, fp);
+  xfclose(fp);
+  fclose(sfp);
+  ft_close();
+  if (-1 == rename(tpath, path)) {
+    static wchar_t errmsg[BS_LINE];
+    wchar_t errpre[BS_LINE];
+    swprintf(errpre, BS_LINE, L"Unable to rename '%s'", tpath);
+    serror(errmsg, errpre);
+    winddown(ES_OPER_ERROR, errmsg);
+  }
+
+  wprintf(L"Indexed %u manual pages (%u formatted, %u unchanged) into '%s'\n",
+          docs_len, formatted, reused, path);
+
+  for (i = 0; i < docs_len; i++)
+    free(paths[i]);
+  free(paths);
+  free(order);
+  free(docs);
+  free(bterms);
+  free(terms);
+  free(post);
+  if (NULL != bt.terms)
+    free(bt.terms);
+}
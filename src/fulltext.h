@@ -0,0 +1,127 @@
+// Full-text index of all manual pages (definition)
+
+#ifndef FULLTEXT_H
+
+#define FULLTEXT_H
+
+#include "lib.h"
+
+//
+// Constants
+//
+
+// Signature at the beginning of a full-text index file (to be changed whenever
+// the file format changes)
+#define FT_MAGIC "QMANFT01"
+
+// Maximum length of an indexed word (in characters)
+#define FT_WORD 32
+
+// Number of characters of page text shown before a match in search results
+#define FT_CONTEXT 24
+
+// Total number of characters of page text shown in search results
+#define FT_SNIPPET 120
+
+//
+// Types
+//
+
+// Full-text index file header. The header is followed by the documents table
+// (an array of `ft_doc_t`, sorted by page name and section), the terms table
+// (an array of `ft_term_t`, sorted by term), the postings, and the strings
+// (all of them UTF-8 encoded and terminated by '\0'). All offsets are relative
+// to the beginning of the area they point into.
+typedef struct {
+  char magic[8];      // `FT_MAGIC`
+  unsigned docs_len;  // number of documents
+  unsigned terms_len; // number of terms
+  size_t docs_off;    // offset of the documents table in the file
+  size_t terms_off;   // offset of the terms table in the file
+  size_t post_off;    // offset of the postings in the file
+  size_t str_off;     // offset of the strings in the file
+  size_t size;        // size of the file
+} ft_header_t;
+
+// An indexed manual page (document)
+typedef struct {
+  size_t page;    // offset of the page's name in the strings
+  size_t section; // offset of the page's section in the strings
+  size_t path;    // offset of the page's source file path in the strings
+  time_t mtime;   // modification time of the page's source file
+  size_t text;    // offset of the page's text (with all runs of white space
+                  // replaced by a single space) in the strings
+} ft_doc_t;
+
+// An indexed term, i.e. a lower-case word. Its postings list every document it
+// appears in, in increasing order, as pairs of variable-length integers (7 bits
+// per byte, least significant first): the document's number (minus that of
+// the previous document), and the offset of the term's first occurrence in the
+// document's text.
+typedef struct {
+  size_t word;       // offset of the term in the strings
+  size_t post;       // offset of the term's postings in the postings
+  unsigned post_len; // number of postings
+} ft_term_t;
+
+// A memory-mapped full-text index
+typedef struct {
+  const char *data;       // file contents, or NULL if no index has been mapped
+  size_t size;            // file size
+  const ft_header_t *hdr; // header
+  const ft_doc_t *docs;   // documents table
+  const ft_term_t *terms; // terms table
+  const char *post;       // postings
+  const char *str;        // strings
+} ft_t;
+
+//
+// Global variables
+//
+
+// The full-text index, as mapped by `ft_open()`
+extern ft_t ft;
+
+//
+// Functions (generic)
+//
+
+// Place the path of the current user's full-text index into `dst` (of length
+// `dst_len`). The index lives in `$XDG_CACHE_HOME/qman` if that's set, and in
+// `~/.cache/qman` otherwise.
+extern void ft_path(char *dst, unsigned dst_len);
+
+// Create all missing parent directories of `path` (e.g. of a file inside the
+// directory given by `ft_path()`), or exit with an error
+extern void ft_mkdirs(const char *path);
+
+// Map the full-text index into `ft`, unless that has already been done. Return
+// false if there is no (valid) index.
+extern bool ft_open();
+
+// Unmap the full-text index, if mapped
+extern void ft_close();
+
+// Search the full-text index for manual pages that contain all words in
+// `args`, and place them into `dst`, with a snippet of text around the first
+// match in each page as their `descr`. Return the number of pages found. If no
+// pages were found, or there is no index, set `err` to true and describe the
+// problem in `err_msg`; otherwise set `err` to false.
+extern unsigned ft_query(aprowhat_t **dst, const wchar_t *args);
+
+// Render the results of `ft_query()` for `args` into `dst`, the way
+// `aprowhat()` does, using `key` and `title` for the header. Return the number
+// of lines in `dst`.
+extern unsigned fulltext(line_t **dst, const wchar_t *args,
+                         const wchar_t *key, const wchar_t *title);
+
+//
+// Functions (handlers)
+//
+
+// Main handler for `--update-index`. Build the full-text index of all manual
+// pages, reusing the text of every page whose source file hasn't changed since
+// it was last indexed, and print a summary.
+extern void ft_update();
+
+#endif
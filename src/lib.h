@@ -6,6 +6,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 #include <getopt.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -15,10 +16,15 @@
 #include <ctype.h>
 #include <libgen.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <sys/param.h>
 #include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <locale.h>
 #include <string.h>
 #include <wctype.h>
@@ -51,7 +57,11 @@ extern char *program_invocation_short_name;
 #include "base64.h"
 #include "config.h"
 #include "program.h"
+#include "roff.h"
 #include "cli.h"
+#include "server.h"
+#include "fulltext.h"
+#include "session.h"
 #include "tui.h"
 
 #endif
@@ -33,6 +33,30 @@ option_t options[] = {
      L"Produce colorful output using terminal escape codes, even when not "
      L"running inside a terminal",
      OA_NONE, true},
+    {"batch", 'B',
+     L"Read PAGE names from file ARG (or from standard input, if ARG is '-'), "
+     L"one per line, and output all of them (implies CLI mode)",
+     OA_REQUIRED, true},
+    {"jobs", 'j',
+     L"Use ARG worker processes in batch mode (default is one per CPU)",
+     OA_REQUIRED, true},
+    {"output-dir", 'o',
+     L"In batch mode, write each page to a separate file inside directory ARG",
+     OA_REQUIRED, true},
+    {"server", 'S',
+     L"Run as a resident server that renders pages on behalf of CLI clients",
+     OA_NONE, true},
+    {"fulltext", 'F',
+     L"Show a list of all pages whose text contains all words in PAGE, using "
+     L"the full-text index",
+     OA_NONE, true},
+    {"update-index", 'U',
+     L"Build or update the full-text index of all manual pages, and exit",
+     OA_NONE, true},
+    {"resume", 'R',
+     L"Restore the history and location saved when the TUI was last quit "
+     L"(see the save_session configuration option)",
+     OA_NONE, true},
     {"action", 'A', L"Automatically perform program action ARG upon startup",
      OA_REQUIRED, true},
     {"config-path", 'C', L"Use ARG as the configuration file path", OA_REQUIRED,
@@ -43,8 +67,26 @@ option_t options[] = {
 
 action_t first_action = PA_NULL;
 
+char *batch_path = NULL;
+
+unsigned batch_jobs = 0;
+
+char *batch_dir = NULL;
+
+bool server_mode = false;
+
+bool index_mode = false;
+
+bool resume_mode = false;
+
+bool page_stream = false;
+
 request_t *history = NULL;
 
+request_t *history_buf = NULL;
+
+unsigned history_buf_len = 0;
+
 unsigned history_cur = 0;
 
 unsigned history_top = 0;
@@ -53,10 +95,16 @@ aprowhat_t *aw_all = NULL;
 
 unsigned aw_all_len = 0;
 
+unsigned aw_all_gen = 0;
+
 wchar_t **sc_all = NULL;
 
 unsigned sc_all_len = 0;
 
+aw_last_t aw_last = {RT_NONE, NULL, NULL, 0};
+
+aw_lazy_t aw_lazy = {NULL};
+
 line_t *page = NULL;
 
 wchar_t page_title[BS_SHORT];
@@ -81,6 +129,23 @@ result_t *results = NULL;
 
 unsigned results_len = 0;
 
+wchar_t *page_fold = NULL;
+
+unsigned *page_fold_offs = NULL;
+
+link_loc_t *page_links = NULL;
+
+unsigned *page_links_offs = NULL;
+
+unsigned *page_starts = NULL;
+
+char *page_mb = NULL;
+
+unsigned *page_mb_offs = NULL;
+
+isearch_t isearch = {.lines = NULL, .needle = NULL, .occ = NULL, .size = 0,
+                     .len = 0, .re_ok = false};
+
 mark_t mark = {false, 0, 0, 0, 0};
 
 full_regex_t re_man, re_http, re_email, re_file;
@@ -318,11 +383,6 @@ unsigned extract_args(wchar_t **page, wchar_t **section, unsigned len,
   return 0;
 }
 
-// Helper of `man_sections()` and `man_toc()`. Place the location of the manual
-// page source that corresponds to `args` into `dst` (of length `dst_len`). If
-// no such location exists, return false, otherwise return true. `local_file`
-// signifies whether `args` contains a local file path, rather than a manual
-// page name and section.
 bool man_loc(char *dst, unsigned dst_len, const wchar_t *args,
              bool local_file) {
   char cmdstr[BS_LINE]; // command to execute
@@ -442,6 +502,173 @@ bool man_loc(char *dst, unsigned dst_len, const wchar_t *args,
   return false;
 }
 
+// Helper of `man_sections()` and `man_toc()`. Read the next line of manual
+// page source from `gp`, and place it into `gline` (of length `BS_LINE`). If
+// `macros_only` is true, skip over lines that do not begin with '.' without
+// decoding them. Return the length of `gline`, or -1 on `EOF`.
+int man_getline(wchar_t *gline, archive_t *gp, bool macros_only) {
+  const char *line;  // current line (not NUL-terminated)
+  size_t line_len;   // length of `line`
+  char tmp[BS_LINE]; // NUL-terminated copy of `line`
+
+  while (0 != (line_len = arline(gp, &line))) {
+    if (macros_only && '.' != line[0])
+      continue;
+
+    if (line_len > BS_LINE - 1)
+      line_len = BS_LINE - 1;
+    memcpy(tmp, line, line_len);
+    tmp[line_len] = '\0';
+
+    return xmbstowcs(gline, tmp, BS_LINE);
+  }
+
+  return -1;
+}
+
+// Helper of `aprowhat_local()`. Split `args` into words the way the shell
+// would (words may be surrounded by single quotes), and place them into `dst`
+// (of length `dst_len`), using `buf` (which must be at least as long as `args`)
+// for storage. Return the number of words.
+unsigned aprowhat_words(wchar_t **dst, unsigned dst_len, wchar_t *buf,
+                        const wchar_t *args) {
+  unsigned len = 0;    // return value
+  bool quoted = false; // whether we are inside single quotes
+  bool in_word = false; // whether we are inside a word
+
+  for (; L'\0' != *args; args++) {
+    if (L'\'' == *args) {
+      quoted = !quoted;
+      if (!in_word && len < dst_len) {
+        dst[len++] = buf;
+        in_word = true;
+      }
+    } else if (!quoted && iswspace(*args)) {
+      if (in_word)
+        *buf++ = L'\0';
+      in_word = false;
+    } else if (in_word || len < dst_len) {
+      if (!in_word) {
+        dst[len++] = buf;
+        in_word = true;
+      }
+      *buf++ = *args;
+    }
+  }
+  *buf = L'\0';
+
+  return len;
+}
+
+// Helper of `aprowhat_exec()`. Perform the apropos or whatis search specified
+// by `cmd` and `args` on `aw_all`, without executing any command, and place
+// the results into `dst`, as `aprowhat_exec()` would. Whatis returns all pages
+// whose names are equal to any of the words in `args`, and apropos returns all
+// pages whose names or descriptions match any of them (as case-insensitive
+// extended regular expressions with `man-db`, or as case-insensitive
+// substrings otherwise). Return -1, without touching `dst`, if the search
+// can't be reproduced this way (e.g. because `args` contains options, or
+// because it contains regular expressions and the system isn't `man-db`).
+int aprowhat_local(aprowhat_t **dst, aprowhat_cmd_t cmd, const wchar_t *args) {
+  wchar_t **words = aalloca(BS_SHORT, wchar_t *); // words of `args`
+  wchar_t *buf = walloca(wcslen(args));           // storage for `words`
+  unsigned words_len = aprowhat_words(words, BS_SHORT, buf, args);
+  regex_t *res = aalloca(words_len, regex_t);     // compiled `words`
+  bool *lits = aalloca(words_len, bool); // whether `words` are plain strings
+  char *mbs;                                      // multibyte page or descr
+  unsigned i, j, res_i = 0;                       // iterators
+
+  if (0 == aw_all_len || 0 == words_len)
+    return -1;
+  for (i = 0; i < words_len; i++) {
+    // Options, and `mandoc`'s search expressions, are left to the command
+    if (L'\0' == words[i][0] || L'-' == words[i][0] ||
+        (ST_MANDB != config.misc.system_type &&
+         NULL != wcspbrk(words[i], L"=~")))
+      return -1;
+    // Words that contain no special characters are searched for as plain
+    // strings, which is much faster than `regexec()`. Only `man-db` treats
+    // the others as regular expressions.
+    lits[i] = NULL == wcspbrk(words[i], L".[]()*+?{}|^$\\");
+    if (AW_APROPOS == cmd && !lits[i] && ST_MANDB != config.misc.system_type)
+      return -1;
+  }
+  mbs = salloc(BS_LONG);
+  if (AW_APROPOS == cmd)
+    for (i = 0; i < words_len; i++) {
+      if (lits[i])
+        continue;
+      const size_t mbs_len = wcstombs(mbs, words[i], BS_LONG);
+      if ((size_t)-1 == mbs_len || BS_LONG == mbs_len ||
+          0 != regcomp(&res[i], mbs, REG_EXTENDED | REG_ICASE | REG_NOSUB)) {
+        for (j = 0; j < i; j++)
+          if (!lits[j])
+            regfree(&res[j]);
+        free(mbs);
+        return -1;
+      }
+    }
+
+  aprowhat_t *res_aw = aalloc(MAX(1, aw_all_len), aprowhat_t); // result
+  bool fail = false; // whether an entry couldn't be converted for `regexec()`
+  for (i = 0; i < aw_all_len; i++) {
+    bool match = false; // whether `aw_all[i]` matches any of `words`
+    for (j = 0; j < words_len && !match && !fail; j++) {
+      if (AW_WHATIS == cmd)
+        match = 0 == wcscasecmp(aw_all[i].page, words[j]);
+      else if (lits[j])
+        match = NULL != wcscasestr(aw_all[i].page, words[j]) ||
+                NULL != wcscasestr(aw_all[i].descr, words[j]);
+      else {
+        // (`wcstombs()` doesn't terminate `mbs` if it has to truncate it)
+        size_t mbs_len = wcstombs(mbs, aw_all[i].page, BS_LONG);
+        fail = (size_t)-1 == mbs_len || BS_LONG == mbs_len;
+        match = !fail && 0 == regexec(&res[j], mbs, 0, NULL, 0);
+        if (!fail && !match) {
+          mbs_len = wcstombs(mbs, aw_all[i].descr, BS_LONG);
+          fail = (size_t)-1 == mbs_len || BS_LONG == mbs_len;
+          match = !fail && 0 == regexec(&res[j], mbs, 0, NULL, 0);
+        }
+      }
+    }
+    if (fail)
+      break;
+    if (match) {
+      res_aw[res_i].page = xwcsdup(aw_all[i].page);
+      res_aw[res_i].section = xwcsdup(aw_all[i].section);
+      res_aw[res_i].ident = xwcsdup(aw_all[i].ident);
+      res_aw[res_i].descr = xwcsdup(aw_all[i].descr);
+      res_i++;
+    }
+  }
+  if (AW_APROPOS == cmd)
+    for (i = 0; i < words_len; i++)
+      if (!lits[i])
+        regfree(&res[i]);
+  free(mbs);
+  if (fail) {
+    aprowhat_free(res_aw, res_i);
+    return -1;
+  }
+
+  // If no results were found, set `err` to true and describe the error in
+  // `err_msg`. Otherwise, set `err` to false.
+  err = false;
+  if (0 == res_i) {
+    err = true;
+    if (AW_WHATIS == cmd)
+      swprintf(err_msg, BS_LINE, L"Whatis %ls: nothing apropriate", args);
+    else
+      swprintf(err_msg, BS_LINE, L"Apropos %ls: nothing apropriate", args);
+    free(res_aw);
+    res_aw = NULL;
+  } else
+    res_aw = xreallocarray(res_aw, res_i, sizeof(aprowhat_t));
+
+  *dst = res_aw;
+  return res_i;
+}
+
 // macOS X specific version of `aprowhat_exec()` (arguments are the same)
 unsigned aprowhat_exec_darwin(aprowhat_t **dst, aprowhat_cmd_t cmd,
                               const wchar_t *args) {
@@ -623,6 +850,252 @@ void add_link(line_t *line, unsigned start, unsigned end, bool in_next,
   line->links[i] = link;
 }
 
+// Helper of `aprowhat_block()`. Allocate memory for line `k` of `res`, of
+// length `len`, or only set its length if `stub`.
+#define blk_alloc(k, len)                                                      \
+  if (stub) {                                                                  \
+    memset(&res[k], 0, sizeof(line_t));                                        \
+    res[k].length = len;                                                       \
+  } else {                                                                     \
+    line_alloc(res[k], len);                                                   \
+  }
+
+// Helper of `aprowhat_block()`. Add a link of type `type` and target `trgt`,
+// from `start` to `end`, to line `k` of `res`, or only count it if `stub`
+// (along the lines of `add_link()`, which discards empty links).
+#define blk_link(k, start, end, type, trgt)                                    \
+  if (stub) {                                                                  \
+    if ((end) > (start))                                                       \
+      res[k].links_length++;                                                   \
+  } else                                                                       \
+    add_link(&res[k], start, end, false, 0, 0, type, trgt);
+
+// Helper of `aprowhat_render()` and `line_at()`. Render block `item`
+// (see `aw_lazy_t`) of the page laid out in `aw_lazy` into the lines starting
+// at `res`, and return their number. If `stub`, only set the `length` and
+// `links_length` of each line. (A block is never longer than `BS_LINE +
+// BS_SHORT` lines.)
+unsigned aprowhat_block(line_t *res, int item, bool stub) {
+  // Text blocks widths (as they were when the page was laid out)
+  const unsigned line_width = MAX(60, aw_lazy.width);
+  const unsigned lmargin_width = aw_lazy.lmargin; // left margin
+  const unsigned rmargin_width = aw_lazy.rmargin; // right margin
+  const unsigned text_width =
+      line_width - lmargin_width - rmargin_width; // main text area
+  const unsigned hfc_width =
+      text_width / 2 + text_width % 2; // header/footer center area
+  const unsigned hfl_width =
+      (text_width - hfc_width) / 2; // header/footer left area
+  const unsigned hfr_width =
+      hfl_width + (text_width - hfc_width) % 2; // header/footer right area
+
+  const aprowhat_t *aw = aw_lazy.aw;                       // manual pages
+  const wchar_t *const *sc = (const wchar_t **)aw_lazy.sc; // sections
+  const unsigned sc_len = aw_lazy.sc_len;                  // no. of sections
+  const wchar_t *key = aw_lazy.key;                        // header key
+  const unsigned key_len = wcslen(key);                    // `key` length
+  unsigned ln = 0;                                         // current line no.
+  unsigned i, j;                                           // iterators
+  wchar_t tmp[BS_LINE];                                    // temporary
+  memset(tmp, 0, sizeof(wchar_t) * BS_LINE);
+
+  if (AB_HEAD == item) {
+    // Header
+    blk_alloc(ln, line_width);
+    if (!stub) {
+      const wchar_t *title = aw_lazy.title;     // page title
+      const unsigned title_len = wcslen(title); // `title` length
+      const unsigned lts_len =
+          (hfc_width - title_len) / 2 +
+          (hfc_width - title_len) % 2; // space on the left of `title`
+      const unsigned rts_len =
+          (hfc_width - title_len) / 2; // space on the right of `title`
+      swprintf(res[ln].text, line_width + 1, L"%*s%-*ls%*s%ls%*s%*ls%*s", //
+               lmargin_width, "",                                         //
+               hfl_width, key,                                            //
+               lts_len, "",                                               //
+               title,                                                     //
+               rts_len, "",                                               //
+               hfr_width, key,                                            //
+               rmargin_width, ""                                          //
+      );
+      bset(res[ln].uline, lmargin_width);
+      bset(res[ln].reg, lmargin_width + key_len);
+      bset(res[ln].uline,
+           lmargin_width + hfl_width + hfc_width + hfr_width - key_len);
+      bset(res[ln].reg, lmargin_width + hfl_width + hfc_width + hfr_width);
+    }
+  } else if (AB_SECTIONS == item) {
+    // Newline
+    blk_alloc(ln, 0);
+
+    // Section title for sections
+    ln++;
+    blk_alloc(ln, line_width);
+    if (!stub) {
+      wcslcpy(tmp, L"SECTIONS", BS_LINE);
+      swprintf(res[ln].text, line_width + 1, L"%*s%-*ls", //
+               lmargin_width, "",                         //
+               text_width, tmp);
+      bset(res[ln].bold, lmargin_width);
+      bset(res[ln].reg, lmargin_width + wcslen(tmp));
+    }
+
+    // Sections
+    const unsigned sc_maxwidth = MIN(
+        text_width / 2 - 4, wmaxlen(sc, sc_len)); // length of longest section
+    const unsigned sc_cols =
+        text_width / (4 + sc_maxwidth); // number of columns for sections
+    const unsigned sc_lines =
+        sc_len % sc_cols > 0
+            ? 1 + sc_len / sc_cols
+            : MAX(1, sc_len / sc_cols); // number of lines for sections
+    unsigned sc_i;                      // index of current section
+    for (i = 0; i < sc_lines; i++) {
+      ln++;
+      blk_alloc(ln, line_width + 4); // +4 for section margin
+      if (!stub)
+        swprintf(res[ln].text, line_width + 1, L"%*s", lmargin_width, "");
+      for (j = 0; j < sc_cols; j++) {
+        sc_i = sc_cols * i + j;
+        if (sc_i < sc_len) {
+          if (!stub) {
+            swprintf(tmp, sc_maxwidth + 5, L" %-*ls", sc_maxwidth + 3,
+                     sc[sc_i]);
+            wcslcat(res[ln].text, tmp, line_width + 1);
+            swprintf(tmp, BS_LINE, L"MANUAL PAGES IN SECTION '%ls'", sc[sc_i]);
+          }
+          blk_link(ln, lmargin_width + j * (sc_maxwidth + 4) + 1,
+                   lmargin_width + j * (sc_maxwidth + 4) +
+                       MIN(sc_maxwidth + 3, wcslen(sc[sc_i]) + 1),
+                   LT_LS, tmp);
+        }
+      }
+    }
+  } else if (AB_FOOT == item) {
+    // Newline
+    blk_alloc(ln, 0);
+
+    // Footer
+    ln++;
+    blk_alloc(ln, line_width);
+    if (!stub) {
+      const wchar_t *date = aw_lazy.date;     // page date
+      const unsigned date_len = wcslen(date); // date length
+      const unsigned lds_len =
+          (hfc_width - date_len) / 2 +
+          (hfc_width - date_len) % 2; // length of space on the left of date
+      const unsigned rds_len =
+          (hfc_width - date_len) / 2; // length of space on the right of date
+      swprintf(res[ln].text, line_width + 1, L"%*s%-*ls%*s%ls%*s%*ls%*s", //
+               lmargin_width, "",                                         //
+               hfl_width, aw_lazy.ver,                                    //
+               lds_len, "",                                               //
+               date,                                                      //
+               rds_len, "",                                               //
+               hfr_width, key,                                            //
+               rmargin_width, ""                                          //
+      );
+      bset(res[ln].uline,
+           lmargin_width + hfl_width + hfc_width + hfr_width - key_len);
+      bset(res[ln].reg, lmargin_width + hfl_width + hfc_width + hfr_width);
+    }
+  } else if (item <= AB_SECTION) {
+    // Newline
+    blk_alloc(ln, 0);
+
+    // Section title
+    ln++;
+    blk_alloc(ln, line_width);
+    if (!stub) {
+      swprintf(tmp, text_width + 1, L"MANUAL PAGES IN SECTION '%ls'",
+               sc[AB_SECTION - item]);
+      swprintf(res[ln].text, line_width + 1, L"%*s%-*ls", //
+               lmargin_width, "",                         //
+               text_width, tmp);
+      bset(res[ln].bold, lmargin_width);
+      bset(res[ln].reg, lmargin_width + wcslen(tmp));
+    }
+  } else {
+    const unsigned lc_width = text_width / 3;        // left column width
+    const unsigned rc_width = text_width - lc_width; // right column width
+    const unsigned page_width = wcslen(aw[item].page) +
+                                wcslen(aw[item].section) +
+                                2; // width of manual page name and section
+    const unsigned spcl_width =
+        MAX(line_width,
+            lmargin_width + page_width +
+                rmargin_width); // used in place of line_width; might be
+                                // longer, in which case we'll scroll
+
+    // Page name and section (`ident`)
+    blk_alloc(ln, spcl_width);
+    if (!stub)
+      swprintf(res[ln].text, spcl_width + 1, L"%*s%-*ls", //
+               lmargin_width, "",                         //
+               lc_width, aw[item].ident);
+    blk_link(ln, lmargin_width, lmargin_width + wcslen(aw[item].ident), LT_MAN,
+             aw[item].ident);
+
+    // Description (when laying out, only the number of its lines is needed)
+    if (stub) {
+      unsigned descr_lines = wwrap_count(
+          aw[item].descr, MIN(wcslen(aw[item].descr), BS_LINE - 1), rc_width);
+      if (descr_lines > 0 && page_width < lc_width)
+        descr_lines--;
+      for (i = 0; i < descr_lines; i++) {
+        ln++;
+        blk_alloc(ln, line_width);
+      }
+      return ln + 1;
+    }
+    wcslcpy(tmp, aw[item].descr, BS_LINE);
+    wwrap(tmp, rc_width);
+    wchar_t *buf;
+    wchar_t *ptr = wcstok(tmp, L"\n", &buf);
+    if (NULL != ptr && page_width < lc_width) {
+      wcslcat(res[ln].text, ptr, line_width + 1);
+      ptr = wcstok(NULL, L"\n", &buf);
+    }
+    while (NULL != ptr) {
+      ln++;
+      blk_alloc(ln, line_width);
+      swprintf(res[ln].text, line_width + 1, L"%*s%ls", //
+               lmargin_width + lc_width, "",            //
+               ptr);
+      ptr = wcstok(NULL, L"\n", &buf);
+    }
+  }
+
+  return ln + 1;
+}
+
+// Helper of `aprowhat_render()`. Lay out block `item` (see `aw_lazy_t`) as the
+// `bl`th block of the page, starting at line `ln` of `res`, and increase `ln`
+// and `bl` accordingly. Reallocate `res` in memory first, if the block might
+// not fit into it.
+#define add_block(item)                                                        \
+  if (ln + BS_LINE + BS_SHORT > res_len) {                                     \
+    res_len += BS_LINE + BS_SHORT;                                             \
+    res = xreallocarray(res, res_len, sizeof(line_t));                         \
+  }                                                                            \
+  aw_lazy.block_ln[bl] = ln;                                                   \
+  aw_lazy.block_item[bl] = item;                                               \
+  ln += aprowhat_block(&res[ln], item, true);                                  \
+  bl++;
+
+// Helper of `aprowhat_render()` and `lines_free()`. Forget the page laid out in
+// `aw_lazy`, and free the memory used for its layout (but not the page itself).
+void aprowhat_release() {
+  if (aw_lazy.aw_own && NULL != aw_lazy.aw)
+    aprowhat_free(aw_lazy.aw, aw_lazy.aw_len);
+  if (NULL != aw_lazy.sc)
+    wafree(aw_lazy.sc, aw_lazy.sc_len);
+  free(aw_lazy.block_ln);
+  free(aw_lazy.block_item);
+  memset(&aw_lazy, 0, sizeof(aw_lazy_t));
+}
+
 // Helper of `man()`. Discover links that match `re` in the text of `line`,
 // and add them to said `line`. `line_next` is necessary to support hyphenated
 // links. `type` signifies the link type to add.
@@ -712,6 +1185,141 @@ void discover_links(const full_regex_t *re, line_t *line, line_t *line_next,
   }
 }
 
+// Helper of `man()` and `man_builtin()`. Insert the list of the sections of
+// the manual page whose source is at `gpath` into `*dst` (of allocated length
+// `*dst_len`), starting at line `ln`. Return the number of the line that
+// follows the list.
+unsigned man_sections_on_top(line_t **dst, unsigned *dst_len, unsigned ln,
+                             const char *gpath) {
+  // Text blocks widths
+  const unsigned line_width = MAX(60, config.layout.main_width);
+  const unsigned lmargin_width = config.layout.lmargin; // left margin
+  const unsigned rmargin_width = config.layout.rmargin; // right margin
+  const unsigned text_width =
+      line_width - lmargin_width - rmargin_width; // main text area
+
+  unsigned i, j;               // iterators
+  wchar_t tmpw[BS_LINE];       // temporary
+  line_t *res = *dst;          // result buffer
+  unsigned res_len = *dst_len; // result buffer length
+
+  // Newline
+  line_alloc(res[ln], 0);
+
+  // Section title for sections
+  inc_ln;
+  line_alloc(res[ln], line_width);
+  wcslcpy(tmpw, L"SECTIONS", BS_LINE);
+  swprintf(res[ln].text, line_width + 1, L"%*s%-*ls", //
+           lmargin_width, "",                         //
+           text_width, tmpw);
+  bset(res[ln].bold, lmargin_width);
+  bset(res[ln].reg, lmargin_width + wcslen(tmpw));
+
+  // Sections
+  wchar_t **sc;                                  // sections
+  unsigned sc_len = man_sections_at(&sc, gpath); // no. of sections
+  const unsigned sc_maxwidth =
+      MIN(text_width / 2 - 4, wmaxlen((const wchar_t *const *)sc,
+                                      sc_len)); // length of longest section
+  const unsigned sc_cols =
+      text_width / (4 + sc_maxwidth); // number of columns for sections
+  const unsigned sc_lines =
+      sc_len % sc_cols > 0 ? 1 + sc_len / sc_cols
+                           : MAX(1, sc_len / sc_cols); // number of lines
+  unsigned sc_i; // index of current section
+  for (i = 0; i < sc_lines; i++) {
+    inc_ln;
+    line_alloc(res[ln], line_width + 4); // +4 for section margin
+    swprintf(res[ln].text, line_width + 1, L"%*s", lmargin_width, "");
+    for (j = 0; j < sc_cols; j++) {
+      sc_i = sc_cols * i + j;
+      if (sc_i < sc_len) {
+        swprintf(tmpw, sc_maxwidth + 5, L" %-*ls", sc_maxwidth + 3, sc[sc_i]);
+        wcslower(tmpw);
+        wcslcat(res[ln].text, tmpw, line_width + 1);
+        add_link(&res[ln], lmargin_width + j * (sc_maxwidth + 4) + 1,
+                 lmargin_width + j * (sc_maxwidth + 4) +
+                     MIN(sc_maxwidth + 3, wcslen(sc[sc_i])) + 1,
+                 false, 0, 0, LT_LS, sc[sc_i]);
+      }
+    }
+  }
+  inc_ln;
+
+  wafree(sc, sc_len);
+
+  *dst = res;
+  *dst_len = res_len;
+  return ln;
+}
+
+// Helper of `man_links()` and `man()`. Discover and add links to `line`, whose
+// following line is `line_next`.
+void man_link(line_t *line, line_t *line_next) {
+  discover_links(&re_man, line, line_next, LT_MAN);
+  if (config.capabilities.http_links)
+    discover_links(&re_http, line, line_next, LT_HTTP);
+  if (config.capabilities.email_links)
+    discover_links(&re_email, line, line_next, LT_EMAIL);
+  if (config.capabilities.file_links)
+    discover_links(&re_file, line, line_next, LT_FILE);
+}
+
+// Helper of `man()` and `man_builtin()`. Discover and add links to `lines` (of
+// length `lines_len`), skipping the first two lines and the last line.
+void man_links(line_t *lines, unsigned lines_len) {
+  unsigned i; // iterator
+
+  if (lines_len < 2)
+    return;
+
+  for (i = 2; i < lines_len - 1; i++)
+    man_link(&lines[i], &lines[i + 1]);
+}
+
+// Helper of `man()`. Try to format the manual page whose source is at `gpath`
+// using the built-in formatter (see `roff()`), and place the result into
+// `dst`. Return the number of lines in `dst`, or 0 if the page's source
+// contains constructs the formatter doesn't support.
+unsigned man_builtin(line_t **dst, const char *gpath) {
+  // Text blocks widths
+  const unsigned line_width = MAX(60, config.layout.main_width);
+  const unsigned lmargin_width = config.layout.lmargin; // left margin
+  const unsigned rmargin_width = config.layout.rmargin; // right margin
+  const unsigned text_width =
+      line_width - lmargin_width - rmargin_width; // main text area
+
+  line_t *fmt;      // formatter output
+  unsigned fmt_len; // length of `fmt`
+  unsigned i;       // iterator
+
+  fmt_len = roff(&fmt, gpath, text_width, lmargin_width);
+  if (0 == fmt_len)
+    return 0;
+
+  unsigned ln = 0;                       // current line number
+  unsigned res_len = fmt_len + BS_LINE;  // result buffer length
+  line_t *res = aalloc(res_len, line_t); // result buffer
+
+  // Move the formatter's output into `res`, inserting the list of sections
+  // (if enabled) after the header line
+  res[ln++] = fmt[0];
+  if (config.capabilities.sections_on_top)
+    ln = man_sections_on_top(&res, &res_len, ln, gpath);
+  for (i = 1; i < fmt_len; i++) {
+    res[ln] = fmt[i];
+    inc_ln;
+  }
+  free(fmt);
+
+  man_links(res, ln);
+
+  err = false;
+  *dst = res;
+  return ln;
+}
+
 // Helper of `man_toc()`. Massage the `text` of every entry in `toc` (of size
 // `toc_len`) with the `groff` command, in order to remove escaped characters,
 // etc.
@@ -819,9 +1427,681 @@ void secgroff(wchar_t **sections, unsigned sections_len) {
   }
   xpclose(pp);
 
-  // Tidy up and restore the environment
-  unlink(tpath);
-  free(tpath);
+  // Tidy up and restore the environment
+  unlink(tpath);
+  free(tpath);
+}
+
+// Helper of `init()` and `history_push()`. Make sure that there's room for
+// `history[history_top]` in `history_buf`. When `history_buf` is exhausted, the
+// entries in use are moved back to its beginning, and, if they take up more
+// than half of it, it is also enlarged; this keeps the cost of sliding
+// `history` forward (see `history_push()`) constant on average. Entries of
+// `history_buf` after `history_top` are always empty.
+void history_room() {
+  const unsigned off = history - history_buf; // position of `history`
+
+  if (off + history_top < history_buf_len)
+    return;
+
+  if (off > 0)
+    memmove(history_buf, history, history_top * sizeof(request_t));
+  if (2 * (history_top + 1) > history_buf_len) {
+    history_buf_len = MAX(BS_SHORT, 2 * (history_top + 1));
+    history_buf =
+        xreallocarray(history_buf, history_buf_len, sizeof(request_t));
+  }
+  history = history_buf;
+  memset(&history[history_top], 0,
+         (history_buf_len - history_top) * sizeof(request_t));
+}
+
+// Helper of `search_all()` and `search_multi_all()`. Place a lower-case copy of
+// the text of lines [`from`, `to`) of `lines`, each one terminated by L'\0',
+// into `*dst`, and the offsets of the lines in `*dst` (plus the offset of its
+// end) into `*offs`. (The offset of line `ln` is `(*offs)[ln - from]`.)
+void fold_lines(wchar_t **dst, unsigned **offs, const line_t *lines,
+                unsigned from, unsigned to) {
+  unsigned ln, c;   // iterators
+  unsigned len = 0; // length of `*dst`
+  unsigned *res_offs = aalloc(to - from + 1, unsigned); // line offsets
+
+  for (ln = from; ln < to; ln++) {
+    res_offs[ln - from] = len;
+    len += wcslen(line_at(lines, ln)->text) + 1;
+  }
+  res_offs[to - from] = len;
+
+  wchar_t *res = aalloc(len + 1, wchar_t); // result
+  for (ln = from; ln < to; ln++) {
+    const wchar_t *text = line_at(lines, ln)->text; // text of current line
+    wchar_t *dp = &res[res_offs[ln - from]];       // its destination
+    for (c = 0; L'\0' != text[c]; c++)
+      dp[c] = towlower(text[c]);
+    dp[c] = L'\0';
+  }
+
+  *dst = res;
+  *offs = res_offs;
+}
+
+// Helper of `search_all()` and `search_multi_all()`. Place a lower-case copy of
+// the text of (at least) lines [`from`, `to`) of `lines` (of length
+// `lines_len`), as built by `fold_lines()`, into `*dst` and `*offs`, and return
+// the number of the line whose offset is `(*offs)[0]`. The copy of `page` is
+// built only once, and kept in `page_fold` and `page_fold_offs`, unless `page`
+// is laid out lazily (see `aw_lazy_t`), in which case only the searched lines
+// are copied, so that the rest don't need to be filled in. Any other copy must
+// be freed with `put_fold()`.
+unsigned get_fold(wchar_t **dst, unsigned **offs, const line_t *lines,
+                  unsigned lines_len, unsigned from, unsigned to) {
+  if (lines != page || lines == aw_lazy.lines) {
+    fold_lines(dst, offs, lines, from, to);
+    return from;
+  }
+
+  if (NULL == page_fold)
+    fold_lines(&page_fold, &page_fold_offs, lines, 0, lines_len);
+  *dst = page_fold;
+  *offs = page_fold_offs;
+  return 0;
+}
+
+// Helper of `search_all()` and `search_multi_all()`. Free a copy returned by
+// `get_fold()`, unless it's the one kept in `page_fold`.
+#define put_fold(fold, offs)                                                   \
+  if (fold != page_fold) {                                                     \
+    free(fold);                                                                \
+    free(offs);                                                                \
+  }
+
+// Helper of `prev_link()`, `next_link()`, `first_link()`, and `last_link()`.
+// Place the locations of all links in `lines` (of length `lines_len`), in
+// document order, into `*dst`, and the number of links in all lines before
+// each line (plus the total number of links) into `*offs`.
+void index_links(link_loc_t **dst, unsigned **offs, const line_t *lines,
+                 unsigned lines_len) {
+  unsigned ln, l;   // iterators
+  unsigned len = 0; // length of `*dst`
+  unsigned *res_offs = aalloc(lines_len + 1, unsigned); // link offsets
+
+  for (ln = 0; ln < lines_len; ln++) {
+    res_offs[ln] = len;
+    len += lines[ln].links_length;
+  }
+  res_offs[lines_len] = len;
+
+  link_loc_t *res = aalloc(len + 1, link_loc_t); // result
+  for (ln = 0; ln < lines_len; ln++)
+    for (l = 0; l < lines[ln].links_length; l++)
+      res[res_offs[ln] + l] = (link_loc_t){true, ln, l};
+
+  *dst = res;
+  *offs = res_offs;
+}
+
+// Helper of `prev_link()`, `next_link()`, `first_link()`, and `last_link()`.
+// Place the link index of `lines` (of length `lines_len`), as built by
+// `index_links()`, into `*dst` and `*offs`. The index of `page` is built only
+// once, and kept in `page_links` and `page_links_offs`; the index of any other
+// `lines` is built anew, and must be freed by the caller.
+void get_links(link_loc_t **dst, unsigned **offs, const line_t *lines,
+               unsigned lines_len) {
+  if (lines != page) {
+    index_links(dst, offs, lines, lines_len);
+    return;
+  }
+
+  if (NULL == page_links)
+    index_links(&page_links, &page_links_offs, lines, lines_len);
+  *dst = page_links;
+  *offs = page_links_offs;
+}
+
+// Helper of `prev_link()`, `next_link()`, `first_link()`, and `last_link()`.
+// Free a link index returned by `get_links()` for `lines`, unless it's the
+// index of `page`.
+#define put_links(links, offs, lines)                                          \
+  if (lines != page) {                                                         \
+    free(links);                                                               \
+    free(offs);                                                                \
+  }
+
+// Helper of `index_starts()` and `ls_discover()`. Return the text of line
+// number `ln` of `page` that follows its left margin.
+const wchar_t *line_start(unsigned ln) {
+  const wchar_t *text = line_at(page, ln)->text; // the line's text
+
+  return &text[wmargend(text, NULL)];
+}
+
+// Helper of `index_starts()`. Compare the lines of `page` whose numbers `a` and
+// `b` point to, by the text that follows their left margins.
+int starts_cmp(const void *a, const void *b) {
+  return wcscmp(line_start(*(const unsigned *)a),
+                line_start(*(const unsigned *)b));
+}
+
+// Helper of `ls_discover()`. Place the numbers of all lines of `page`, sorted
+// by the text that follows their left margins, into `*dst`.
+void index_starts(unsigned **dst) {
+  unsigned ln;                                    // iterator
+  unsigned *res = aalloc(page_len + 1, unsigned); // result
+
+  for (ln = 0; ln < page_len; ln++)
+    res[ln] = ln;
+  qsort(res, page_len, sizeof(unsigned), starts_cmp);
+
+  *dst = res;
+}
+
+// Helper of `populate_toc()`. Set the `line` of every entry in `toc` (of size
+// `toc_len`) to the line of `page` it points to. To increase accuracy, every
+// entry is looked for below the line of the section or subsection that
+// precedes it.
+void toc_lines(toc_entry_t *toc, unsigned toc_len) {
+  unsigned i;      // iterator
+  int head_ln = 0; // line of the previous section or subsection
+
+  for (i = 0; i < toc_len; i++) {
+    toc[i].line = ls_discover(toc[i].text, MAX(0, head_ln));
+    if (TT_HEAD == toc[i].type || TT_SUBHEAD == toc[i].type)
+      head_ln = ls_discover(toc[i].text, 0);
+  }
+}
+
+// Helper of `search_re_all()`. Place a multibyte copy of the text of lines
+// [`from`, `to`) of `lines`, each one terminated by '\0', into `*dst`, and the
+// offsets of the lines in `*dst` (plus the offset of its end) into `*offs`.
+// (The offset of line `ln` is `(*offs)[ln - from]`.) Characters that can't be
+// converted are replaced with '?'.
+void mb_lines(char **dst, unsigned **offs, const line_t *lines, unsigned from,
+              unsigned to) {
+  unsigned ln, c;          // iterators
+  unsigned len = 0;        // length of `*dst`
+  char tmp[MB_LEN_MAX];    // current character, converted
+  mbstate_t mbs;           // conversion state
+  unsigned res_size = BS_LONG;               // allocated length of `res`
+  char *res = aalloc(res_size, char);        // result
+  unsigned *res_offs = aalloc(to - from + 1, unsigned); // line offsets
+
+  for (ln = from; ln < to; ln++) {
+    const wchar_t *text = line_at(lines, ln)->text; // text of current line
+    res_offs[ln - from] = len;
+    for (c = 0; L'\0' != text[c]; c++) {
+      memset(&mbs, 0, sizeof(mbs));
+      size_t clen = wcrtomb(tmp, text[c], &mbs); // length of `tmp`
+      if ((size_t)-1 == clen) {
+        tmp[0] = '?';
+        clen = 1;
+      }
+      if (len + clen + 1 > res_size) {
+        res_size *= 2;
+        res = xreallocarray(res, res_size, sizeof(char));
+      }
+      memcpy(&res[len], tmp, clen);
+      len += clen;
+    }
+    if (len + 1 > res_size) {
+      res_size *= 2;
+      res = xreallocarray(res, res_size, sizeof(char));
+    }
+    res[len++] = '\0';
+  }
+  res_offs[to - from] = len;
+
+  *dst = res;
+  *offs = res_offs;
+}
+
+// Helper of `search()` and `search_inc()`. Search for all occurrences of
+// `needle` in lines [`from`, `to`) of `lines` (of length `lines_len`),
+// including overlapping ones, and place them into `dst` (or NULL, if there are
+// none). Return the number of occurrences. `cs` has the same meaning as in
+// `search()`.
+unsigned search_all(result_t **dst, const wchar_t *needle,
+                    const line_t *lines, unsigned lines_len, unsigned from,
+                    unsigned to, bool cs) {
+  unsigned ln;                                // current line no.
+  unsigned i = 0;                             // current result no.
+  const unsigned needle_len = wcslen(needle); // length of `needle`
+  wchar_t *cur_hayst;         // current haystuck (i.e. text of current line)
+  wchar_t *hit = NULL;        // current return value of `wcsstr()`
+  unsigned res_len = BS_LINE; // result buffer length
+  result_t *res = aalloc(res_len, result_t); // result buffer
+
+  if (cs) {
+    // Case-insensitive search is performed on a lower-case copy of the text of
+    // all lines, so that the text doesn't need to be converted again for each
+    // search
+    wchar_t *fold;       // lower-case text
+    unsigned *fold_offs; // line offsets in `fold`
+    const unsigned base = get_fold(&fold, &fold_offs, lines, lines_len, from,
+                                   to); // line number of `fold_offs[0]`
+
+    wchar_t *fneedle = walloca(needle_len); // lower-case `needle`
+    for (ln = 0; ln < needle_len; ln++)
+      fneedle[ln] = towlower(needle[ln]);
+
+    // Look for occurrences of the first character of `fneedle` (using the
+    // C library's vectorized `wmemchr()`), and compare the rest of `fneedle`
+    // only at those locations. Lines are separated by L'\0', which never
+    // occurs in `fneedle`, so no occurrence can span two lines.
+    const wchar_t *p = fold + fold_offs[from - base];  // current position
+    const wchar_t *fend = fold + fold_offs[to - base]; // end of searched part
+    ln = from;
+    while (fend - p >= needle_len &&
+           NULL != (p = wmemchr(p, fneedle[0], fend - p - needle_len + 1))) {
+      if (0 != wmemcmp(p + 1, fneedle + 1, needle_len - 1)) {
+        p++;
+        continue;
+      }
+      // Find the line `p` is in
+      while (p - fold >= fold_offs[ln - base + 1])
+        ln++;
+      res[i].line = ln;
+      res[i].start = p - fold - fold_offs[ln - base];
+      res[i].end = res[i].start + needle_len;
+      res[i].term = 0;
+      inc_i;
+      p++;
+    }
+
+    put_fold(fold, fold_offs);
+  } else {
+    // For each line...
+    for (ln = from; ln < to; ln++) {
+      // Start at the beginning of the line's text
+      cur_hayst = line_at(lines, ln)->text;
+      // Search for `needle`
+      hit = wcsstr(cur_hayst, needle);
+      // While `needle` has been found...
+      while (NULL != hit) {
+        // Add the search result to `res[i]`
+        res[i].line = ln;
+        res[i].start = hit - lines[ln].text;
+        res[i].end = res[i].start + needle_len;
+        res[i].term = 0;
+        // Go to the character that follows the start of `needle`
+        cur_hayst = hit + 1;
+        // And search for `needle` again
+        if (cur_hayst - lines[ln].text < lines[ln].length)
+          hit = wcsstr(cur_hayst, needle);
+        else
+          hit = NULL;
+        // Increment `i` (and reallocate memory if necessary)
+        inc_i;
+      }
+    }
+  }
+
+  // If no occurrences were found, free the result buffer
+  if (0 == i) {
+    free(res);
+    res = NULL;
+  }
+
+  *dst = res;
+  return i;
+}
+
+// Helper of `search_inc()`. Search for all matches of `re` in lines [`from`,
+// `to`) of `lines` (of length `lines_len`), and place them into `dst` (or NULL,
+// if there are none). Return the number of matches. Matches are searched for
+// in a multibyte copy of the text of all lines, which, for `page`, is kept in
+// `page_mb` and `page_mb_offs`. Empty matches are ignored.
+unsigned search_re_all(result_t **dst, const regex_t *re, const line_t *lines,
+                       unsigned lines_len, unsigned from, unsigned to) {
+  unsigned ln;                // current line no.
+  unsigned i = 0;             // current result no.
+  regmatch_t pmatch[1];       // current match
+  unsigned res_len = BS_LINE; // result buffer length
+  result_t *res = aalloc(res_len, result_t); // result buffer
+
+  // The multibyte text of `page` is kept, unless `page` is laid out lazily
+  // (see `aw_lazy_t`), in which case only the searched lines are converted, so
+  // that the rest don't need to be filled in
+  const bool keep = lines == page && lines != aw_lazy.lines; // keep `mb`
+  const unsigned base = keep ? 0 : from; // line number of `mb_offs[0]`
+  char *mb = page_mb;                    // multibyte text
+  unsigned *mb_offs = page_mb_offs;      // line offsets in `mb`
+  if (!keep)
+    mb_lines(&mb, &mb_offs, lines, from, to);
+  else if (NULL == mb) {
+    mb_lines(&mb, &mb_offs, lines, 0, lines_len);
+    page_mb = mb;
+    page_mb_offs = mb_offs;
+  }
+
+  // For each line...
+  for (ln = from; ln < to; ln++) {
+    const char *line = &mb[mb_offs[ln - base]]; // line's text
+    unsigned off = 0;                     // byte offset of current position
+    unsigned coff = 0;                    // character offset of same
+    int eflags = 0;                       // `regexec()` flags
+    // While there's a match...
+    while (0 == regexec(re, &line[off], 1, pmatch, eflags)) {
+      const unsigned so = off + pmatch[0].rm_so; // match start byte offset
+      const unsigned eo = off + pmatch[0].rm_eo; // match end byte offset
+      // Convert the match's byte offsets to character offsets
+      mbstate_t mbs;
+      memset(&mbs, 0, sizeof(mbs));
+      while (off < so) {
+        off += MAX(1, mbrlen(&line[off], MB_LEN_MAX, &mbs));
+        coff++;
+      }
+      const unsigned cso = coff; // match start character offset
+      while (off < eo) {
+        off += MAX(1, mbrlen(&line[off], MB_LEN_MAX, &mbs));
+        coff++;
+      }
+      if (cso < coff) {
+        res[i].line = ln;
+        res[i].start = cso;
+        res[i].end = coff;
+        res[i].term = 0;
+        inc_i;
+      } else if ('\0' != line[off]) {
+        // Skip past empty matches
+        off += MAX(1, mbrlen(&line[off], MB_LEN_MAX, &mbs));
+        coff++;
+      }
+      if ('\0' == line[off])
+        break;
+      eflags = REG_NOTBOL;
+    }
+  }
+
+  if (!keep) {
+    free(mb);
+    free(mb_offs);
+  }
+
+  // If no matches were found, free the result buffer
+  if (0 == i) {
+    free(res);
+    res = NULL;
+  }
+
+  *dst = res;
+  return i;
+}
+
+// Helper of `search_multi_all()`. Compare search results `a` and `b` by start
+// position, placing longer results first.
+int result_cmp(const void *a, const void *b) {
+  const result_t *ra = a, *rb = b;
+
+  if (ra->start != rb->start)
+    return ra->start < rb->start ? -1 : 1;
+  if (ra->end != rb->end)
+    return ra->end > rb->end ? -1 : 1;
+  return 0;
+}
+
+// Helper of `search_inc()`. Search for all terms of `ac` in lines
+// [`from`, `to`) of `lines` (of length `lines_len`), in a single pass, and
+// place them into `dst` (or NULL, if none were found). Return the number of
+// results. Where occurrences overlap, the leftmost (and then longest) one wins.
+// `cs` signifies whether search is case-insensitive (in which case `ac` must
+// have been built with lower-case terms, and `page_fold` is used for `page`).
+unsigned search_multi_all(result_t **dst, const ac_t *ac, const line_t *lines,
+                          unsigned lines_len, unsigned from, unsigned to,
+                          bool cs) {
+  unsigned ln, c, j;          // iterators
+  unsigned i = 0;             // current result no.
+  unsigned res_len = BS_LINE; // result buffer length
+  result_t *res = aalloc(res_len, result_t);   // result buffer
+  unsigned locc_size = BS_SHORT;                // allocated length of `locc`
+  result_t *locc = aalloc(locc_size, result_t); // occurrences in current line
+
+  wchar_t *fold = NULL;       // lower-case text
+  unsigned *fold_offs = NULL; // line offsets in `fold`
+  unsigned base = 0;          // line number of `fold_offs[0]`
+  if (cs)
+    base = get_fold(&fold, &fold_offs, lines, lines_len, from, to);
+
+  // For each line...
+  for (ln = from; ln < to; ln++) {
+    const wchar_t *text =
+        cs ? &fold[fold_offs[ln - base]] : line_at(lines, ln)->text;
+    unsigned locc_len = 0; // length of `locc`
+    unsigned state = 0;    // current state of `ac`
+
+    // Feed the line's text to `ac`, and gather all occurrences of all terms
+    for (c = 0; L'\0' != text[c]; c++) {
+      state = ac_next(ac, state, text[c]);
+      unsigned n = -1 == ac->nodes[state].term ? ac->nodes[state].out : state;
+      for (; 0 != n; n = ac->nodes[n].out) {
+        if (locc_len == locc_size) {
+          locc_size *= 2;
+          locc = xreallocarray(locc, locc_size, sizeof(result_t));
+        }
+        locc[locc_len].line = ln;
+        locc[locc_len].start = c + 1 - ac->nodes[n].depth;
+        locc[locc_len].end = c + 1;
+        locc[locc_len].term = ac->nodes[n].term;
+        locc_len++;
+      }
+    }
+
+    // Keep the ones that don't overlap
+    if (locc_len > 1)
+      qsort(locc, locc_len, sizeof(result_t), result_cmp);
+    unsigned last_end = 0; // end of last kept occurrence
+    for (j = 0; j < locc_len; j++)
+      if (locc[j].start >= last_end) {
+        res[i] = locc[j];
+        last_end = locc[j].end;
+        inc_i;
+      }
+  }
+
+  free(locc);
+  put_fold(fold, fold_offs);
+
+  // If no occurrences were found, free the result buffer
+  if (0 == i) {
+    free(res);
+    res = NULL;
+  }
+
+  *dst = res;
+  return i;
+}
+
+// Helper of `search()` and `search_inc()`. Out of `occ` (of length `occ_len`),
+// a list of occurrences of a needle of length `needle_len` as returned by
+// `search_all()`, place the ones that a left-to-right scan would match into
+// `dst` (skipping occurrences that overlap the previous match), and return
+// their number.
+unsigned search_pick(result_t **dst, const result_t *occ, unsigned occ_len,
+                     unsigned needle_len) {
+  unsigned j;                                // iterator
+  unsigned i = 0;                            // current result no.
+  unsigned res_len = MAX(1, occ_len);        // result buffer length
+  result_t *res = aalloc(res_len, result_t); // result buffer
+
+  for (j = 0; j < occ_len; j++) {
+    if (i > 0 && occ[j].line == res[i - 1].line &&
+        occ[j].start < res[i - 1].end)
+      continue;
+    res[i] = occ[j];
+    res[i].end = res[i].start + needle_len;
+    i++;
+  }
+
+  // If no results were found, free the result buffer
+  if (0 == i)
+    free(res);
+
+  *dst = res;
+  return i;
+}
+
+// Helper of `search_inc()`. Out of `occ` (of length `occ_len`), a list of
+// occurrences of a needle in `lines`, place the ones that are followed by
+// character `c` (at distance `k` from their start) into `dst`, and return their
+// number. `cs` has the same meaning as in `search()`.
+unsigned search_narrow(result_t **dst, const result_t *occ, unsigned occ_len,
+                       const line_t *lines, wchar_t c, unsigned k, bool cs) {
+  unsigned j;                                // iterator
+  unsigned i = 0;                            // current result no.
+  result_t *res = aalloc(occ_len, result_t); // result buffer
+
+  if (cs)
+    c = towlower(c);
+  for (j = 0; j < occ_len; j++) {
+    const wchar_t oc = line_at(lines, occ[j].line)->text[occ[j].start + k];
+    if (c == (cs ? towlower(oc) : oc))
+      res[i++] = occ[j];
+  }
+
+  if (0 == i) {
+    free(res);
+    res = NULL;
+  }
+
+  *dst = res;
+  return i;
+}
+
+// Helper of `search_inc()` and `search_inc_one()`. Make room in `isearch` for
+// a needle of length `len` (and as many levels).
+void isearch_grow(unsigned len) {
+  unsigned k; // iterator
+
+  if (len <= isearch.size)
+    return;
+
+  const unsigned size = MAX(len, 2 * isearch.size); // new `isearch.size`
+  isearch.needle = xreallocarray(isearch.needle, size + 1, sizeof(wchar_t));
+  isearch.occ = xreallocarray(isearch.occ, size, sizeof(result_t *));
+  isearch.occ_len = xreallocarray(isearch.occ_len, size, sizeof(unsigned));
+  isearch.occ_size = xreallocarray(isearch.occ_size, size, sizeof(unsigned));
+  for (k = isearch.size; k < size; k++)
+    isearch.occ[k] = NULL;
+  isearch.size = size;
+}
+
+// Helper of `search_inc()`. Append `src` (of length `src_len`) to level `k` of
+// `isearch`.
+void isearch_append(unsigned k, const result_t *src, unsigned src_len) {
+  if (0 == src_len)
+    return;
+
+  if (isearch.occ_len[k] + src_len > isearch.occ_size[k]) {
+    isearch.occ_size[k] = MAX(2 * isearch.occ_size[k],
+                              isearch.occ_len[k] + src_len);
+    isearch.occ[k] =
+        xreallocarray(isearch.occ[k], isearch.occ_size[k], sizeof(result_t));
+  }
+  memcpy(&isearch.occ[k][isearch.occ_len[k]], src, src_len * sizeof(result_t));
+  isearch.occ_len[k] += src_len;
+}
+
+// Helper of `search_inc()` and `isearch_reset()`. Free the compiled regular
+// expression and Aho-Corasick automaton of `isearch`, if any.
+void isearch_free_matchers() {
+  if (isearch.re_ok)
+    regfree(&isearch.rex);
+  isearch.re_ok = false;
+  ac_free(&isearch.ac);
+}
+
+// Helper of `search_inc()`, for regular expression and multi-term searches.
+// Compile `needle` into `isearch.rex` or `isearch.ac` (unless that has already
+// been done), scan up to `slice` more lines of `lines` (of length `lines_len`),
+// and place all matches found so far into `dst`. Return their number. If
+// `needle` is not a valid regular expression, return 0 and stop the scan.
+unsigned search_inc_one(result_t **dst, const wchar_t *needle,
+                        const line_t *lines, unsigned lines_len, bool cs,
+                        unsigned slice) {
+  const unsigned len = wcslen(needle); // length of `needle`
+  result_t *occ;                       // current matches
+  unsigned occ_len;                    // length of `occ`
+
+  *dst = NULL;
+  if (0 == len)
+    return 0;
+
+  // Compile the regular expression, or split `needle` into terms and build an
+  // automaton for them, if this is a new search
+  if (0 == isearch.len) {
+    isearch_grow(len);
+    wcscpy(isearch.needle, needle);
+    isearch.occ[0] = NULL;
+    isearch.occ_len[0] = 0;
+    isearch.occ_size[0] = 0;
+    isearch.len = 1;
+    isearch.scanned = 0;
+    if (isearch.re) {
+      // (A needle that can't be converted to multibyte is an invalid regular
+      // expression)
+      const size_t mb_len = wcstombs(NULL, needle, 0); // multibyte length
+      if ((size_t)-1 != mb_len) {
+        char *needle_mb = salloc(mb_len); // `needle`, as a multibyte string
+        wcstombs(needle_mb, needle, mb_len + 1);
+        isearch.re_ok = 0 == regcomp(&isearch.rex, needle_mb,
+                                     REG_EXTENDED | (cs ? REG_ICASE : 0));
+        free(needle_mb);
+      }
+    } else {
+      unsigned c;                 // iterator
+      wchar_t *buf = walloc(len); // copy of `needle`, split into terms
+      const wchar_t **terms = aalloc(len + 1, const wchar_t *); // the terms
+      unsigned terms_len = 0; // number of terms
+      wcscpy(buf, isearch.needle);
+      terms[terms_len++] = buf;
+      for (c = 0; L'\0' != buf[c]; c++)
+        if (L'|' == buf[c]) {
+          buf[c] = L'\0';
+          terms[terms_len++] = &buf[c + 1];
+        }
+      ac_init(&isearch.ac, terms, terms_len, cs);
+      free(terms);
+      free(buf);
+    }
+  }
+  if (isearch.re && !isearch.re_ok) {
+    isearch.scanned = lines_len;
+    return 0;
+  }
+
+  // Scan up to `slice` more lines (or all of them, if `slice` is 0), starting
+  // at line `isearch.top` and wrapping around at the end of `lines`
+  unsigned todo = lines_len - isearch.scanned; // lines left to scan
+  if (slice > 0)
+    todo = MIN(todo, slice);
+  while (todo > 0) {
+    const unsigned from = (isearch.top + isearch.scanned) % lines_len;
+    const unsigned to = MIN(lines_len, from + todo);
+    if (isearch.re)
+      occ_len = search_re_all(&occ, &isearch.rex, lines, lines_len, from, to);
+    else
+      occ_len = search_multi_all(&occ, &isearch.ac, lines, lines_len, from, to,
+                                 cs);
+    isearch_append(0, occ, occ_len);
+    if (occ_len > 0)
+      free(occ);
+    isearch.scanned += to - from;
+    todo -= to - from;
+  }
+
+  // Place matches before line `isearch.top` (which were found last) first
+  occ = isearch.occ[0];
+  occ_len = isearch.occ_len[0];
+  if (0 == occ_len)
+    return 0;
+  unsigned split = 0; // number of matches at or after `isearch.top`
+  while (split < occ_len && occ[split].line >= isearch.top)
+    split++;
+  result_t *res = aalloc(occ_len, result_t); // result
+  memcpy(res, &occ[split], (occ_len - split) * sizeof(result_t));
+  memcpy(&res[occ_len - split], occ, split * sizeof(result_t));
+
+  *dst = res;
+  return occ_len;
 }
 
 //
@@ -838,7 +2118,7 @@ void init() {
   // Initialize history
   history_cur = 0;
   history_top = 0;
-  history = aalloc(config.misc.history_size, request_t);
+  history_room();
   history_replace(RT_NONE, NULL);
 
   // Initialize `page_title`
@@ -860,7 +2140,15 @@ void init() {
 }
 
 void late_init() {
-  // Initialize `aw_all`
+  aprowhat_t *old_aw = aw_all;            // previous `aw_all`, if any
+  const unsigned old_aw_len = aw_all_len; // length of `old_aw`
+  wchar_t **old_sc = sc_all;              // previous `sc_all`, if any
+  const unsigned old_sc_len = sc_all_len; // length of `old_sc`
+
+  // Initialize `aw_all` (`aprowhat_exec()` mustn't answer from the previous
+  // `aw_all`, if any, hence it's considered empty until then)
+  aw_all = NULL;
+  aw_all_len = 0;
   if (ST_FREEBSD == config.misc.system_type ||
       ST_DARWIN == config.misc.system_type)
     aw_all_len = aprowhat_exec(&aw_all, AW_APROPOS, L"'.'");
@@ -868,7 +2156,34 @@ void late_init() {
     aw_all_len = aprowhat_exec(&aw_all, AW_APROPOS, L"''");
 
   // Initialize `sc_all`
+  sc_all = NULL;
   sc_all_len = aprowhat_sections(&sc_all, aw_all, aw_all_len);
+  aw_all_gen++;
+
+  // Free the previous `aw_all` and `sc_all`. (If the page laid out in
+  // `aw_lazy` is still using `old_aw`, it owns `old_aw` from now on.)
+  if (NULL != old_aw && old_aw == aw_lazy.aw && !aw_lazy.aw_own)
+    aw_lazy.aw_own = true;
+  else if (NULL != old_aw)
+    aprowhat_free(old_aw, old_aw_len);
+  if (NULL != old_sc)
+    wafree(old_sc, old_sc_len);
+}
+
+void conf_index_desc(char *dst, unsigned dst_len) {
+  snprintf(dst, dst_len, "%d\n%s\n%s\n%s", config.misc.system_type,
+           config.misc.man_path, config.misc.apropos_path,
+           config.misc.whatis_path);
+}
+
+void conf_page_desc(char *dst, unsigned dst_len) {
+  snprintf(dst, dst_len, "%s\n%d\n%d\n%d\n%d%d%d%d%d%d\n%ls",
+           config.misc.groff_path, config.misc.builtin_formatter,
+           config.layout.lmargin, config.layout.rmargin,
+           config.capabilities.sections_on_top, config.capabilities.http_links,
+           config.capabilities.email_links, config.capabilities.file_links,
+           config.capabilities.hyphenate, config.capabilities.justify,
+           config.misc.program_version);
 }
 
 int parse_options(int argc, char *const *argv) {
@@ -944,6 +2259,55 @@ int parse_options(int argc, char *const *argv) {
       // -z or --cli-force-color was passed; force-enable color for the CLI
       config.misc.cli_force_color = true;
       break;
+    case 'B':
+      // -B or --batch was passed; read page names from `optarg`, and do not
+      // launch the TUI
+      if (NULL != batch_path)
+        free(batch_path);
+      batch_path = xstrdup(optarg);
+      config.layout.tui = false;
+      break;
+    case 'j': {
+      // -j or --jobs was passed; set the number of batch mode workers
+      char *jobs_end;                                 // end of the number
+      const long jobs = strtol(optarg, &jobs_end, 10); // number of workers
+      if ('\0' == optarg[0] || '\0' != *jobs_end || jobs < 1 ||
+          jobs > BATCH_JOBS_MAX) {
+        wchar_t errmsg[BS_SHORT];
+        swprintf(errmsg, BS_SHORT,
+                 L"Number of jobs must be an integer between 1 and %d",
+                 BATCH_JOBS_MAX);
+        free(longopts);
+        winddown(ES_USAGE_ERROR, errmsg);
+      }
+      batch_jobs = jobs;
+      break;
+    }
+    case 'o':
+      // -o or --output-dir was passed; write batch mode output to `optarg`
+      if (NULL != batch_dir)
+        free(batch_dir);
+      batch_dir = xstrdup(optarg);
+      break;
+    case 'S':
+      // -S or --server was passed; run as a server, and do not launch the TUI
+      server_mode = true;
+      config.layout.tui = false;
+      break;
+    case 'F':
+      // -F or --fulltext was passed; try to show full-text search results
+      history_replace(RT_FULLTEXT, NULL);
+      break;
+    case 'U':
+      // -U or --update-index was passed; build the full-text index, and do not
+      // launch the TUI
+      index_mode = true;
+      config.layout.tui = false;
+      break;
+    case 'R':
+      // -R or --resume was passed; restore the last saved session
+      resume_mode = true;
+      break;
     case 'A':
       // -A or --action was passed; set `first_action` to the program action
       // that corresponds `optarg`
@@ -1016,6 +2380,9 @@ void parse_args(int argc, char *const *argv) {
       case RT_APROPOS:
         winddown(ES_USAGE_ERROR, L"Apropos what?");
         break;
+      case RT_FULLTEXT:
+        winddown(ES_USAGE_ERROR, L"Search the text of manual pages for what?");
+        break;
       case RT_WHATIS:
       default:
         winddown(ES_USAGE_ERROR, L"Whatis what?");
@@ -1122,16 +2489,17 @@ void history_push(request_type_t rt, const wchar_t *args) {
   // Make `history_top` equal to `history_cur`
   history_top = history_cur;
 
-  // Failsafe: in the unlikely case `history_top` exceeds history size, free
-  // all memory used by `history` and start over
-  if (history_top >= config.misc.history_size) {
-    requests_free(history, config.misc.history_size);
-    history_top = 0;
-    history_cur = 0;
-    history = aalloc(config.misc.history_size, request_t);
+  // If `history` is full, evict its oldest entry
+  if (history_top >= MAX(1, config.misc.history_size)) {
+    if (NULL != history[0].args)
+      free(history[0].args);
+    history++;
+    history_cur--;
+    history_top--;
   }
 
   // Populate the new history entry
+  history_room();
   history_replace(rt, args);
 }
 
@@ -1166,6 +2534,11 @@ void history_reset() {
 
 unsigned aprowhat_exec(aprowhat_t **dst, aprowhat_cmd_t cmd,
                        const wchar_t *args) {
+  // Searches that can be answered from `aw_all` don't need a command
+  const int local_len = aprowhat_local(dst, cmd, args);
+  if (-1 != local_len)
+    return local_len;
+
   if (ST_DARWIN == config.misc.system_type) {
     // macOS X requires its own special `aprowhat_exec()`
     return aprowhat_exec_darwin(dst, cmd, args);
@@ -1326,189 +2699,130 @@ unsigned aprowhat_sections(wchar_t ***dst, const aprowhat_t *aw,
   return res_i;
 }
 
-unsigned aprowhat_render(line_t **dst, const aprowhat_t *aw,
-                         const unsigned aw_len, const wchar_t *const *sc,
-                         const unsigned sc_len, const wchar_t *key,
-                         const wchar_t *title, const wchar_t *ver,
-                         const wchar_t *date) {
-  // Text blocks widths
-  const unsigned line_width = MAX(60, config.layout.main_width);
-  const unsigned lmargin_width = config.layout.lmargin; // left margin
-  const unsigned rmargin_width = config.layout.rmargin; // right margin
-  const unsigned text_width =
-      line_width - lmargin_width - rmargin_width; // main text area
-  const unsigned hfc_width =
-      text_width / 2 + text_width % 2; // header/footer center area
-  const unsigned hfl_width =
-      (text_width - hfc_width) / 2; // header/footer left area
-  const unsigned hfr_width =
-      hfl_width + (text_width - hfc_width) % 2; // header/footer right area
+unsigned aprowhat_render(line_t **dst, aprowhat_t *aw, const unsigned aw_len,
+                         const wchar_t *const *sc, const unsigned sc_len,
+                         const wchar_t *key, const wchar_t *title,
+                         const wchar_t *ver, const wchar_t *date, bool aw_own) {
+  unsigned ln = 0; // current line number
+  unsigned bl = 0; // current block number
+  unsigned i, j;   // iterators
+
+  // Only one page can be laid out in `aw_lazy` at a time. `populate_page()`
+  // frees the previous page before rendering the next one, so this never
+  // happens in practice; but, should some other page still be laid out, fill
+  // in whatever is left of it before forgetting its layout, since its lines
+  // could no longer be filled in afterwards
+  if (NULL != aw_lazy.lines) {
+    for (bl = 0; bl < aw_lazy.blocks_len; bl++)
+      line_at(aw_lazy.lines, aw_lazy.block_ln[bl]);
+    bl = 0;
+    aprowhat_release();
+  }
 
-  unsigned ln = 0;      // current line number
-  unsigned i, j;        // iterators
-  wchar_t tmp[BS_LINE]; // temporary
-  memset(tmp, 0, sizeof(wchar_t) * BS_LINE);
+  // Keep everything needed to render the page's blocks later on
+  aw_lazy.aw = aw;
+  aw_lazy.aw_len = aw_len;
+  aw_lazy.aw_own = aw_own;
+  aw_lazy.sc = aalloc(MAX(1, sc_len), wchar_t *);
+  for (i = 0; i < sc_len; i++)
+    aw_lazy.sc[i] = xwcsdup(sc[i]);
+  aw_lazy.sc_len = sc_len;
+  wcslcpy(aw_lazy.key, key, BS_SHORT);
+  wcslcpy(aw_lazy.title, title, BS_SHORT);
+  wcslcpy(aw_lazy.ver, ver, BS_SHORT);
+  wcslcpy(aw_lazy.date, date, BS_SHORT);
+  aw_lazy.width = config.layout.main_width;
+  aw_lazy.lmargin = config.layout.lmargin;
+  aw_lazy.rmargin = config.layout.rmargin;
+
+  const unsigned blocks_len = aw_len + sc_len + 3; // max. number of blocks
+  aw_lazy.block_ln = aalloc(blocks_len, unsigned);
+  aw_lazy.block_item = aalloc(blocks_len, int);
 
   unsigned res_len = BS_LINE;            // result buffer length
   line_t *res = aalloc(res_len, line_t); // result buffer
 
+  // Lay out the page one block at a time; the lines of each block are left
+  // empty, but their number, lengths, and numbers of links are known
+
   // Header
-  line_alloc(res[ln], line_width);
-  const unsigned title_len = wcslen(title); // `title` length
-  const unsigned key_len = wcslen(key);     // `key` length
-  const unsigned lts_len =
-      (hfc_width - title_len) / 2 +
-      (hfc_width - title_len) % 2; // length of space on the left of `title`
-  const unsigned rts_len =
-      (hfc_width - title_len) / 2; // length of space on the right of `title`
-  swprintf(res[ln].text, line_width + 1, L"%*s%-*ls%*s%ls%*s%*ls%*s", //
-           lmargin_width, "",                                         //
-           hfl_width, key,                                            //
-           lts_len, "",                                               //
-           title,                                                     //
-           rts_len, "",                                               //
-           hfr_width, key,                                            //
-           rmargin_width, ""                                          //
-  );
-  bset(res[ln].uline, lmargin_width);
-  bset(res[ln].reg, lmargin_width + key_len);
-  bset(res[ln].uline,
-       lmargin_width + hfl_width + hfc_width + hfr_width - key_len);
-  bset(res[ln].reg, lmargin_width + hfl_width + hfc_width + hfr_width);
+  add_block(AB_HEAD);
 
   // Only if list of sections is enabled
   if (config.capabilities.sections_on_top) {
-    // Newline
-    inc_ln;
-    line_alloc(res[ln], 0);
-
-    // Section title for sections
-    inc_ln;
-    line_alloc(res[ln], line_width);
-    wcslcpy(tmp, L"SECTIONS", BS_LINE);
-    swprintf(res[ln].text, line_width + 1, L"%*s%-*ls", //
-             lmargin_width, "",                         //
-             text_width, tmp);
-    bset(res[ln].bold, lmargin_width);
-    bset(res[ln].reg, lmargin_width + wcslen(tmp));
-
-    // Sections
-    const unsigned sc_maxwidth = MIN(
-        text_width / 2 - 4, wmaxlen(sc, sc_len)); // length of longest section
-    const unsigned sc_cols =
-        text_width / (4 + sc_maxwidth); // number of columns for sections
-    const unsigned sc_lines =
-        sc_len % sc_cols > 0
-            ? 1 + sc_len / sc_cols
-            : MAX(1, sc_len / sc_cols); // number of lines for sections
-    unsigned sc_i;                      // index of current section
-    for (i = 0; i < sc_lines; i++) {
-      inc_ln;
-      line_alloc(res[ln], line_width + 4); // +4 for section margin
-      swprintf(res[ln].text, line_width + 1, L"%*s", lmargin_width, "");
-      for (j = 0; j < sc_cols; j++) {
-        sc_i = sc_cols * i + j;
-        if (sc_i < sc_len) {
-          swprintf(tmp, sc_maxwidth + 5, L" %-*ls", sc_maxwidth + 3, sc[sc_i]);
-          wcslcat(res[ln].text, tmp, line_width + 1);
-          swprintf(tmp, BS_LINE, L"MANUAL PAGES IN SECTION '%ls'", sc[sc_i]);
-          add_link(&res[ln], lmargin_width + j * (sc_maxwidth + 4) + 1,
-                   lmargin_width + j * (sc_maxwidth + 4) +
-                       MIN(sc_maxwidth + 3, wcslen(sc[sc_i]) + 1),
-                   false, 0, 0, LT_LS, tmp);
-        }
-      }
-    }
+    add_block(AB_SECTIONS);
   }
 
   // For each section...
   for (i = 0; i < sc_len; i++) {
-    // Newline
-    inc_ln;
-    line_alloc(res[ln], 0);
-
     // Section title
-    inc_ln;
-    line_alloc(res[ln], line_width);
-    swprintf(tmp, text_width + 1, L"MANUAL PAGES IN SECTION '%ls'", sc[i]);
-    swprintf(res[ln].text, line_width + 1, L"%*s%-*ls", //
-             lmargin_width, "",                         //
-             text_width, tmp);
-    bset(res[ln].bold, lmargin_width);
-    bset(res[ln].reg, lmargin_width + wcslen(tmp));
-
-    // For each manual page...
-    for (j = 0; j < aw_len; j++) {
-      // If manual page is in current section...
+    add_block(AB_SECTION - (int)i);
+
+    // For each manual page in current section...
+    for (j = 0; j < aw_len; j++)
       if (0 == wcscmp(aw[j].section, sc[i])) {
-        const unsigned lc_width = text_width / 3;        // left column width
-        const unsigned rc_width = text_width - lc_width; // right column width
-        const unsigned page_width = wcslen(aw[j].page) + wcslen(aw[j].section) +
-                                    2; // width of manual page name and section
-        const unsigned spcl_width =
-            MAX(line_width,
-                lmargin_width + page_width +
-                    rmargin_width); // used in place of line_width; might be
-                                    // longer, in which case we'll scroll
-
-        // Page name and section (`ident`)
-        inc_ln;
-        line_alloc(res[ln], spcl_width);
-        swprintf(res[ln].text, spcl_width + 1, L"%*s%-*ls", //
-                 lmargin_width, "",                         //
-                 lc_width, aw[j].ident);
-        add_link(&res[ln], lmargin_width, lmargin_width + wcslen(aw[j].ident),
-                 false, 0, 0, LT_MAN, aw[j].ident);
-
-        // Description
-        wcslcpy(tmp, aw[j].descr, BS_LINE);
-        wwrap(tmp, rc_width);
-        wchar_t *buf;
-        wchar_t *ptr = wcstok(tmp, L"\n", &buf);
-        if (NULL != ptr && page_width < lc_width) {
-          wcslcat(res[ln].text, ptr, line_width + 1);
-          ptr = wcstok(NULL, L"\n", &buf);
-        }
-        while (NULL != ptr) {
-          inc_ln;
-          line_alloc(res[ln], line_width);
-          swprintf(res[ln].text, line_width + 1, L"%*s%ls", //
-                   lmargin_width + lc_width, "",            //
-                   ptr);
-          ptr = wcstok(NULL, L"\n", &buf);
-        }
+        add_block((int)j);
       }
-    }
   }
 
-  // Newline
-  inc_ln;
-  line_alloc(res[ln], 0);
-
   // Footer
-  inc_ln;
-  line_alloc(res[ln], line_width);
-  const unsigned date_len = wcslen(date); // date length
-  const unsigned lds_len =
-      (hfc_width - date_len) / 2 +
-      (hfc_width - date_len) % 2; // length of space on the left of date
-  const unsigned rds_len =
-      (hfc_width - date_len) / 2; // length of space on the right of date
-  swprintf(res[ln].text, line_width + 1, L"%*s%-*ls%*s%ls%*s%*ls%*s", //
-           lmargin_width, "",                                         //
-           hfl_width, ver,                                            //
-           lds_len, "",                                               //
-           date,                                                      //
-           rds_len, "",                                               //
-           hfr_width, key,                                            //
-           rmargin_width, ""                                          //
-  );
-  bset(res[ln].uline,
-       lmargin_width + hfl_width + hfc_width + hfr_width - key_len);
-  bset(res[ln].reg, lmargin_width + hfl_width + hfc_width + hfr_width);
+  add_block(AB_FOOT);
+
+  aw_lazy.lines = res;
+  aw_lazy.lines_len = ln;
+  aw_lazy.blocks_len = bl;
 
   *dst = res;
-  return ln + 1;
+  return ln;
+}
+
+const line_t *line_at(const line_t *lines, unsigned ln) {
+  if (lines != aw_lazy.lines || ln >= aw_lazy.lines_len ||
+      NULL != lines[ln].text)
+    return &lines[ln];
+
+  // Find the block that contains line `ln`
+  unsigned lo = 0, hi = aw_lazy.blocks_len; // binary search range
+  while (hi - lo > 1) {
+    const unsigned mid = lo + (hi - lo) / 2;
+    if (aw_lazy.block_ln[mid] <= ln)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  // Render it (through `aw_lazy.lines`, which is where the lines belong)
+  aprowhat_block(&aw_lazy.lines[aw_lazy.block_ln[lo]], aw_lazy.block_item[lo],
+                 false);
+
+  return &lines[ln];
+}
+
+int aprowhat_discover(const wchar_t *trgt, unsigned sln) {
+  const unsigned line_width = MAX(60, aw_lazy.width);
+  const unsigned text_width =
+      line_width - aw_lazy.lmargin - aw_lazy.rmargin; // main text area
+  wchar_t tmp[BS_LINE];                               // current title
+  unsigned bl;                                        // iterator
+
+  if (NULL == page || page != aw_lazy.lines)
+    return -1;
+
+  // Titles are the second line of their blocks
+  for (bl = 0; bl < aw_lazy.blocks_len; bl++) {
+    const int item = aw_lazy.block_item[bl]; // current block contents
+    if (AB_SECTIONS == item)
+      wcslcpy(tmp, L"SECTIONS", BS_LINE);
+    else if (item <= AB_SECTION)
+      swprintf(tmp, text_width + 1, L"MANUAL PAGES IN SECTION '%ls'",
+               aw_lazy.sc[AB_SECTION - item]);
+    else
+      continue;
+    if (aw_lazy.block_ln[bl] + 1 >= sln && 0 == wcscmp(tmp, trgt))
+      return aw_lazy.block_ln[bl] + 1;
+  }
+
+  return -1;
 }
 
 int aprowhat_search(const wchar_t *needle, const aprowhat_t *hayst,
@@ -1544,31 +2858,19 @@ bool aprowhat_has(const wchar_t *needle, const aprowhat_t *hayst,
   return false;
 }
 
-unsigned man_sections(wchar_t ***dst, const wchar_t *args, bool local_file) {
-  char gpath[BS_LINE];    // path to groff document for manual page
+unsigned man_sections_at(wchar_t ***dst, const char *gpath) {
   int glen;               // length of current line in groff document
   wchar_t gline[BS_LINE]; // current line in groff document
   unsigned en = 0;        // current entry in `res`
-  char tmp[BS_LINE];      // temporary
 
   unsigned res_len = BS_SHORT;                // result buffer length
   wchar_t **res = aalloc(res_len, wchar_t *); // result buffer
 
-  // Use `man` to figure out `gpath`
-  if (false == man_loc(gpath, BS_LINE, args, local_file))
-    winddown(ES_OPER_ERROR, L"Failed to locate manual page source file");
-
   // Open `gpath`
   archive_t gp = aropen(gpath);
 
-  // For each line in `gpath`, `gline`...
-  argets(gp, tmp, BS_LINE);
-  while (!areof(gp)) {
-    glen = xmbstowcs(gline, tmp, BS_LINE);
-
-    if (-1 == glen)
-      winddown(ES_OPER_ERROR, L"Failed to read manual page source");
-
+  // For each macro line in `gpath`, `gline`...
+  while (-1 != (glen = man_getline(gline, &gp, true))) {
     // If line is a section heading, add the corresponding data to `res`
     if (got_sh) {
       // Section heading
@@ -1580,17 +2882,25 @@ unsigned man_sections(wchar_t ***dst, const wchar_t *args, bool local_file) {
         inc_en;
       }
     }
-
-    argets(gp, tmp, BS_LINE);
   }
 
-  arclose(gp);
+  arclose(&gp);
 
   secgroff(res, en);
   *dst = res;
   return en;
 }
 
+unsigned man_sections(wchar_t ***dst, const wchar_t *args, bool local_file) {
+  char gpath[BS_LINE]; // path to groff document for manual page
+
+  // Use `man` to figure out `gpath`
+  if (false == man_loc(gpath, BS_LINE, args, local_file))
+    winddown(ES_OPER_ERROR, L"Failed to locate manual page source file");
+
+  return man_sections_at(dst, gpath);
+}
+
 unsigned index_page(line_t **dst) {
   wchar_t key[] = L"INDEX";
   wchar_t title[] = L"All Manual Pages";
@@ -1599,9 +2909,9 @@ unsigned index_page(line_t **dst) {
   wcsftime(date, BS_SHORT, L"%x", gmtime(&now));
 
   line_t *res;
-  unsigned res_len = aprowhat_render(&res, aw_all, aw_all_len,
-                                     (const wchar_t **)sc_all, sc_all_len, key,
-                                     title, config.misc.program_version, date);
+  unsigned res_len = aprowhat_render(
+      &res, aw_all, aw_all_len, (const wchar_t **)sc_all, sc_all_len, key,
+      title, config.misc.program_version, date, false);
 
   *dst = res;
   return res_len;
@@ -1622,10 +2932,9 @@ unsigned aprowhat(line_t **dst, aprowhat_cmd_t cmd, const wchar_t *args,
   line_t *res;
   unsigned res_len =
       aprowhat_render(&res, aw, aw_len, (const wchar_t **)sc, sc_len, key,
-                      title, config.misc.program_version, date);
+                      title, config.misc.program_version, date, true);
 
-  aprowhat_free(aw, aw_len);
-  wafree(sc, sc_len);
+  aw_last_keep(AW_WHATIS == cmd ? RT_WHATIS : RT_APROPOS, args, sc, sc_len);
 
   *dst = res;
   return res_len;
@@ -1655,6 +2964,29 @@ unsigned man(line_t **dst, const wchar_t *args, bool local_file) {
                         // hypehnated links)
   wchar_t ilink_trgt[BS_LINE]; // embedded link URL
 
+  unsigned fl = 0;      // number of lines of `res` already printed (streaming)
+  unsigned dropped = 0; // number of lines dropped from `res` (streaming)
+  const bool tty =
+      page_stream && isatty(STDOUT_FILENO); // streaming to a terminal
+
+  const bool global =
+      config.misc.global_apropos || config.misc.global_whatis; // global search
+  char gpath[BS_LINE];   // path to groff document for manual page
+  bool gpath_ok = false; // `gpath` has been located
+
+  // If enabled, try the built-in formatter first, and only fall back to `man`
+  // if it fails. The page's source is only located once, and is reused for the
+  // list of sections.
+  if (config.misc.builtin_formatter && !global) {
+    gpath_ok = man_loc(gpath, BS_LINE, args, local_file);
+    ln = gpath_ok ? man_builtin(dst, gpath) : 0;
+    if (ln > 0) {
+      free(tmpw);
+      free(tmps);
+      return ln;
+    }
+  }
+
   unsigned res_len = BS_LINE;            // result buffer length
   line_t *res = aalloc(res_len, line_t); // result buffer
 
@@ -1762,56 +3094,11 @@ unsigned man(line_t **dst, const wchar_t *args, bool local_file) {
   // For each line of `man`'s output...
   while (!feof(pp)) {
     // At line 1, insert the list of sections (if enabled)
-    if (1 == ln && config.capabilities.sections_on_top &&
-        !config.misc.global_apropos && !config.misc.global_whatis) {
-      // Newline
-      line_alloc(res[ln], 0);
-
-      // Section title for sections
-      inc_ln;
-      line_alloc(res[ln], line_width);
-      wcslcpy(tmpw, L"SECTIONS", BS_LINE);
-      swprintf(res[ln].text, line_width + 1, L"%*s%-*ls", //
-               lmargin_width, "",                         //
-               text_width, tmpw);
-      bset(res[ln].bold, lmargin_width);
-      bset(res[ln].reg, lmargin_width + wcslen(tmpw));
-
-      // Sections
-      wchar_t **sc;                                          // sections
-      unsigned sc_len = man_sections(&sc, args, local_file); // no. of sections
-      const unsigned sc_maxwidth =
-          MIN(text_width / 2 - 4, wmaxlen((const wchar_t *const *)sc,
-                                          sc_len)); // length of longest section
-      const unsigned sc_cols =
-          text_width / (4 + sc_maxwidth); // number of columns for sections
-      const unsigned sc_lines =
-          sc_len % sc_cols > 0
-              ? 1 + sc_len / sc_cols
-              : MAX(1, sc_len / sc_cols); // number of lines for sections
-      unsigned sc_i;                      // index of current section
-      for (i = 0; i < sc_lines; i++) {
-        inc_ln;
-        line_alloc(res[ln], line_width + 4); // +4 for section margin
-        swprintf(res[ln].text, line_width + 1, L"%*s", lmargin_width, "");
-        for (j = 0; j < sc_cols; j++) {
-          sc_i = sc_cols * i + j;
-          if (sc_i < sc_len) {
-            swprintf(tmpw, sc_maxwidth + 5, L" %-*ls", sc_maxwidth + 3,
-                     sc[sc_i]);
-            wcslower(tmpw);
-            wcslcat(res[ln].text, tmpw, line_width + 1);
-            add_link(&res[ln], lmargin_width + j * (sc_maxwidth + 4) + 1,
-                     lmargin_width + j * (sc_maxwidth + 4) +
-                         MIN(sc_maxwidth + 3, wcslen(sc[sc_i])) + 1,
-                     false, 0, 0, LT_LS, sc[sc_i]);
-          }
-        }
-      }
-      inc_ln;
-
-      wafree(sc, sc_len);
-      len = xmbstowcs(tmpw, tmps, BS_LINE);
+    if (1 == ln && config.capabilities.sections_on_top && !global) {
+      if (!gpath_ok && !man_loc(gpath, BS_LINE, args, local_file))
+        winddown(ES_OPER_ERROR, L"Failed to locate manual page source file");
+      gpath_ok = true;
+      ln = man_sections_on_top(&res, &res_len, ln, gpath);
     }
 
     if (-1 == len) {
@@ -1927,6 +3214,35 @@ unsigned man(line_t **dst, const wchar_t *args, bool local_file) {
     len = xmbstowcs(tmpw, tmps, BS_LINE);
 
     inc_ln;
+
+    // If streaming, print every line but the one just completed (which might
+    // still receive an embedded link, or be needed for link discovery), and
+    // drop all of them but the last one printed (which is needed to print
+    // hyphenated links) and the one an unfinished embedded link starts on
+    if (page_stream) {
+      for (; fl + 1 < ln; fl++) {
+        if (dropped + fl >= 2)
+          man_link(&res[fl], &res[fl + 1]);
+        print_line(&res[fl], fl > 0 ? &res[fl - 1] : NULL);
+      }
+      if (tty)
+        print_flush();
+      unsigned drop = fl > 1 ? fl - 1 : 0; // number of lines to drop
+      if (ilink && ilink_ln < drop)
+        drop = ilink_ln;
+      if (drop > 0) {
+        for (i = 0; i < drop; i++) {
+          line_free(res[i]);
+        }
+        // (Only lines 0 to `ln - 1` have been read; `res[ln]` is unused)
+        memmove(res, &res[drop], (ln - drop) * sizeof(line_t));
+        ln -= drop;
+        fl -= drop;
+        dropped += drop;
+        if (ilink)
+          ilink_ln -= drop;
+      }
+    }
   }
 
   // Restore the environment
@@ -1939,23 +3255,27 @@ unsigned man(line_t **dst, const wchar_t *args, bool local_file) {
   free(tmpw);
   free(tmps);
 
-  // Discover and add links (skipping the first two lines, and the last line)
-  if (ln >= 2) {
-    for (unsigned i = 2; i < ln - 1; i++) {
-      discover_links(&re_man, &res[i], &res[i + 1], LT_MAN);
-      if (config.capabilities.http_links)
-        discover_links(&re_http, &res[i], &res[i + 1], LT_HTTP);
-      if (config.capabilities.email_links)
-        discover_links(&re_email, &res[i], &res[i + 1], LT_EMAIL);
-      if (config.capabilities.file_links)
-        discover_links(&re_file, &res[i], &res[i + 1], LT_FILE);
+  // If streaming, print and drop the remaining lines
+  if (page_stream) {
+    for (; fl < ln; fl++) {
+      if (dropped + fl >= 2 && fl + 1 < ln)
+        man_link(&res[fl], &res[fl + 1]);
+      print_line(&res[fl], fl > 0 ? &res[fl - 1] : NULL);
+    }
+    for (i = 0; i < ln; i++) {
+      line_free(res[i]);
     }
+    dropped += ln;
+    ln = 0;
   }
 
+  // Discover and add links
+  man_links(res, ln);
+
   // If no results were returned by `man`, set `err` to true and describe the
   // error in `err_msg`. Otherwise, set `err` to false.
   err = false;
-  if (0 == ln || status != 0) {
+  if (0 == dropped + ln || status != 0) {
     err = true;
     swprintf(err_msg, BS_LINE, L"No manual page for %ls", args);
   }
@@ -1970,7 +3290,6 @@ unsigned man_toc(toc_entry_t **dst, const wchar_t *args, bool local_file) {
   wchar_t gline[BS_LINE]; // current line in groff document
   unsigned en = 0;        // current entry in `res`
   bool sh_seen = false;   // whether a section header has been seen
-  char tmp[BS_LINE];      // temporary
   unsigned textsp; // real beginning of `gline`'s text (ignoring whitespace)
 
   unsigned res_len = BS_LINE;                      // result buffer length
@@ -1991,14 +3310,9 @@ unsigned man_toc(toc_entry_t **dst, const wchar_t *args, bool local_file) {
   // Open `gpath`
   archive_t gp = aropen(gpath);
 
-  // For each line in `gpath`, `gline`...
-  argets(gp, tmp, BS_LINE);
-  while (!areof(gp)) {
-    glen = xmbstowcs(gline, tmp, BS_LINE);
-
-    if (-1 == glen)
-      winddown(ES_OPER_ERROR, L"Failed to read manual page source");
-
+  // For each macro line in `gpath`, `gline`...
+  glen = man_getline(gline, &gp, true);
+  while (-1 != glen) {
     // If line can be a TOC entry, add the corresponding data to `res`
     if (got_sh) {
       // Section heading
@@ -2022,30 +3336,25 @@ unsigned man_toc(toc_entry_t **dst, const wchar_t *args, bool local_file) {
         inc_en;
       }
     } else if (got_tp && sh_seen) {
-      // Tagged paragraph
-      argets(gp, tmp, BS_LINE);
-      if (!areof(gp)) {
-        glen = xmbstowcs(gline, tmp, BS_LINE);
+      // Tagged paragraph (the tag line may be plain text, so it must always
+      // be decoded)
+      glen = man_getline(gline, &gp, false);
+      if (-1 != glen) {
         {
           // Edge case: the tag line contains only a comment or a line that
           // must otherwise be skipped; skip to next line
           while (got_comment || got_tp || got_pd) {
-            argets(gp, tmp, BS_LINE);
-            if (areof(gp))
+            glen = man_getline(gline, &gp, false);
+            if (-1 == glen)
               break;
-            glen = xmbstowcs(gline, tmp, BS_LINE);
           }
         }
         {
           // Edge case: the tag line starts with a formatting command that
           // sets a trap for the next line; skip to the next line
-          while (got_trap && wmargtrim(gline, NULL) < 4) {
-            argets(gp, tmp, BS_LINE);
-            if (areof(gp))
-              break;
-            glen = xmbstowcs(gline, tmp, BS_LINE);
-          }
-          if (areof(gp))
+          while (-1 != glen && got_trap && wmargtrim(gline, NULL) < 4)
+            glen = man_getline(gline, &gp, false);
+          if (-1 == glen)
             break;
         }
         {
@@ -2074,10 +3383,10 @@ unsigned man_toc(toc_entry_t **dst, const wchar_t *args, bool local_file) {
       }
     }
 
-    argets(gp, tmp, BS_LINE);
+    glen = man_getline(gline, &gp, true);
   }
 
-  arclose(gp);
+  arclose(&gp);
 
   tocgroff(res, en);
   *dst = res;
@@ -2112,206 +3421,352 @@ unsigned sc_toc(toc_entry_t **dst, const wchar_t *const *sc,
   return en;
 }
 
-CC_IGNORE_UNUSED_PARAMETER
 link_loc_t prev_link(const line_t *lines, unsigned lines_len,
                      link_loc_t start) {
-  CC_IGNORE_ENDS
-  unsigned i;
-  link_loc_t res;
+  link_loc_t res = {false, 0, 0}; // return value
+  link_loc_t *links;              // all links in `lines`
+  unsigned *offs;                 // link offsets of all lines in `links`
 
-  // If `start` was not found, return not found
-  if (!start.ok) {
-    res.ok = false;
+  // If `start` was not found, or is out of range, return not found
+  if (!start.ok || start.line >= lines_len)
     return res;
-  }
-
-  // If line no. `start.line` has a link before `start.link`, return that link
-  if (start.link > 0) {
-    res.ok = true;
-    res.line = start.line;
-    res.link = start.link - 1;
-    return res;
-  }
 
-  // Otherwise, return the last link of the first line before line no.
-  // `start.line` that has links
-  for (i = start.line - 1; i > 0; i--) {
-    if (lines[i].links_length > 0) {
-      res.ok = true;
-      res.line = i;
-      res.link = lines[i].links_length - 1;
-      return res;
-    }
-  }
+  // Return the link that comes right before `start` in document order, if any
+  get_links(&links, &offs, lines, lines_len);
+  const unsigned i =
+      offs[start.line] + MIN(start.link, lines[start.line].links_length);
+  if (i > 0)
+    res = links[i - 1];
+  put_links(links, offs, lines);
 
-  // Return not found if that fails
-  res.ok = false;
   return res;
 }
 
 link_loc_t next_link(const line_t *lines, unsigned lines_len,
                      link_loc_t start) {
-  unsigned i;
-  link_loc_t res;
-
-  // If start was not found, return not found
-  if (!start.ok) {
-    res.ok = false;
-    return res;
-  }
-
-  // If `start.line` is larger than `lines_len`, return not found
-  if (start.line >= lines_len) {
-    res.ok = false;
-    return res;
-  }
+  link_loc_t res = {false, 0, 0}; // return value
+  link_loc_t *links;              // all links in `lines`
+  unsigned *offs;                 // link offsets of all lines in `links`
 
-  // If line no. `start.line` has a link after `start.link`, return that link
-  if (lines[start.line].links_length > start.link + 1) {
-    res.ok = true;
-    res.line = start.line;
-    res.link = start.link + 1;
+  // If `start` was not found, or is out of range, return not found
+  if (!start.ok || start.line >= lines_len)
     return res;
-  }
 
-  // Otherwise, return the first link of the first line after line no.
-  // `start.line` that has links
-  for (i = start.line + 1; i < lines_len; i++) {
-    if (lines[i].links_length > 0) {
-      res.ok = true;
-      res.line = i;
-      res.link = 0;
-      return res;
-    }
-  }
+  // Return the link that comes right after `start` in document order, if any
+  // (`start` itself might not be an actual link, e.g. on startup)
+  get_links(&links, &offs, lines, lines_len);
+  const unsigned i = start.link + 1 < lines[start.line].links_length
+                         ? offs[start.line] + start.link + 1
+                         : offs[start.line + 1];
+  if (i < offs[lines_len])
+    res = links[i];
+  put_links(links, offs, lines);
 
-  // Return not found if that fails
-  res.ok = false;
   return res;
 }
 
 link_loc_t first_link(const line_t *lines, unsigned lines_len, unsigned start,
                       unsigned stop) {
-  unsigned i;
-  link_loc_t res;
+  link_loc_t res = {false, 0, 0}; // return value
+  link_loc_t *links;              // all links in `lines`
+  unsigned *offs;                 // link offsets of all lines in `links`
 
   // Sanitize arguments, and return not found if they don't make sense
-  if (stop > lines_len)
-    stop = lines_len;
-  if (start > lines_len || start > stop) {
-    res.ok = false;
+  if (stop >= lines_len)
+    stop = lines_len - 1;
+  if (start >= lines_len || start > stop)
     return res;
-  }
 
-  // Attempt to find and return the first link in the line range
-  for (i = start; i <= stop; i++) {
-    if (lines[i].links_length > 0) {
-      res.ok = true;
-      res.line = i;
-      res.link = 0;
-      return res;
-    }
-  }
+  // Return the first link in the line range, if any
+  get_links(&links, &offs, lines, lines_len);
+  if (offs[start] < offs[stop + 1])
+    res = links[offs[start]];
+  put_links(links, offs, lines);
 
-  // If that fails, return not found
-  res.ok = false;
   return res;
 }
 
 link_loc_t last_link(const line_t *lines, unsigned lines_len, unsigned start,
                      unsigned stop) {
-  unsigned i;
-  link_loc_t res;
+  link_loc_t res = {false, 0, 0}; // return value
+  link_loc_t *links;              // all links in `lines`
+  unsigned *offs;                 // link offsets of all lines in `links`
 
   // Sanitize arguments, and return not found if they don't make sense
-  if (stop > lines_len)
-    stop = lines_len;
-  if (start > lines_len || start > stop) {
-    res.ok = false;
+  if (stop >= lines_len)
+    stop = lines_len - 1;
+  if (start >= lines_len || start > stop)
     return res;
+
+  // Return the last link in the line range, if any
+  get_links(&links, &offs, lines, lines_len);
+  if (offs[start] < offs[stop + 1])
+    res = links[offs[stop + 1] - 1];
+  put_links(links, offs, lines);
+
+  return res;
+}
+
+int ls_discover(const wchar_t *trgt, unsigned sln) {
+  wchar_t trgt_clone[BS_LINE]; // copy of `trgt`, split into `trgt_words`
+  wchar_t **trgt_words = alloca(BS_SHORT * sizeof(wchar_t *)); // words in trgt
+  unsigned trgt_words_len; // no. of words in trgt
+  wchar_t **cand_words =
+      alloca(BS_SHORT * sizeof(wchar_t *)); // words in current candidate line
+  unsigned cand_words_len; // no. of words in current candidate line
+  unsigned cand_score;     // score of current candidate line
+  int max_no = 0;          // line number with maximum score
+  unsigned max_score = 0;  // maximum score
+  unsigned i, j;           // iterators
+
+  wcslcpy(trgt_clone, trgt, BS_LINE);
+  trgt_words_len = wsplit(&trgt_words, BS_SHORT, trgt_clone, NULL, false);
+  if (0 == trgt_words_len)
+    return -1;
+
+  if (sln >= page_len)
+    return -1;
+
+  // Section titles are the only local search targets of apropos, whatis, and
+  // index pages, and they can be found without filling the pages in
+  if (NULL != page && page == aw_lazy.lines)
+    return aprowhat_discover(trgt, sln);
+
+  // In order for a line to be a candidate, it must begin with the first word
+  // in `trgt`; since `page_starts` is sorted, all candidates are next to each
+  // other, starting at the first line that doesn't sort before said word
+  if (NULL == page_starts)
+    index_starts(&page_starts);
+  const unsigned w0_len = wcslen(trgt_words[0]); // length of first word
+  unsigned lo = 0, hi = page_len;                // binary search range
+  while (lo < hi) {
+    const unsigned mid = lo + (hi - lo) / 2;
+    if (wcsncmp(line_start(page_starts[mid]), trgt_words[0], w0_len) < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
   }
 
-  // Attempt to find and return the last link in the line range
-  for (i = stop; i >= start && i != (unsigned)-1; i--) {
-    if (lines[i].links_length > 0) {
-      res.ok = true;
-      res.line = i;
-      res.link = lines[i].links_length - 1;
-      return res;
+  // Score candidate lines, and keep the one with the highest score (or, among
+  // equals, the one that comes first)
+  for (j = lo; j < page_len && 0 == wcsncmp(line_start(page_starts[j]),
+                                            trgt_words[0], w0_len);
+       j++) {
+    const unsigned ln = page_starts[j]; // current line number
+    if (ln < sln)
+      continue;
+    wchar_t text[BS_LINE]; // current line text
+    wcslcpy(text, line_at(page, ln)->text, BS_LINE);
+    // Candidate line score is calculated as 2x the number of its words that
+    // exactly match the words in `trgt`. An extra point is added to said score
+    // if the last word in `trgt` matches just the beginning of its
+    // corresponding word in `cand`
+    cand_score = 0;
+    cand_words_len = wsplit(&cand_words, BS_SHORT, text, NULL, false);
+    for (i = 0; i < MIN(trgt_words_len, cand_words_len); i++)
+      if (0 == wcscmp(cand_words[i], trgt_words[i]))
+        cand_score += 2;
+      else if (trgt_words_len - 1 == i)
+        if (cand_words[i] == wcsstr(cand_words[i], trgt_words[i]))
+          cand_score++;
+    // Candidates that got full marks, and either (a) don't include any
+    // additional words or (b) are less indended than the following line, get
+    // an extra point
+    if (cand_score == trgt_words_len) {
+      if (cand_words_len == trgt_words_len)
+        cand_score++;
+      else if (ln < page_len - 1) {
+        if (wmargend(line_at(page, ln + 1)->text, NULL) >
+            wmargend(text, NULL))
+          cand_score++;
+      }
+    }
+    if (cand_score > max_score ||
+        (cand_score > 0 && cand_score == max_score && ln < (unsigned)max_no)) {
+      max_no = ln;
+      max_score = cand_score;
     }
   }
 
-  // If that fails, return not found
-  res.ok = false;
-  return res;
+  return max_no;
 }
 
 unsigned search(result_t **dst, const wchar_t *needle, const line_t *lines,
                 unsigned lines_len, bool cs) {
-  unsigned ln;                                // current line no.
-  unsigned i = 0;                             // current result no.
-  const unsigned needle_len = wcslen(needle); // length of `needle`
-  wchar_t *cur_hayst;         // current haystuck (i.e. text of current line)
-  wchar_t *hit = NULL;        // current return value of `wcscasestr()`
-  unsigned res_len = BS_LINE; // result buffer length
-  result_t *res = aalloc(res_len, result_t); // result buffer
+  result_t *occ = NULL;                // all occurrences of `needle`
+  unsigned occ_len = 0;                // number of occurrences
+  const unsigned len = wcslen(needle); // length of `needle`
 
-  // For each line...
-  for (ln = 0; ln < lines_len; ln++) {
-    // Start at the beginning of the line's text
-    cur_hayst = lines[ln].text;
-    // Search for `needle`
-    if (cs)
-      hit = wcscasestr(cur_hayst, needle);
+  if (len > 0)
+    occ_len = search_all(&occ, needle, lines, lines_len, 0, lines_len, cs);
+
+  const unsigned res_len = search_pick(dst, occ, occ_len, len);
+  if (occ_len > 0)
+    free(occ);
+
+  return res_len;
+}
+
+unsigned search_inc(result_t **dst, const wchar_t *needle, const line_t *lines,
+                    unsigned lines_len, bool cs, bool re, bool multi,
+                    unsigned top, unsigned slice) {
+  unsigned k;                          // iterator
+  const unsigned len = wcslen(needle); // length of `needle`
+  result_t *occ, *tmp;                 // current and temporary occurrences
+  unsigned occ_len;                    // length of `occ`
+
+  if (re)
+    multi = false;
+
+  // Keep only the levels of `isearch` that correspond to a common prefix of
+  // `needle` and the previous needle. (A regular expression or multi-term
+  // search has a single level, which is kept only if `needle` hasn't changed.)
+  unsigned keep = 0; // number of levels to keep
+  if (lines == isearch.lines && lines_len == isearch.lines_len &&
+      cs == isearch.cs && re == isearch.re && multi == isearch.multi) {
+    if (re || multi)
+      keep = isearch.len > 0 && 0 == wcscmp(needle, isearch.needle) ? 1 : 0;
     else
-      hit = wcsstr(cur_hayst, needle);
-    // While `needle` has been found...
-    while (NULL != hit) {
-      // Add the search result to `res[i]`
-      res[i].line = ln;
-      res[i].start = hit - lines[ln].text;
-      res[i].end = res[i].start + needle_len;
-      // Go to the part of the line's text that follows `needle`
-      cur_hayst = hit + needle_len;
-      // And search for `needle` again
-      if (cur_hayst - lines[ln].text < lines[ln].length)
-        if (cs)
-          hit = wcscasestr(cur_hayst, needle);
-        else
-          hit = wcsstr(cur_hayst, needle);
-      else
-        hit = NULL;
-      // Increment `i` (and reallocate memory if necessary)
-      inc_i;
+      while (keep < isearch.len && keep < len &&
+             needle[keep] == isearch.needle[keep])
+        keep++;
+  }
+  for (k = keep; k < isearch.len; k++)
+    if (NULL != isearch.occ[k]) {
+      free(isearch.occ[k]);
+      isearch.occ[k] = NULL;
     }
+  isearch.len = keep;
+
+  // If there's nothing to keep, start a new scan at line `top`
+  if (0 == keep) {
+    isearch_free_matchers();
+    isearch.lines = lines;
+    isearch.lines_len = lines_len;
+    isearch.cs = cs;
+    isearch.re = re;
+    isearch.multi = multi;
+    isearch.top = lines_len > 0 ? MIN(top, lines_len - 1) : 0;
+    isearch.scanned = 0;
   }
 
-  // If no results were found, free the result buffer
-  if (0 == i)
-    free(res);
+  if (re || multi)
+    return search_inc_one(dst, needle, lines, lines_len, cs, slice);
+
+  // Add a level for each additional character of `needle`, by narrowing down
+  // the level before it (i.e. by checking a single character at each
+  // occurrence)
+  isearch_grow(len);
+  for (k = keep; k < len; k++) {
+    isearch.needle[k] = needle[k];
+    isearch.occ_len[k] = 0;
+    isearch.occ_size[k] = 0;
+    if (k > 0) {
+      occ_len = search_narrow(&occ, isearch.occ[k - 1], isearch.occ_len[k - 1],
+                              lines, needle[k], k, cs);
+      isearch.occ[k] = occ;
+      isearch.occ_len[k] = isearch.occ_size[k] = occ_len;
+    }
+  }
+  isearch.len = len;
+  if (0 == len) {
+    *dst = NULL;
+    return 0;
+  }
 
-  *dst = res;
-  return i;
+  // Scan up to `slice` more lines (or all of them, if `slice` is 0) for the
+  // first character of `needle`, starting at line `isearch.top` and wrapping
+  // around at the end of `lines`. Whatever is found is narrowed down and
+  // appended to every level.
+  unsigned todo = lines_len - isearch.scanned; // lines left to scan
+  if (slice > 0)
+    todo = MIN(todo, slice);
+  while (todo > 0) {
+    const unsigned from = (isearch.top + isearch.scanned) % lines_len;
+    const unsigned to = MIN(lines_len, from + todo);
+    const wchar_t first[2] = {needle[0], L'\0'}; // first char. of `needle`
+    occ_len = search_all(&occ, first, lines, lines_len, from, to, cs);
+    for (k = 0; k < len && occ_len > 0; k++) {
+      if (k > 0) {
+        tmp = occ;
+        occ_len = search_narrow(&occ, tmp, occ_len, lines, needle[k], k, cs);
+        free(tmp);
+      }
+      isearch_append(k, occ, occ_len);
+    }
+    if (occ_len > 0)
+      free(occ);
+    isearch.scanned += to - from;
+    todo -= to - from;
+  }
+
+  // Occurrences are ordered by scan order, i.e. those before line
+  // `isearch.top` come last; place them first
+  occ = isearch.occ[len - 1];
+  occ_len = isearch.occ_len[len - 1];
+  unsigned split = 0; // number of occurrences at or after `isearch.top`
+  while (split < occ_len && occ[split].line >= isearch.top)
+    split++;
+  if (0 == split || occ_len == split)
+    return search_pick(dst, occ, occ_len, len);
+  tmp = aalloc(occ_len, result_t);
+  memcpy(tmp, &occ[split], (occ_len - split) * sizeof(result_t));
+  memcpy(&tmp[occ_len - split], occ, split * sizeof(result_t));
+  const unsigned res_len = search_pick(dst, tmp, occ_len, len);
+  free(tmp);
+  return res_len;
 }
 
-int search_next(result_t *res, unsigned res_len, unsigned from) {
-  unsigned i;
+bool isearch_pending() {
+  return isearch.len > 0 && isearch.scanned < isearch.lines_len;
+}
 
-  for (i = 0; i < res_len; i++)
-    if (res[i].line >= from)
-      return res[i].line;
+void isearch_reset() {
+  unsigned k; // iterator
 
-  return -1;
+  for (k = 0; k < isearch.len; k++)
+    if (NULL != isearch.occ[k]) {
+      free(isearch.occ[k]);
+      isearch.occ[k] = NULL;
+    }
+  isearch_free_matchers();
+  free(isearch.needle);
+  free(isearch.occ);
+  free(isearch.occ_len);
+  free(isearch.occ_size);
+  isearch.needle = NULL;
+  isearch.occ = NULL;
+  isearch.occ_len = NULL;
+  isearch.occ_size = NULL;
+  isearch.size = 0;
+  isearch.lines = NULL;
+  isearch.len = 0;
 }
 
-int search_prev(result_t *res, unsigned res_len, unsigned from) {
-  int i;
+unsigned search_index(const result_t *res, unsigned res_len, unsigned line) {
+  unsigned lo = 0, hi = res_len; // bounds of the range that's left to search
 
-  for (i = res_len - 1; i >= 0; i--)
-    if (res[i].line <= from)
-      return res[i].line;
+  while (lo < hi) {
+    const unsigned mid = lo + (hi - lo) / 2;
+    if (res[mid].line < line)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
 
-  return -1;
+  return lo;
+}
+
+int search_next(result_t *res, unsigned res_len, unsigned from) {
+  const unsigned i = search_index(res, res_len, from);
+
+  return i < res_len ? (int)res[i].line : -1;
+}
+
+int search_prev(result_t *res, unsigned res_len, unsigned from) {
+  const unsigned i = search_index(res, res_len, from + 1);
+
+  return i > 0 ? (int)res[i - 1].line : -1;
 }
 
 extern unsigned get_mark(wchar_t **dst, mark_t mark, const line_t *lines) {
@@ -2333,22 +3788,22 @@ extern unsigned get_mark(wchar_t **dst, mark_t mark, const line_t *lines) {
   // Generate return value
   if (mark.start_line == mark.end_line) {
     // Marked text is in a single line
-    wcsncpy(res, &lines[mark.start_line].text[mark.start_char],
+    wcsncpy(res, &line_at(lines, mark.start_line)->text[mark.start_char],
             1 + mark.end_char - mark.start_char);
   } else {
     // Marked text is in multiple lines
     for (ln = mark.start_line; ln <= mark.end_line; ln++) {
       if (ln == mark.start_line) {
         // First line; append text from `start_char` to end of line
-        wcslcat(res, &lines[ln].text[mark.start_char], res_len);
+        wcslcat(res, &line_at(lines, ln)->text[mark.start_char], res_len);
       } else if (ln == mark.end_line) {
         // Last line; append text from beginning of line to `end_char`
-        wcsncpy(tmp, lines[ln].text, 1 + mark.end_char);
+        wcsncpy(tmp, line_at(lines, ln)->text, 1 + mark.end_char);
         tmp[1 + mark.end_char] = L'\0';
         wcslcat(res, tmp, res_len);
       } else {
         // Intermediary lines; append entire line text
-        wcslcat(res, lines[ln].text, res_len);
+        wcslcat(res, line_at(lines, ln)->text, res_len);
       }
     }
   }
@@ -2404,6 +3859,13 @@ void populate_page() {
     page_len = aprowhat(&page, AW_WHATIS, history[history_cur].args, L"WHATIS",
                         page_title);
     break;
+  case RT_FULLTEXT:
+    swprintf(page_title, BS_SHORT, L"Full-text search for: %ls",
+             history[history_cur].args);
+    entitle(page_title);
+    page_len = fulltext(&page, history[history_cur].args, L"FULLTEXT",
+                        page_title);
+    break;
   default:
     winddown(ES_OPER_ERROR, L"Unexpected program request");
   }
@@ -2413,6 +3875,38 @@ void populate_page() {
     free(results);
   results = NULL;
   results_len = 0;
+
+  // Reset `page_fold` and `page_fold_offs`
+  if (NULL != page_fold) {
+    free(page_fold);
+    free(page_fold_offs);
+  }
+  page_fold = NULL;
+  page_fold_offs = NULL;
+
+  // Reset `page_links` and `page_links_offs`
+  if (NULL != page_links) {
+    free(page_links);
+    free(page_links_offs);
+  }
+  page_links = NULL;
+  page_links_offs = NULL;
+
+  // Reset `page_starts`
+  if (NULL != page_starts)
+    free(page_starts);
+  page_starts = NULL;
+
+  // Reset `page_mb` and `page_mb_offs`
+  if (NULL != page_mb) {
+    free(page_mb);
+    free(page_mb_offs);
+  }
+  page_mb = NULL;
+  page_mb_offs = NULL;
+
+  // Reset `isearch`
+  isearch_reset();
 }
 
 void populate_toc() {
@@ -2437,29 +3931,31 @@ void populate_toc() {
     case RT_MAN_LOCAL:
       toc_len = man_toc(&toc, args, true);
       break;
-    case RT_APROPOS:
-      aw_len = aprowhat_exec(&aw, AW_APROPOS, args);
-      if (err)
-        winddown(ES_OPER_ERROR, err_msg);
-      sc_len = aprowhat_sections(&sc, aw, aw_len);
-      toc_len = sc_toc(&toc, (const wchar_t *const *)sc, sc_len);
-      if (NULL != aw && aw_len > 0)
-        aprowhat_free(aw, aw_len);
-      if (NULL != sc && sc_len > 0)
-        wafree(sc, sc_len);
-      break;
     default:
-      aw_len = aprowhat_exec(&aw, AW_WHATIS, args);
-      if (err)
-        winddown(ES_OPER_ERROR, err_msg);
-      sc_len = aprowhat_sections(&sc, aw, aw_len);
-      toc_len = sc_toc(&toc, (const wchar_t *const *)sc, sc_len);
-      if (NULL != aw && aw_len > 0)
-        aprowhat_free(aw, aw_len);
-      if (NULL != sc && sc_len > 0)
-        wafree(sc, sc_len);
+      // Apropos, whatis, and full-text search pages; the sections were most
+      // likely kept by `populate_page()`, otherwise (e.g. if the page was
+      // fetched from a server) search again
+      if (rt != aw_last.request_type || NULL == aw_last.args ||
+          0 != wcscmp(args, aw_last.args)) {
+        if (RT_FULLTEXT == rt)
+          aw_len = ft_query(&aw, args);
+        else
+          aw_len = aprowhat_exec(&aw, RT_APROPOS == rt ? AW_APROPOS : AW_WHATIS,
+                                 args);
+        if (err)
+          winddown(ES_OPER_ERROR, err_msg);
+        sc_len = aprowhat_sections(&sc, aw, aw_len);
+        if (NULL != aw && aw_len > 0)
+          aprowhat_free(aw, aw_len);
+        aw_last_keep(rt, args, sc, sc_len);
+      }
+      toc_len = sc_toc(&toc, (const wchar_t *const *)aw_last.sc,
+                       aw_last.sc_len);
       break;
     }
+
+    // Find the line every entry points to, so that jumping to it is immediate
+    toc_lines(toc, toc_len);
   }
 
   // If the TOC still doesn't exist, something must have gone wrong
@@ -2467,6 +3963,19 @@ void populate_toc() {
     winddown(ES_OPER_ERROR, L"Unable to generate table of contents");
 }
 
+void aw_last_keep(request_type_t rt, const wchar_t *args, wchar_t **sc,
+                  unsigned sc_len) {
+  if (NULL != aw_last.args)
+    free(aw_last.args);
+  if (NULL != aw_last.sc)
+    wafree(aw_last.sc, aw_last.sc_len);
+
+  aw_last.request_type = rt;
+  aw_last.args = NULL == args ? NULL : xwcsdup(args);
+  aw_last.sc = sc;
+  aw_last.sc_len = sc_len;
+}
+
 void requests_free(request_t *reqs, unsigned reqs_len) {
   unsigned i;
 
@@ -2493,6 +4002,9 @@ void aprowhat_free(aprowhat_t *aw, unsigned aw_len) {
 void lines_free(line_t *lines, unsigned lines_len) {
   unsigned i;
 
+  if (NULL != lines && lines == aw_lazy.lines)
+    aprowhat_release();
+
   for (i = 0; i < lines_len; i++) {
     line_free(lines[i]);
   }
@@ -2572,13 +4084,31 @@ void winddown(int ec, const wchar_t *em) {
   if (NULL != config.misc.viewer_path)
     free(config.misc.viewer_path);
 
-  // Deallocate memory used by `history` global
-  requests_free(history, config.misc.history_size);
+  // Deallocate memory used by batch mode globals
+  if (NULL != batch_path)
+    free(batch_path);
+  if (NULL != batch_dir)
+    free(batch_dir);
+
+  // Deallocate memory used by `history` global (entries before `history` in
+  // `history_buf` have been evicted already, and their `args` freed)
+  if (NULL != history_buf) {
+    for (unsigned i = 0; i <= history_top; i++)
+      if (NULL != history[i].args)
+        free(history[i].args);
+    free(history_buf);
+  }
+
+  // Unmap the full-text index
+  ft_close();
 
   // Deallocate memory used by `aw_all` global
   if (NULL != aw_all && aw_all_len > 0)
     aprowhat_free(aw_all, aw_all_len);
 
+  // Deallocate memory used by `aw_last` global
+  aw_last_keep(RT_NONE, NULL, NULL, 0);
+
   // Deallocate memory used by `sc_all` global
   if (NULL != sc_all && sc_all_len > 0)
     wafree(sc_all, sc_all_len);
@@ -2595,6 +4125,31 @@ void winddown(int ec, const wchar_t *em) {
   if (NULL != results && results_len > 0)
     free(results);
 
+  // Deallocate memory used by `page_fold` and `page_fold_offs` globals
+  if (NULL != page_fold) {
+    free(page_fold);
+    free(page_fold_offs);
+  }
+
+  // Deallocate memory used by `page_links` and `page_links_offs` globals
+  if (NULL != page_links) {
+    free(page_links);
+    free(page_links_offs);
+  }
+
+  // Deallocate memory used by `page_starts` global
+  if (NULL != page_starts)
+    free(page_starts);
+
+  // Deallocate memory used by `page_mb` and `page_mb_offs` globals
+  if (NULL != page_mb) {
+    free(page_mb);
+    free(page_mb_offs);
+  }
+
+  // Deallocate memory used by `isearch` global
+  isearch_reset();
+
   // Deallocate memory used by `re_...` regular expression globals
   regfree(&re_man.re);
   regfree(&re_http.re);
@@ -42,7 +42,8 @@ typedef enum {
   RT_MAN,       // show a manual page
   RT_MAN_LOCAL, // show a manual page stored in a local file
   RT_APROPOS,   // search for manual pages and their descriptions
-  RT_WHATIS     // show all available manual pages that match a name
+  RT_WHATIS,    // show all available manual pages that match a name
+  RT_FULLTEXT   // search the full-text index for manual pages' text
 } request_type_t;
 
 // A page request
@@ -68,6 +69,15 @@ typedef struct {
   wchar_t *descr;   // Description
 } aprowhat_t;
 
+// The manual sections of the most recent apropos, whatis, or full-text search
+// result, together with the request that produced it
+typedef struct {
+  request_type_t request_type; // request type
+  wchar_t *args;               // request arguments
+  wchar_t **sc;                // manual sections
+  unsigned sc_len;             // number of entries in `sc`
+} aw_last_t;
+
 // Link type
 typedef enum {
   LT_MAN,   // manual page
@@ -103,6 +113,32 @@ typedef struct {
   bitarr_t uline;  // underlined
 } line_t;
 
+// Layout of the apropos, whatis, or index page most recently rendered by
+// `aprowhat_render()`. The page is split into blocks (its header, the list of
+// sections, each section title, each manual page, and its footer); the lines
+// of a block only get their text, text attributes, and links once `line_at()`
+// is asked for any of them.
+typedef struct {
+  line_t *lines;           // the page, or NULL if there's no such page
+  unsigned lines_len;      // number of lines in `lines`
+  aprowhat_t *aw;          // manual pages listed in the page
+  unsigned aw_len;         // number of entries in `aw`
+  bool aw_own;             // whether `aw` is to be freed along with the page
+  wchar_t **sc;            // manual sections listed in the page
+  unsigned sc_len;         // number of entries in `sc`
+  wchar_t key[BS_SHORT];   // `key` of the header and footer
+  wchar_t title[BS_SHORT]; // `title` of the header
+  wchar_t ver[BS_SHORT];   // `ver` of the footer
+  wchar_t date[BS_SHORT];  // `date` of the footer
+  unsigned width;          // `config.layout.main_width` for the page
+  unsigned lmargin;        // `config.layout.lmargin` for the page
+  unsigned rmargin;        // `config.layout.rmargin` for the page
+  unsigned blocks_len;     // number of blocks
+  unsigned *block_ln;      // first line of each block
+  int *block_item;         // contents of each block (an index in `aw`, or
+                           // one of the `AB_...` constants)
+} aw_lazy_t;
+
 // A table of contents entry type
 typedef enum {
   TT_HEAD = 0,    // section heading
@@ -114,6 +150,7 @@ typedef enum {
 typedef struct toc_entry_t {
   toc_type_t type; // type
   wchar_t *text;   // text
+  int line;        // number of the line in `page` the entry points to, or -1
 } toc_entry_t;
 
 // A search result
@@ -121,8 +158,35 @@ typedef struct {
   unsigned line;  // line number
   unsigned start; // character no. where the result starts
   unsigned end;   // character no. where the result ends
+  unsigned term;  // no. of the search term matched (in multi-term searches)
 } result_t;
 
+// State of an incremental search (see `search_inc()`). Level `k` holds all
+// occurrences (including overlapping ones) of the first `k + 1` characters of
+// `needle`, in the lines scanned so far. Lines are scanned starting at `top`,
+// and wrapping around at the end of `lines`. A regular expression search or a
+// multi-term search has a single level, which holds all matches of `rex` or
+// `ac` respectively. `needle` and the per-level arrays grow with the needle.
+typedef struct {
+  const line_t *lines;         // lines being searched
+  unsigned lines_len;          // length of `lines`
+  bool cs;                     // search is case-insensitive
+  bool re;                     // `needle` is a regular expression
+  bool multi;                  // `needle` is a list of terms
+  wchar_t *needle;             // needle
+  result_t **occ;              // occurrences, per level
+  unsigned *occ_len;           // number of occurrences, per level
+  unsigned *occ_size;          // allocated length of `occ`, per level
+  unsigned size;               // allocated length of `needle` (minus 1), and
+                               // of `occ`, `occ_len`, and `occ_size`
+  unsigned len;                // number of levels
+  unsigned top;                // line the scan started at
+  unsigned scanned;            // number of lines scanned so far
+  regex_t rex;                 // `needle`, compiled (if `re` is true)
+  bool re_ok;                  // `rex` holds a compiled regular expression
+  ac_t ac;                     // the terms of `needle` (if `multi` is true)
+} isearch_t;
+
 // Marked text
 typedef struct {
   bool enabled;        // whether we are marking text
@@ -144,6 +208,17 @@ typedef struct {
 #define ES_CONFIG_ERROR 4 // configuration file parse error
 #define ES_NOT_FOUND 16   // manual page(s) not found
 
+// Contents of the blocks of a page laid out in `aw_lazy` (other than manual
+// pages), as found in its `block_item`
+#define AB_HEAD -1     // header
+#define AB_SECTIONS -2 // list of sections
+#define AB_FOOT -3     // footer
+#define AB_SECTION -4  // title of first section (`AB_SECTION - i` is the
+                       // title of section `i`)
+
+// Maximum number of batch mode worker processes (`-j`)
+#define BATCH_JOBS_MAX 1024
+
 //
 // Global variables
 //
@@ -154,9 +229,39 @@ extern option_t options[];
 // Program action to perform upon program startup
 extern action_t first_action;
 
-// History of page requests
+// Batch mode input file path (`-B`), or NULL if not running in batch mode
+extern char *batch_path;
+
+// Number of batch mode worker processes (`-j`), or 0 for one per CPU
+extern unsigned batch_jobs;
+
+// Batch mode output directory (`-o`), or NULL to write to standard output
+extern char *batch_dir;
+
+// True if running as a resident server (`-S`)
+extern bool server_mode;
+
+// True if building the full-text index (`-U`)
+extern bool index_mode;
+
+// True if the TUI is to restore the last saved session (`-R`)
+extern bool resume_mode;
+
+// True if `man()` is to print each line of its output to standard output as
+// soon as it becomes available, instead of returning the whole page
+extern bool page_stream;
+
+// History of page requests, oldest first (a window into `history_buf`)
 extern request_t *history;
 
+// Memory allocated for `history`. It grows as needed, and, once
+// `config.misc.history_size` entries are in use, old entries are evicted by
+// sliding `history` forward, one entry at a time (see `history_push()`).
+extern request_t *history_buf;
+
+// Length of `history_buf` (in entries)
+extern unsigned history_buf_len;
+
 // Location of current request in `history`
 extern unsigned history_cur;
 
@@ -169,12 +274,23 @@ extern aprowhat_t *aw_all;
 // Number of entries in `aw_all`
 extern unsigned aw_all_len;
 
+// Number of times `aw_all` has been (re)built; data derived from `aw_all` is
+// stale once this changes
+extern unsigned aw_all_gen;
+
 // All manual sections on this system
 extern wchar_t **sc_all;
 
 // Number of entries in `sc_all`
 extern unsigned sc_all_len;
 
+// Sections of the last apropos, whatis, or full-text search result, kept so
+// that `populate_toc()` doesn't have to repeat the search
+extern aw_last_t aw_last;
+
+// Layout of the most recently rendered apropos, whatis, or index page
+extern aw_lazy_t aw_lazy;
+
 // The page currently being displayed
 extern line_t *page;
 
@@ -211,6 +327,38 @@ extern result_t *results;
 // Total number of search results in current page
 extern unsigned results_len;
 
+// Lower-case copy of the text of all lines in `page`, each one terminated by
+// L'\0', or NULL if it hasn't been needed yet (see `search()`)
+extern wchar_t *page_fold;
+
+// Offsets of the lines of `page` in `page_fold` (plus the offset of the end of
+// `page_fold`), or NULL
+extern unsigned *page_fold_offs;
+
+// Locations of all links in `page`, in document order, or NULL if they haven't
+// been needed yet (see `next_link()`)
+extern link_loc_t *page_links;
+
+// Number of links in all lines of `page` before each line, i.e. the position
+// in `page_links` of each line's first link (plus the total number of links),
+// or NULL
+extern unsigned *page_links_offs;
+
+// Numbers of all lines in `page`, sorted by the text that follows each line's
+// left margin, or NULL if they haven't been needed yet (see `ls_discover()`)
+extern unsigned *page_starts;
+
+// Multibyte copy of the text of all lines in `page`, each one terminated by
+// '\0', or NULL if it hasn't been needed yet (see `search_inc()`)
+extern char *page_mb;
+
+// Offsets of the lines of `page` in `page_mb` (plus the offset of the end of
+// `page_mb`), or NULL
+extern unsigned *page_mb_offs;
+
+// State of the current incremental search
+extern isearch_t isearch;
+
 // Marked text
 extern mark_t mark;
 
@@ -266,18 +414,22 @@ extern full_regex_t re_man, // a manual page
 
 // Free memory for all members of `links` (of type `link_t`)
 #define links_free(links, links_len)                                           \
-  for (unsigned link_free_i = 0; link_free_i < links_len; link_free_i++)       \
-    free(links[link_free_i].trgt);                                             \
+  if (NULL != links)                                                           \
+    for (unsigned link_free_i = 0; link_free_i < links_len; link_free_i++)     \
+      free(links[link_free_i].trgt);                                           \
   free(links);
 
 // Return the string representation of `type` (of type `request_type_t`)
 #define request_type_str(t)                                                    \
   RT_INDEX == t                                                                \
       ? L"INDEX"                                                               \
-      : (RT_MAN == t ? L"MAN"                                                  \
-                     : (RT_MAN_LOCAL == t                                      \
-                            ? L"LOCAL"                                         \
-                            : (RT_APROPOS == t ? L"APROPOS" : L"WHATIS")))
+      : (RT_MAN == t                                                           \
+             ? L"MAN"                                                          \
+             : (RT_MAN_LOCAL == t                                              \
+                    ? L"LOCAL"                                                 \
+                    : (RT_APROPOS == t                                         \
+                           ? L"APROPOS"                                        \
+                           : (RT_WHATIS == t ? L"WHATIS" : L"FULLTEXT"))))
 
 // If `n` is smaller than or equal to `history_cur`, go back `n` steps in
 // `history` and return true. Otherwise, return false.
@@ -299,6 +451,16 @@ extern void init();
 // performed
 extern void late_init();
 
+// Place a description of the values of all configuration options that
+// `late_init()` depends on (i.e. the system type and the paths of the commands
+// that list manual pages) into `dst` (of length `dst_len`)
+extern void conf_index_desc(char *dst, unsigned dst_len);
+
+// Place a description of the values of all configuration options that
+// `populate_page()` depends on (other than the ones described by
+// `conf_index_desc()` and the terminal size) into `dst` (of length `dst_len`)
+extern void conf_page_desc(char *dst, unsigned dst_len);
+
 // Retrieve `argc` and `argv` from `main()` and parse the command line options.
 // Modify `config` and `history` appropriately, and return `optind`. Exit in
 // case of usage error.
@@ -325,7 +487,8 @@ extern void history_replace(request_type_t rt, const wchar_t *args);
 // Push a new entry into `history`, as follows:
 // Add a new history entry after `history_cur`, and populate it with `rt` and
 // `args` using `history_replace()`. Increase `history_cur`, and adjust
-// `history_top` so that it remains equal to or greater than it.
+// `history_top` so that it remains equal to or greater than it. If `history`
+// already holds `config.misc.history_size` entries, drop the oldest one.
 extern void history_push(request_type_t rt, const wchar_t *args);
 
 // If `pos` is larger or equal to 0 and smaller or equal to `history_top`, jump
@@ -356,12 +519,31 @@ extern unsigned aprowhat_sections(wchar_t ***dst, const aprowhat_t *aw,
 // `aw` (of length `aw_len`), and a result of `aprowhat_sections()` `sc` (of
 // length `sc_len`) into into a manual page like index document, and place it
 // into `dst`. Return the number of lines. `key`, `title`, `ver`, and `date`
-// are used for generating the header and footer.
-extern unsigned aprowhat_render(line_t **dst, const aprowhat_t *aw,
+// are used for generating the header and footer. Only the layout of the
+// document is computed, and kept in `aw_lazy`; its lines are left empty (with
+// just their `length` and `links_length` set) until `line_at()` fills them
+// in. If `aw_own`, `aw` belongs to the document from then on, and is
+// freed along with it (by `lines_free()`).
+extern unsigned aprowhat_render(line_t **dst, aprowhat_t *aw,
                                 const unsigned aw_len, const wchar_t *const *sc,
                                 const unsigned sc_len, const wchar_t *key,
                                 const wchar_t *title, const wchar_t *ver,
-                                const wchar_t *date);
+                                const wchar_t *date, bool aw_own);
+
+// Return line `ln` of `lines`. If `lines` is the document laid out in
+// `aw_lazy`, and the line hasn't been filled in yet, fill it in (along with
+// the rest of its block) first. The text, text attributes, and links of the
+// lines of any document that might have been rendered by `aprowhat_render()`
+// must only be accessed through this. (Filling a line in doesn't change the
+// document, but merely computes part of it, hence `lines` is `const`; the
+// lines are written to through `aw_lazy.lines`, which owns them.)
+extern const line_t *line_at(const line_t *lines, unsigned ln);
+
+// If `page` is the document laid out in `aw_lazy`, return the number of the
+// first line at or after `sln` that holds a section title (or the title of the
+// list of sections) equal to `trgt`, without filling in any lines. Otherwise,
+// or if there is no such line, return -1.
+extern int aprowhat_discover(const wchar_t *trgt, unsigned sln);
 
 // Search for elements of `hayst` (of length `hayst_len`), whose `ident`
 // contains `needle` (if `fullsub`) or starts with `needle` (if not `fullsub`).
@@ -381,6 +563,10 @@ extern bool aprowhat_has(const wchar_t *needle, const aprowhat_t *hayst,
 extern unsigned man_sections(wchar_t ***dst, const wchar_t *args,
                              bool local_file);
 
+// Same as `man_sections()`, but for the manual page whose source is at `gpath`
+// (e.g. as located by `man_loc()`).
+extern unsigned man_sections_at(wchar_t ***dst, const char *gpath);
+
 // Render an index of all of the system's manual pages, placing it into `dst`.
 // Return the number of lines rendered.
 extern unsigned index_page(line_t **dst);
@@ -392,10 +578,20 @@ extern unsigned index_page(line_t **dst);
 extern unsigned aprowhat(line_t **dst, aprowhat_cmd_t cmd, const wchar_t *args,
                          const wchar_t *key, const wchar_t *title);
 
+// Place the location of the manual page source that corresponds to `args` into
+// `dst` (of length `dst_len`). If no such location exists, return false,
+// otherwise return true. `local_file` signifies whether `args` contains a local
+// file path, rather than a manual page name and section.
+extern bool man_loc(char *dst, unsigned dst_len, const wchar_t *args,
+                    bool local_file);
+
 // Execute `man`, and place its final rendeered output in `dst`. Return the
 // number of lines in said output. `args` specifies the arguments for the `man`
 // command. `local_file` signifies whether to pass the --local-file option to
-// `man`.
+// `man`. If `page_stream` is true, lines that come from `man` are printed
+// (using `print_line()`) and discarded as they are read, rather than placed in
+// `dst`; only lines produced by the built-in formatter are returned in that
+// case.
 extern unsigned man(line_t **dst, const wchar_t *args, bool local_file);
 
 // Use `man` and `groff` to extract the table of contents of a manual page.
@@ -410,7 +606,9 @@ extern unsigned sc_toc(toc_entry_t **dst, const wchar_t *const *sc,
                        const unsigned sc_len);
 
 // Find the previous link in `lines` (of legth `lines_len`), starting at
-// location `start`. Return said link's location.
+// location `start`. Return said link's location. This, `next_link()`,
+// `first_link()`, and `last_link()` take constant time for `page` (using, and,
+// the first time, building `page_links` and `page_links_offs`).
 extern link_loc_t prev_link(const line_t *lines, unsigned lines_len,
                             link_loc_t start);
 
@@ -429,12 +627,51 @@ extern link_loc_t first_link(const line_t *lines, unsigned lines_len,
 extern link_loc_t last_link(const line_t *lines, unsigned lines_len,
                             unsigned start, unsigned stop);
 
+// Return the number of the line in `page` that best matches local search link
+// target `trgt`, starting the search at line number `sln`. Only lines that
+// begin with the first word in `trgt` are considered; these are looked up in
+// (and, the first time, build) `page_starts`. Return 0 if no line matches, or
+// -1 if `trgt` is empty or `sln` is out of range.
+extern int ls_discover(const wchar_t *trgt, unsigned sln);
+
 // Search for `needle` in `lines` (of length `lines_len`). Place all results
 // into `dst` and return the total number of results. `cs` siginifies whether
-// search will be case-insensitive.
+// search will be case-insensitive. Case-insensitive searches of `page` use
+// (and, the first time, build) `page_fold` and `page_fold_offs`.
 extern unsigned search(result_t **dst, const wchar_t *needle,
                        const line_t *lines, unsigned lines_len, bool cs);
 
+// Same as `search()`, but reuse the work done by the previous call, as recorded
+// in `isearch`. If `needle` extends the previous needle, only the occurrences
+// of the latter are checked again; if it's a prefix of it (e.g. after a
+// backspace), the occurrences found for it back then are reused. A new scan
+// starts at line `top` (so that results near it are found first), and each
+// call scans at most `slice` more lines (or all remaining lines, if `slice` is
+// 0); results are limited to the lines scanned so far. Use `isearch_pending()`
+// to tell whether more calls are needed to scan all of `lines`. If `re` is
+// true, `needle` is treated as an extended regular expression; it's compiled
+// only once, and searches of `page` use (and, the first time, build) `page_mb`
+// and `page_mb_offs`. An invalid regular expression has no results. Otherwise,
+// if `multi` is true, `needle` is split into several terms at each '|', which
+// are all searched for at once; each result's `term` is the no. of the term it
+// matches. If neither is true, `needle` is searched for literally.
+extern unsigned search_inc(result_t **dst, const wchar_t *needle,
+                           const line_t *lines, unsigned lines_len, bool cs,
+                           bool re, bool multi, unsigned top, unsigned slice);
+
+// Return true if the current incremental search hasn't scanned all lines yet
+extern bool isearch_pending();
+
+// Discard the state of the current incremental search
+extern void isearch_reset();
+
+// Return the index of the first member of `res` (of length `res_len`) whose
+// line number is at least `line`, or `res_len` if no such member exists.
+// Members of `res` must be sorted by line number (as all search results are); a
+// binary search is used.
+extern unsigned search_index(const result_t *res, unsigned res_len,
+                             unsigned line);
+
 // Return the line number of the member of `res` that immediately follows line
 // number `from`. If no such line exists, return -1. `res_len` is the length of
 // `res`.
@@ -454,10 +691,13 @@ extern unsigned get_mark(wchar_t **dst, mark_t mark, const line_t *lines);
 // requests a table of contents for the first time
 
 // Populate `page`, `page_title`, and `page_len`, based on the contents of
-// `history[history_cur]`. Reset `results`, `results_len`, `toc` and `toc_len`.
+// `history[history_cur]`. Reset `results`, `results_len`, `toc`, `toc_len`,
+// `page_fold`, `page_fold_offs`, `page_links`, `page_links_offs`,
+// `page_starts`, `page_mb`, `page_mb_offs`, and `isearch`.
 extern void populate_page();
 
-// Populate `toc` and `toc_len`
+// Populate `toc` and `toc_len`, and resolve the `line` of every entry in `toc`
+// using `ls_discover()`
 extern void populate_toc();
 
 // Free the memory occupied by `reqs` (of length `reqs_len`)
@@ -466,7 +706,14 @@ extern void requests_free(request_t *reqs, unsigned reqs_len);
 // Free the memory occupied by `aw` (of length `aw_len`)
 extern void aprowhat_free(aprowhat_t *aw, unsigned aw_len);
 
-// Free the memory occupied by `lines` (of length `lines_len`)
+// Replace the contents of `aw_last` with sections `sc` (of length `sc_len`),
+// which were produced by a request of type `rt` with arguments `args`. `sc` is
+// owned by `aw_last` from then on.
+extern void aw_last_keep(request_type_t rt, const wchar_t *args, wchar_t **sc,
+                         unsigned sc_len);
+
+// Free the memory occupied by `lines` (of length `lines_len`), as well as its
+// layout in `aw_lazy`, if any
 extern void lines_free(line_t *lines, unsigned lines_len);
 
 // Free the memory occupied by `toc` (of length `toc_len`)
@@ -13,7 +13,11 @@ int main(int argc, char **argv) {
   parse_args(clean_argc, clean_argv);
 
   // Run the main handler
-  if (config.layout.tui)
+  if (server_mode)
+    server();
+  else if (index_mode)
+    ft_update();
+  else if (config.layout.tui)
     tui();
   else
     cli();
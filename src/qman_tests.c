@@ -65,6 +65,70 @@
     winddown(0, NULL);                                                         \
   }
 
+//
+// Helper functions
+//
+
+// Write `src` to a new temporary file, and place its path into `dst` (of
+// length `dst_len`)
+void tmp_write(char *dst, unsigned dst_len, const char *src) {
+  snprintf(dst, dst_len, "/tmp/qman_tests.XXXXXX");
+  int fd = mkstemp(dst);
+  CU_ASSERT_FATAL(-1 != fd);
+  FILE *fp = fdopen(fd, "w");
+  CU_ASSERT_FATAL(NULL != fp);
+  fputs(src, fp);
+  fclose(fp);
+}
+
+// Feed `text` to `ac`, and place the position of the last character and the
+// number of the term of each match into `ends` and `terms` respectively (of
+// length `BS_SHORT`). Return the number of matches.
+unsigned ac_run(unsigned *ends, int *terms, const ac_t *ac,
+                const wchar_t *text) {
+  unsigned state = 0; // current state of `ac`
+  unsigned res = 0;   // number of matches
+  unsigned i, n;      // iterators
+
+  for (i = 0; L'\0' != text[i]; i++) {
+    state = ac_next(ac, state, text[i]);
+    for (n = -1 == ac->nodes[state].term ? ac->nodes[state].out : state;
+         0 != n && res < BS_SHORT; n = ac->nodes[n].out) {
+      ends[res] = i;
+      terms[res++] = ac->nodes[n].term;
+    }
+  }
+
+  return res;
+}
+
+// Place a page made of the lines of text in `src` (of length `src_len`) into
+// `dst`, as `man()` would (but without any formatting or links)
+void page_make(line_t *dst, const wchar_t *const *src, unsigned src_len) {
+  unsigned ln; // iterator
+
+  for (ln = 0; ln < src_len; ln++) {
+    line_alloc(dst[ln], wcslen(src[ln]) + 1);
+    wcscpy(dst[ln].text, src[ln]);
+  }
+}
+
+// Return true if `a` and `b` (of lengths `a_len` and `b_len`) hold the same
+// search results
+bool results_eq(const result_t *a, unsigned a_len, const result_t *b,
+                unsigned b_len) {
+  unsigned i; // iterator
+
+  if (a_len != b_len)
+    return false;
+  for (i = 0; i < a_len; i++)
+    if (a[i].line != b[i].line || a[i].start != b[i].start ||
+        a[i].end != b[i].end)
+      return false;
+
+  return true;
+}
+
 //
 // Test functions
 //
@@ -234,6 +298,807 @@ void test_eini_parse() {
   eini_winddown();
 }
 
+void test_roff() {
+  char path[BS_LINE]; // temporary page source
+  line_t *lines;      // formatted page
+  unsigned len;       // length of `lines`
+
+  tmp_write(path, BS_LINE,
+            ".TH FOO 1 \"2024-01-01\" \"foo 1.0\" \"User Commands\"\n"
+            ".SH NAME\n"
+            "foo \\- frobnicate the bar\n"
+            ".SH SYNOPSIS\n"
+            ".B foo\n"
+            "[\\fB\\-v\\fR] \\fIfile\\fR...\n"
+            ".SH DESCRIPTION\n"
+            ".de XX\n"
+            "Macro says \\\\$1.\n"
+            "..\n"
+            ".ds Qq quoted\n"
+            "Text with \\(em dash, \\*(lqsmart\\*(rq quotes\n"
+            "and \\*(Qq string.\n"
+            ".XX hello\n"
+            ".TP\n"
+            ".B \\-v\n"
+            "Be verbose.\n"
+            ".SH SEE ALSO\n"
+            ".BR bar (1)\n");
+  len = roff(&lines, path, 60, 2);
+  unlink(path);
+
+  CU_ASSERT_EQUAL(len, 18);
+  if (18 != len)
+    return;
+
+  // Header and footer
+  CU_ASSERT(0 == wcsncmp(lines[0].text, L"  FOO(1)", 8));
+  CU_ASSERT(NULL != wcsstr(lines[0].text, L"User Commands"));
+  CU_ASSERT(0 == wcsncmp(lines[17].text, L"  foo 1.0", 9));
+  CU_ASSERT(NULL != wcsstr(lines[17].text, L"2024-01-01"));
+
+  // Section headings are bold
+  CU_ASSERT(0 == wcscmp(lines[2].text, L"  NAME"));
+  CU_ASSERT(bget(lines[2].bold, 2));
+  CU_ASSERT(0 == wcscmp(lines[14].text, L"  SEE ALSO"));
+
+  // `\-` is a hyphen
+  CU_ASSERT(0 == wcscmp(lines[3].text, L"         foo - frobnicate the bar"));
+
+  // `.B` and font escapes (italic is rendered as underlined)
+  CU_ASSERT(0 == wcscmp(lines[6].text, L"         foo [-v] file..."));
+  CU_ASSERT(bget(lines[6].bold, 9));
+  CU_ASSERT(bget(lines[6].reg, 12));
+  CU_ASSERT(bget(lines[6].bold, 14));
+  CU_ASSERT(bget(lines[6].reg, 16));
+  CU_ASSERT(bget(lines[6].uline, 18));
+  CU_ASSERT(bget(lines[6].reg, 22));
+
+  // Special characters, predefined and user-defined strings, and macros
+  CU_ASSERT(NULL != wcsstr(lines[9].text, L"\u2014 dash"));
+  CU_ASSERT(NULL != wcsstr(lines[9].text, L"\u201csmart\u201d"));
+  CU_ASSERT(NULL != wcsstr(lines[9].text, L"quoted string."));
+  CU_ASSERT(0 == wcscmp(lines[10].text, L"         Macro says hello."));
+
+  // Tagged paragraphs
+  CU_ASSERT(0 == wcscmp(lines[12].text, L"         -v     Be verbose."));
+  CU_ASSERT(0 == wcscmp(lines[15].text, L"         bar(1)"));
+
+  lines_free(lines, len);
+
+  // Unsupported constructs make the formatter give up
+  tmp_write(path, BS_LINE,
+            ".TH X 1\n"
+            ".SH NAME\n"
+            "x \\- y\n"
+            ".TS\n"
+            "l.\n"
+            "a\n"
+            ".TE\n");
+  len = roff(&lines, path, 60, 2);
+  unlink(path);
+  CU_ASSERT_EQUAL(len, 0);
+}
+
+void test_ac() {
+  ac_t ac;                 // automaton
+  unsigned ends[BS_SHORT]; // positions of matches
+  int terms[BS_SHORT];     // terms of matches
+  unsigned len;            // number of matches
+
+  // Overlapping terms, and terms that are suffixes of others
+  const wchar_t *t1[] = {L"he", L"she", L"his", L"hers"};
+  ac_init(&ac, t1, 4, false);
+  len = ac_run(ends, terms, &ac, L"ushers");
+  CU_ASSERT_EQUAL(len, 3);
+  if (3 == len) {
+    CU_ASSERT(3 == ends[0] && 1 == terms[0]); // she
+    CU_ASSERT(3 == ends[1] && 0 == terms[1]); // he
+    CU_ASSERT(5 == ends[2] && 3 == terms[2]); // hers
+  }
+  len = ac_run(ends, terms, &ac, L"ahishe");
+  CU_ASSERT_EQUAL(len, 3);
+  if (3 == len) {
+    CU_ASSERT(3 == ends[0] && 2 == terms[0]); // his
+    CU_ASSERT(5 == ends[1] && 1 == terms[1]); // she
+    CU_ASSERT(5 == ends[2] && 0 == terms[2]); // he
+  }
+  CU_ASSERT_EQUAL(ac_run(ends, terms, &ac, L"HERS"), 0);
+  CU_ASSERT_EQUAL(ac_run(ends, terms, &ac, L""), 0);
+  ac_free(&ac);
+  CU_ASSERT(NULL == ac.nodes);
+
+  // Empty terms are ignored, and duplicates match as the first of them
+  const wchar_t *t2[] = {L"", L"ab", L"ab", L"b"};
+  ac_init(&ac, t2, 4, false);
+  len = ac_run(ends, terms, &ac, L"aab");
+  CU_ASSERT_EQUAL(len, 2);
+  if (2 == len) {
+    CU_ASSERT(2 == ends[0] && 1 == terms[0]); // ab
+    CU_ASSERT(2 == ends[1] && 3 == terms[1]); // b
+  }
+  ac_free(&ac);
+
+  // Case-insensitive matching (the text is fed in lower case)
+  const wchar_t *t3[] = {L"Foo", L"\u0391\u0392"};
+  ac_init(&ac, t3, 2, true);
+  len = ac_run(ends, terms, &ac, L"a foo \u03b1\u03b2");
+  CU_ASSERT_EQUAL(len, 2);
+  if (2 == len) {
+    CU_ASSERT(4 == ends[0] && 0 == terms[0]);
+    CU_ASSERT(7 == ends[1] && 1 == terms[1]);
+  }
+  CU_ASSERT_EQUAL(ac_run(ends, terms, &ac, L"a Foo"), 0);
+  ac_free(&ac);
+}
+
+void test_search_index() {
+  // Several results per line, and lines without any
+  result_t res[] = {{2, 0, 1, 0},  {2, 5, 6, 0}, {3, 1, 2, 0},
+                    {7, 0, 3, 0},  {7, 4, 5, 0}, {7, 9, 9, 0},
+                    {10, 2, 4, 0}, {15, 0, 1, 0}};
+  const unsigned res_len = sizeof(res) / sizeof(result_t); // length of `res`
+  unsigned line, i; // iterators
+
+  CU_ASSERT_EQUAL(search_index(res, res_len, 0), 0);
+  CU_ASSERT_EQUAL(search_index(res, res_len, 2), 0);
+  CU_ASSERT_EQUAL(search_index(res, res_len, 3), 2);
+  CU_ASSERT_EQUAL(search_index(res, res_len, 4), 3);
+  CU_ASSERT_EQUAL(search_index(res, res_len, 7), 3);
+  CU_ASSERT_EQUAL(search_index(res, res_len, 8), 6);
+  CU_ASSERT_EQUAL(search_index(res, res_len, 15), 7);
+  CU_ASSERT_EQUAL(search_index(res, res_len, 16), res_len);
+  CU_ASSERT_EQUAL(search_index(res, 0, 0), 0);
+
+  // Compare with a linear search, for every line
+  for (line = 0; line < 20; line++) {
+    for (i = 0; i < res_len && res[i].line < line; i++)
+      ;
+    CU_ASSERT_EQUAL(search_index(res, res_len, line), i);
+  }
+
+  CU_ASSERT_EQUAL(search_next(res, res_len, 0), 2);
+  CU_ASSERT_EQUAL(search_next(res, res_len, 7), 7);
+  CU_ASSERT_EQUAL(search_next(res, res_len, 8), 10);
+  CU_ASSERT_EQUAL(search_next(res, res_len, 16), -1);
+  CU_ASSERT_EQUAL(search_prev(res, res_len, 1), -1);
+  CU_ASSERT_EQUAL(search_prev(res, res_len, 7), 7);
+  CU_ASSERT_EQUAL(search_prev(res, res_len, 9), 7);
+  CU_ASSERT_EQUAL(search_prev(res, res_len, 100), 15);
+}
+
+void test_fuzzy() {
+  // A string's signature covers the signatures of its subsequences
+  CU_ASSERT_EQUAL(fz_mask(L""), 0);
+  CU_ASSERT_EQUAL(fz_mask(L"LS"), fz_mask(L"ls"));
+  CU_ASSERT_EQUAL(fz_mask(L"ls") & ~fz_mask(L"false"), 0);
+  CU_ASSERT_EQUAL(fz_mask(L"g-c2") & ~fz_mask(L"git-commit2"), 0);
+  CU_ASSERT_NOT_EQUAL(fz_mask(L"lz") & ~fz_mask(L"false"), 0);
+  CU_ASSERT_NOT_EQUAL(fz_mask(L"1") & ~fz_mask(L"l"), 0);
+  CU_ASSERT_NOT_EQUAL(fz_mask(L"a.b") & ~fz_mask(L"ab"), 0);
+
+  // Only subsequences match
+  CU_ASSERT_EQUAL(fz_score(L"", L"ls", true), 0);
+  CU_ASSERT_EQUAL(fz_score(L"sl", L"ls", true), -1);
+  CU_ASSERT_EQUAL(fz_score(L"lss", L"ls", true), -1);
+  CU_ASSERT_EQUAL(fz_score(L"ls", L"", true), -1);
+  CU_ASSERT(fz_score(L"ls", L"false", true) >= 0);
+
+  // A whole word at the beginning scores a match and a bonus per character
+  // (twice the bonus for the first one)
+  CU_ASSERT_EQUAL(fz_score(L"ls", L"ls", true),
+                  2 * FZ_MATCH + 3 * FZ_BOUNDARY_WHITE);
+
+  // Only the shortest matching part of `hayst` is scored
+  CU_ASSERT_EQUAL(fz_score(L"ls", L"lsblk", true),
+                  fz_score(L"ls", L"ls", true));
+  CU_ASSERT_EQUAL(fz_score(L"ls", L"lls", true), fz_score(L"ls", L"xls", true));
+
+  // Runs of characters beat gaps, and word boundaries beat the middle of words
+  CU_ASSERT(fz_score(L"abc", L"abc", true) > fz_score(L"abc", L"a_b_c", true));
+  CU_ASSERT(fz_score(L"abc", L"a_b_c", true) >
+            fz_score(L"abc", L"axbxc", true));
+  CU_ASSERT(fz_score(L"gc", L"git-commit", true) >
+            fz_score(L"gc", L"magic", true));
+  CU_ASSERT(fz_score(L"fb", L"fooBar", true) >
+            fz_score(L"fb", L"foobar", true));
+  CU_ASSERT(fz_score(L"ls", L"ls", true) > fz_score(L"ls", L"false", true));
+
+  // Case sensitivity
+  CU_ASSERT_EQUAL(fz_score(L"ls", L"LS", true), fz_score(L"ls", L"ls", true));
+  CU_ASSERT_EQUAL(fz_score(L"LS", L"ls", false), -1);
+  CU_ASSERT(fz_score(L"LS", L"LS", false) >= 0);
+}
+
+void test_page_rw() {
+  line_t lines[3];      // page
+  line_t *res;          // page, as read back
+  unsigned res_len = 0; // length of `res`
+  char *buf = NULL;     // serialized page
+  size_t buf_len = 0;   // length of `buf`
+  unsigned ln, i;       // iterators
+  FILE *fp;             // stream for `buf`
+
+  line_alloc(lines[0], 10);
+  wcscpy(lines[0].text, L"  LS(1) \u00e9x");
+  bset(lines[0].bold, 2);
+  bset(lines[0].reg, 7);
+  bset(lines[0].uline, 8);
+  line_alloc(lines[1], 0);
+  line_alloc(lines[2], 17);
+  wcscpy(lines[2].text, L"  See also ls(1).");
+  lines[2].links = aalloc(1, link_t);
+  lines[2].links_length = 1;
+  lines[2].links[0] = (link_t){11, 16, true, 0, 3, LT_MAN, xwcsdup(L"ls(1)")};
+
+  fp = open_memstream(&buf, &buf_len);
+  CU_ASSERT_FATAL(NULL != fp);
+  page_write(fp, lines, 3);
+  fclose(fp);
+
+  // The page reads back as it was written
+  fp = fmemopen(buf, buf_len, "r");
+  CU_ASSERT_FATAL(NULL != fp);
+  CU_ASSERT_TRUE(page_read(&res, &res_len, fp));
+  fclose(fp);
+  CU_ASSERT_EQUAL(res_len, 3);
+  for (ln = 0; ln < 3 && 3 == res_len; ln++) {
+    CU_ASSERT_EQUAL(res[ln].length, lines[ln].length);
+    CU_ASSERT(0 == wcscmp(res[ln].text, lines[ln].text));
+    for (i = 0; i < lines[ln].length; i++) {
+      CU_ASSERT_EQUAL(bget(res[ln].reg, i), bget(lines[ln].reg, i));
+      CU_ASSERT_EQUAL(bget(res[ln].bold, i), bget(lines[ln].bold, i));
+      CU_ASSERT_EQUAL(bget(res[ln].italic, i), bget(lines[ln].italic, i));
+      CU_ASSERT_EQUAL(bget(res[ln].uline, i), bget(lines[ln].uline, i));
+    }
+    CU_ASSERT_EQUAL(res[ln].links_length, lines[ln].links_length);
+  }
+  if (3 == res_len && 1 == res[2].links_length) {
+    const link_t *link = &res[2].links[0]; // link, as read back
+    CU_ASSERT(11 == link->start && 16 == link->end);
+    CU_ASSERT(link->in_next && 0 == link->start_next && 3 == link->end_next);
+    CU_ASSERT_EQUAL(link->type, LT_MAN);
+    CU_ASSERT(0 == wcscmp(link->trgt, L"ls(1)"));
+  }
+  if (res_len > 0)
+    lines_free(res, res_len);
+
+  // Truncated data is rejected, wherever it's cut short
+  for (i = 1; i < buf_len; i++) {
+    res_len = 0;
+    fp = fmemopen(buf, i, "r");
+    CU_ASSERT_FATAL(NULL != fp);
+    CU_ASSERT_FALSE(page_read(&res, &res_len, fp));
+    CU_ASSERT_EQUAL(res_len, 0);
+    fclose(fp);
+  }
+
+  // So are pages that are too long, and links that are out of bounds
+  unsigned *count = (unsigned *)buf; // number of lines
+  *count = PAGE_MAX_LINES + 1;
+  fp = fmemopen(buf, buf_len, "r");
+  CU_ASSERT_FALSE(page_read(&res, &res_len, fp));
+  fclose(fp);
+  free(buf);
+  buf = NULL;
+  lines[2].links[0].end = 18;
+  fp = open_memstream(&buf, &buf_len);
+  page_write(fp, lines, 3);
+  fclose(fp);
+  fp = fmemopen(buf, buf_len, "r");
+  CU_ASSERT_FALSE(page_read(&res, &res_len, fp));
+  fclose(fp);
+
+  free(buf);
+  for (ln = 0; ln < 3; ln++) {
+    line_free(lines[ln]);
+  }
+}
+
+void test_ft_query() {
+  // Documents `p0(1)` to `p5(1)`, and the terms that appear in them (sorted)
+  const char *words[] = {"alpha", "beta", "eta", "gamma", "zeta"};
+  const unsigned posts[][2] = {{3, 5}, {1, 5}, {4, 5}, {0, 2}, {0, 4}};
+  const unsigned docs_len = 6, terms_len = 5; // numbers of documents and terms
+  ft_doc_t docs[6];                           // documents table
+  ft_term_t terms[5];                         // terms table
+  char post[BS_SHORT];                        // postings
+  unsigned post_len = 0;                      // length of `post`
+  char str[BS_LINE];                          // strings
+  unsigned str_len = 0;                       // length of `str`
+  char dir[BS_LINE], path[BS_LINE];           // index directory and path
+  aprowhat_t *aw;                             // search results
+  unsigned aw_len;                            // number of search results
+  unsigned i, j;                              // iterators
+
+  for (i = 0; i < docs_len; i++) {
+    docs[i].page = str_len;
+    str_len += 1 + sprintf(&str[str_len], "p%u", i);
+    docs[i].section = str_len;
+    str_len += 1 + sprintf(&str[str_len], "1");
+    docs[i].path = docs[i].section;
+    docs[i].mtime = 0;
+    docs[i].text = str_len;
+    str_len += 1 + sprintf(&str[str_len], "text of p%u", i);
+  }
+  for (i = 0; i < terms_len; i++) {
+    terms[i].word = str_len;
+    str_len += 1 + sprintf(&str[str_len], "%s", words[i]);
+    terms[i].post = post_len;
+    terms[i].post_len = 2;
+    for (j = 0; j < 2; j++) {
+      post[post_len++] = posts[i][j] - (j > 0 ? posts[i][j - 1] : 0);
+      post[post_len++] = 0;
+    }
+  }
+  ft_header_t hdr = {FT_MAGIC, docs_len, terms_len};
+  hdr.docs_off = sizeof(hdr);
+  hdr.terms_off = hdr.docs_off + sizeof(docs);
+  hdr.post_off = hdr.terms_off + sizeof(terms);
+  hdr.str_off = hdr.post_off + post_len;
+  hdr.size = hdr.str_off + str_len;
+
+  // Write the index where `ft_open()` will look for it
+  snprintf(dir, BS_LINE, "/tmp/qman_tests.XXXXXX");
+  CU_ASSERT_FATAL(NULL != mkdtemp(dir));
+  setenv("XDG_CACHE_HOME", dir, 1);
+  ft_path(path, BS_LINE);
+  ft_mkdirs(path);
+  FILE *fp = fopen(path, "w");
+  CU_ASSERT_FATAL(NULL != fp);
+  fwrite(&hdr, sizeof(hdr), 1, fp);
+  fwrite(docs, sizeof(docs), 1, fp);
+  fwrite(terms, sizeof(terms), 1, fp);
+  fwrite(post, 1, post_len, fp);
+  fwrite(str, 1, str_len, fp);
+  fclose(fp);
+
+  // A single term
+  aw_len = ft_query(&aw, L"alpha");
+  CU_ASSERT_EQUAL(aw_len, 2);
+  if (2 == aw_len) {
+    CU_ASSERT(0 == wcscmp(aw[0].ident, L"p3(1)"));
+    CU_ASSERT(0 == wcscmp(aw[1].ident, L"p5(1)"));
+    CU_ASSERT(0 == wcscmp(aw[0].descr, L"text of p3"));
+  }
+  aprowhat_free(aw, aw_len);
+
+  // The last posting of the other term matches a later document of the
+  // rarest one, in either order of the words
+  aw_len = ft_query(&aw, L"alpha beta");
+  CU_ASSERT_EQUAL(aw_len, 1);
+  if (1 == aw_len)
+    CU_ASSERT(0 == wcscmp(aw[0].ident, L"p5(1)"));
+  aprowhat_free(aw, aw_len);
+  aw_len = ft_query(&aw, L"Beta, ALPHA!");
+  CU_ASSERT_EQUAL(aw_len, 1);
+  aprowhat_free(aw, aw_len);
+
+  // Document 0 only matches if every term appears in it
+  aw_len = ft_query(&aw, L"zeta eta");
+  CU_ASSERT_EQUAL(aw_len, 1);
+  if (1 == aw_len)
+    CU_ASSERT(0 == wcscmp(aw[0].ident, L"p4(1)"));
+  aprowhat_free(aw, aw_len);
+  aw_len = ft_query(&aw, L"gamma zeta");
+  CU_ASSERT_EQUAL(aw_len, 1);
+  if (1 == aw_len)
+    CU_ASSERT(0 == wcscmp(aw[0].ident, L"p0(1)"));
+  aprowhat_free(aw, aw_len);
+
+  // No documents in common, and unknown words
+  CU_ASSERT_EQUAL(ft_query(&aw, L"alpha gamma"), 0);
+  CU_ASSERT(err);
+  CU_ASSERT_EQUAL(ft_query(&aw, L"alpha omega"), 0);
+  CU_ASSERT(err);
+
+  ft_close();
+  unlink(path);
+  *strrchr(path, '/') = '\0';
+  rmdir(path);
+  rmdir(dir);
+  unsetenv("XDG_CACHE_HOME");
+}
+
+void test_search_inc() {
+  // Page text, and needles typed one after the other
+  const wchar_t *text[] = {L"  abcab abd", L"", L"  ABC x abc",
+                           L"  xabcabc", L"  nothing", L"  ab"};
+  const wchar_t *needles[] = {L"a", L"ab", L"abc", L"ab", L"abd", L"b", L"abc"};
+  const unsigned text_len = sizeof(text) / sizeof(wchar_t *); // page length
+  line_t lines[6];     // page
+  result_t *res, *exp; // results of `search_inc()` and `search()`
+  unsigned res_len;    // length of `res`
+  unsigned exp_len;    // length of `exp`
+  unsigned i, n, cs;   // iterators
+
+  page_make(lines, text, text_len);
+
+  // Narrowing the previous results (or going back to them) finds the same
+  // results as searching from scratch, whatever the case sensitivity
+  for (cs = 0; cs < 2; cs++)
+    for (i = 0; i < sizeof(needles) / sizeof(wchar_t *); i++) {
+      res_len = search_inc(&res, needles[i], lines, text_len, cs, false, false,
+                           0, 0);
+      exp_len = search(&exp, needles[i], lines, text_len, cs);
+      CU_ASSERT(exp_len > 0);
+      CU_ASSERT_TRUE(results_eq(res, res_len, exp, exp_len));
+      CU_ASSERT_FALSE(isearch_pending());
+      free(res);
+      free(exp);
+    }
+  isearch_reset();
+
+  // A scan that's done in slices starts at `top`, wraps around, and only
+  // reports results in the lines scanned so far
+  for (n = 1; n <= 3; n++) {
+    res_len =
+        search_inc(&res, L"ab", lines, text_len, false, false, false, 3, 2);
+    for (i = 0; i < res_len; i++)
+      CU_ASSERT((res[i].line + text_len - 3) % text_len < 2 * n);
+    CU_ASSERT_EQUAL(isearch_pending(), n < 3);
+    free(res);
+  }
+
+  // Once the scan is over, narrowing it needs no further scanning
+  res_len =
+      search_inc(&res, L"abc", lines, text_len, false, false, false, 3, 2);
+  exp_len = search(&exp, L"abc", lines, text_len, false);
+  CU_ASSERT_FALSE(isearch_pending());
+  CU_ASSERT_TRUE(results_eq(res, res_len, exp, exp_len));
+  free(res);
+  free(exp);
+  isearch_reset();
+
+  for (i = 0; i < text_len; i++) {
+    line_free(lines[i]);
+  }
+}
+
+void test_link_index() {
+  // Page text, and number of links on each line
+  const wchar_t *text[] = {L"  ls(1) cp(1)", L"", L"  mv(1)", L"", L"",
+                           L"  rm(1)"};
+  const unsigned links[] = {2, 0, 1, 0, 0, 1};
+  const unsigned text_len = sizeof(text) / sizeof(wchar_t *); // page length
+  line_t lines[6];      // page
+  link_loc_t loc;       // current link location
+  unsigned ln, l, pass; // iterators
+
+  page_make(lines, text, text_len);
+  for (ln = 0; ln < text_len; ln++)
+    for (l = 0; l < links[ln]; l++) {
+      line_realloc_link(lines[ln]);
+      lines[ln].links[l] =
+          (link_t){2 + 6 * l, 7 + 6 * l, false, 0, 0, LT_MAN, xwcsdup(L"x")};
+    }
+
+  // The first pass uses a temporary index, and the second one the index of
+  // `page`, which is built once and kept
+  for (pass = 0; pass < 2; pass++) {
+    if (1 == pass)
+      page = lines;
+
+    // There's no link before the first one, even on line 0
+    loc = prev_link(lines, text_len, (link_loc_t){true, 0, 0});
+    CU_ASSERT_FALSE(loc.ok);
+    loc = prev_link(lines, text_len, (link_loc_t){true, 0, 1});
+    CU_ASSERT(loc.ok && 0 == loc.line && 0 == loc.link);
+    loc = prev_link(lines, text_len, (link_loc_t){true, 2, 0});
+    CU_ASSERT(loc.ok && 0 == loc.line && 1 == loc.link);
+    loc = prev_link(lines, text_len, (link_loc_t){true, 5, 0});
+    CU_ASSERT(loc.ok && 2 == loc.line && 0 == loc.link);
+    loc = prev_link(lines, text_len, (link_loc_t){true, text_len, 0});
+    CU_ASSERT_FALSE(loc.ok);
+
+    // There's no link after the last one, on the last line
+    loc = next_link(lines, text_len, (link_loc_t){true, 0, 1});
+    CU_ASSERT(loc.ok && 2 == loc.line && 0 == loc.link);
+    loc = next_link(lines, text_len, (link_loc_t){true, 3, 0});
+    CU_ASSERT(loc.ok && 5 == loc.line && 0 == loc.link);
+    loc = next_link(lines, text_len, (link_loc_t){true, 5, 0});
+    CU_ASSERT_FALSE(loc.ok);
+
+    // Line ranges are clamped to the end of the page
+    loc = first_link(lines, text_len, 0, 0);
+    CU_ASSERT(loc.ok && 0 == loc.line && 0 == loc.link);
+    loc = first_link(lines, text_len, 1, 1);
+    CU_ASSERT_FALSE(loc.ok);
+    loc = first_link(lines, text_len, 3, 100);
+    CU_ASSERT(loc.ok && 5 == loc.line && 0 == loc.link);
+    loc = first_link(lines, text_len, text_len, 100);
+    CU_ASSERT_FALSE(loc.ok);
+    loc = last_link(lines, text_len, 0, 1);
+    CU_ASSERT(loc.ok && 0 == loc.line && 1 == loc.link);
+    loc = last_link(lines, text_len, 0, 100);
+    CU_ASSERT(loc.ok && 5 == loc.line && 0 == loc.link);
+    loc = last_link(lines, text_len, 3, 4);
+    CU_ASSERT_FALSE(loc.ok);
+  }
+  CU_ASSERT(NULL != page_links);
+
+  free(page_links);
+  free(page_links_offs);
+  page_links = NULL;
+  page_links_offs = NULL;
+  page = NULL;
+  for (ln = 0; ln < text_len; ln++) {
+    line_free(lines[ln]);
+  }
+}
+
+void test_toc_lines() {
+  // Page text
+  const wchar_t *text[] = {L"  LS(1)          User Commands          LS(1)",
+                           L"",
+                           L"  NAME",
+                           L"         ls - list directory contents",
+                           L"  SYNOPSIS",
+                           L"         ls [OPTION]... [FILE]...",
+                           L"  OPTIONS",
+                           L"         -a, --all",
+                           L"                do not ignore hidden entries",
+                           L"         -l     use a long listing format",
+                           L"     Sorting",
+                           L"         -a     sort by access time",
+                           L"  SEE ALSO"};
+  const unsigned text_len = sizeof(text) / sizeof(wchar_t *); // page length
+  line_t lines[13]; // page
+  unsigned ln;      // iterator
+
+  page_make(lines, text, text_len);
+  page = lines;
+  page_len = text_len;
+
+  // Section titles and options are found wherever they are
+  CU_ASSERT_EQUAL(ls_discover(L"NAME", 0), 2);
+  CU_ASSERT_EQUAL(ls_discover(L"OPTIONS", 0), 6);
+  CU_ASSERT_EQUAL(ls_discover(L"SEE ALSO", 0), 12);
+  CU_ASSERT_EQUAL(ls_discover(L"-a, --all", 0), 7);
+  CU_ASSERT_EQUAL(ls_discover(L"-l", 0), 9);
+
+  // Among equally good lines, the first one at or after `sln` wins, so that
+  // TOC entries are found under their own section or subsection
+  CU_ASSERT_EQUAL(ls_discover(L"ls", 0), 3);
+  CU_ASSERT_EQUAL(ls_discover(L"ls", 4), 5);
+  CU_ASSERT_EQUAL(ls_discover(L"-a", ls_discover(L"Sorting", 0)), 11);
+  CU_ASSERT_EQUAL(ls_discover(L"-a, --all", 8), 0);
+
+  // Targets that match nothing, empty targets, and lines past the end
+  CU_ASSERT_EQUAL(ls_discover(L"FILES", 0), 0);
+  CU_ASSERT_EQUAL(ls_discover(L"", 0), -1);
+  CU_ASSERT_EQUAL(ls_discover(L"NAME", text_len), -1);
+  CU_ASSERT(NULL != page_starts);
+
+  free(page_starts);
+  page_starts = NULL;
+  page = NULL;
+  page_len = 0;
+  for (ln = 0; ln < text_len; ln++) {
+    line_free(lines[ln]);
+  }
+}
+
+void test_history() {
+  const int old_size = config.misc.history_size; // previous `history_size`
+  wchar_t args[BS_SHORT];                         // current page name
+  unsigned buf_len;                               // `history_buf_len`
+  unsigned i;                                     // iterator
+
+  // Once `history_size` entries are in use, every new entry evicts the oldest
+  // one
+  config.misc.history_size = 3;
+  history_replace(RT_MAN, L"p0");
+  for (i = 1; i < 10; i++) {
+    swprintf(args, BS_SHORT, L"p%u", i);
+    history_push(RT_MAN, args);
+    CU_ASSERT_EQUAL(history_top, MIN(i, 2));
+    CU_ASSERT_EQUAL(history_cur, history_top);
+    CU_ASSERT(0 == wcscmp(history[history_cur].args, args));
+  }
+  CU_ASSERT(0 == wcscmp(history[0].args, L"p7"));
+  CU_ASSERT(0 == wcscmp(history[1].args, L"p8"));
+
+  // Evicting entries doesn't make `history_buf` grow
+  buf_len = history_buf_len;
+  for (i = 10; i < 10 * BS_SHORT; i++) {
+    swprintf(args, BS_SHORT, L"p%u", i);
+    history_push(RT_MAN, args);
+  }
+  CU_ASSERT_EQUAL(history_buf_len, buf_len);
+  CU_ASSERT_EQUAL(history_top, 2);
+  swprintf(args, BS_SHORT, L"p%u", 10 * BS_SHORT - 3);
+  CU_ASSERT(0 == wcscmp(history[0].args, args));
+
+  // Going back restores the location in the previous entry, and pushing a new
+  // entry from there discards the ones after it
+  page_top = 5;
+  history_push(RT_APROPOS, L"q");
+  page_top = 0;
+  CU_ASSERT_TRUE(history_back(1));
+  CU_ASSERT_EQUAL(page_top, 5);
+  history_push(RT_WHATIS, L"r");
+  CU_ASSERT_EQUAL(history_top, 2);
+  CU_ASSERT_EQUAL(history[1].request_type, RT_MAN);
+  CU_ASSERT_EQUAL(history[2].request_type, RT_WHATIS);
+  CU_ASSERT_FALSE(history_forward(1));
+
+  history_cur = 0;
+  history_reset();
+  history_replace(RT_NONE, NULL);
+  page_top = 0;
+  config.misc.history_size = old_size;
+}
+
+void test_session() {
+  const wchar_t *text[] = {L"  CAT(1)", L"  cat - concatenate files"}; // page
+  const int old_size = config.misc.history_size; // previous `history_size`
+  line_t lines[2];                               // page
+  char dir[BS_LINE], path[BS_LINE];              // cache directory, and path
+  unsigned ln;                                   // iterator
+  FILE *fp;                                      // session file
+
+  snprintf(dir, BS_LINE, "/tmp/qman_tests.XXXXXX");
+  CU_ASSERT_FATAL(NULL != mkdtemp(dir));
+  setenv("XDG_CACHE_HOME", dir, true);
+  session_path(path, BS_LINE);
+
+  // Save three history entries, with a location in each, and the current page
+  history_replace(RT_APROPOS, L"ls");
+  page_top = 3;
+  history_push(RT_MAN, L"ls(1)");
+  page_top = 7;
+  page_left = 2;
+  page_flink = (link_loc_t){true, 4, 1};
+  history_push(RT_WHATIS, L"cat");
+  page_top = 1;
+  page_left = 0;
+  page_flink = (link_loc_t){false, 0, 0};
+  page_make(lines, text, 2);
+  page = lines;
+  page_len = 2;
+  wcslcpy(page_title, L"cat", BS_SHORT);
+  session_save();
+  for (ln = 0; ln < 2; ln++) {
+    line_free(lines[ln]);
+  }
+
+  // Everything reads back as it was saved
+  history_cur = 0;
+  history_reset();
+  history_replace(RT_NONE, NULL);
+  page = NULL;
+  page_len = 0;
+  page_title[0] = L'\0';
+  page_top = 0;
+  CU_ASSERT_TRUE(session_load());
+  CU_ASSERT(2 == history_top && 2 == history_cur);
+  CU_ASSERT(RT_APROPOS == history[0].request_type &&
+            0 == wcscmp(history[0].args, L"ls") && 3 == history[0].top);
+  CU_ASSERT(RT_MAN == history[1].request_type &&
+            0 == wcscmp(history[1].args, L"ls(1)") && 7 == history[1].top &&
+            2 == history[1].left);
+  CU_ASSERT(history[1].flink.ok && 4 == history[1].flink.line &&
+            1 == history[1].flink.link);
+  CU_ASSERT(RT_WHATIS == history[2].request_type &&
+            0 == wcscmp(history[2].args, L"cat"));
+  CU_ASSERT_EQUAL(page_top, 1);
+  CU_ASSERT(0 == wcscmp(page_title, L"cat"));
+  CU_ASSERT_FATAL(NULL != page && 2 == page_len);
+  for (ln = 0; ln < 2; ln++)
+    CU_ASSERT(0 == wcscmp(page[ln].text, text[ln]));
+  lines_free(page, page_len);
+  page = NULL;
+
+  // A smaller `history_size` evicts the oldest entries
+  config.misc.history_size = 2;
+  history_cur = 0;
+  history_reset();
+  CU_ASSERT_TRUE(session_load());
+  CU_ASSERT(1 == history_top && 1 == history_cur);
+  CU_ASSERT(0 == wcscmp(history[0].args, L"ls(1)"));
+  lines_free(page, page_len);
+  page = NULL;
+
+  // Truncated and missing session files are ignored
+  fp = fopen(path, "r+");
+  CU_ASSERT_FATAL(NULL != fp);
+  CU_ASSERT(0 == ftruncate(fileno(fp), sizeof(session_header_t) + 4));
+  fclose(fp);
+  CU_ASSERT_FALSE(session_load());
+  CU_ASSERT(1 == history_top && 1 == history_cur);
+  unlink(path);
+  CU_ASSERT_FALSE(session_load());
+
+  history_cur = 0;
+  history_reset();
+  history_replace(RT_NONE, NULL);
+  page_len = 0;
+  page_top = 0;
+  page_left = 0;
+  config.misc.history_size = old_size;
+  *strrchr(path, '/') = '\0';
+  rmdir(path);
+  rmdir(dir);
+  unsetenv("XDG_CACHE_HOME");
+}
+
+void test_lazy_fill() {
+  // Manual pages, in two sections
+  const wchar_t *pages[] = {L"ls", L"printf", L"cat"};
+  const wchar_t *secs[] = {L"1", L"3", L"1"};
+  const wchar_t *descrs[] = {L"list directory contents",
+                             L"formatted output conversion",
+                             L"concatenate files and print on the standard "
+                             L"output, and do it with a long description"};
+  const unsigned aw_len = 3;   // number of manual pages
+  aprowhat_t *aw;              // manual pages
+  wchar_t **sc;                // their sections
+  unsigned sc_len;             // number of sections
+  wchar_t ident[BS_SHORT];     // current ident
+  line_t *full, *lazy;         // pages filled in all at once, and lazily
+  unsigned full_len, lazy_len; // their lengths
+  unsigned *lens, *links_lens; // lengths and numbers of links of `lazy`
+  unsigned ln, i;              // iterators
+
+  aw = aalloc(aw_len, aprowhat_t);
+  for (i = 0; i < aw_len; i++) {
+    aw[i].page = xwcsdup(pages[i]);
+    aw[i].section = xwcsdup(secs[i]);
+    swprintf(ident, BS_SHORT, L"%ls(%ls)", pages[i], secs[i]);
+    aw[i].ident = xwcsdup(ident);
+    aw[i].descr = xwcsdup(descrs[i]);
+  }
+  sc_len = aprowhat_sections(&sc, aw, aw_len);
+
+  // Laying out a second page fills in all of the first one
+  full_len = aprowhat_render(&full, aw, aw_len, (const wchar_t **)sc, sc_len,
+                             L"KEY", L"Title", L"Version", L"Date", false);
+  lazy_len = aprowhat_render(&lazy, aw, aw_len, (const wchar_t **)sc, sc_len,
+                             L"KEY", L"Title", L"Version", L"Date", false);
+  CU_ASSERT_FATAL(full_len == lazy_len && full_len > 0);
+  CU_ASSERT(lazy == aw_lazy.lines);
+  for (ln = 0; ln < full_len; ln++)
+    CU_ASSERT(NULL != full[ln].text);
+
+  // Lines filled in lazily, in any order, are the same as those filled in all
+  // at once, and their lengths and numbers of links are known beforehand
+  lens = aalloc(lazy_len, unsigned);
+  links_lens = aalloc(lazy_len, unsigned);
+  for (ln = 0; ln < lazy_len; ln++) {
+    lens[ln] = lazy[ln].length;
+    links_lens[ln] = lazy[ln].links_length;
+  }
+  for (ln = lazy_len; ln > 0; ln--) {
+    const line_t *a = &full[ln - 1];         // filled in all at once
+    const line_t *b = line_at(lazy, ln - 1); // filled in lazily
+    CU_ASSERT_EQUAL(b->length, lens[ln - 1]);
+    CU_ASSERT_EQUAL(b->links_length, links_lens[ln - 1]);
+    CU_ASSERT_EQUAL(a->length, b->length);
+    CU_ASSERT(0 == wcscmp(a->text, b->text));
+    for (i = 0; i < a->length; i++) {
+      CU_ASSERT_EQUAL(bget(a->reg, i), bget(b->reg, i));
+      CU_ASSERT_EQUAL(bget(a->bold, i), bget(b->bold, i));
+      CU_ASSERT_EQUAL(bget(a->italic, i), bget(b->italic, i));
+      CU_ASSERT_EQUAL(bget(a->uline, i), bget(b->uline, i));
+    }
+    CU_ASSERT_FATAL(a->links_length == b->links_length);
+    for (i = 0; i < a->links_length; i++) {
+      CU_ASSERT(a->links[i].start == b->links[i].start &&
+                a->links[i].end == b->links[i].end);
+      CU_ASSERT_EQUAL(a->links[i].type, b->links[i].type);
+      CU_ASSERT(0 == wcscmp(a->links[i].trgt, b->links[i].trgt));
+    }
+  }
+
+  free(lens);
+  free(links_lens);
+  lines_free(full, full_len);
+  lines_free(lazy, lazy_len);
+  CU_ASSERT(NULL == aw_lazy.lines);
+  aprowhat_free(aw, aw_len);
+  wafree(sc, sc_len);
+}
+
 // Where we hope it works
 int main(int argc, char **argv) {
   init();
@@ -242,6 +1107,18 @@ int main(int argc, char **argv) {
 
   // `add_test()` all your tests here
   add_test(eini_parse);
+  add_test(roff);
+  add_test(ac);
+  add_test(search_index);
+  add_test(fuzzy);
+  add_test(page_rw);
+  add_test(ft_query);
+  add_test(search_inc);
+  add_test(link_index);
+  add_test(toc_lines);
+  add_test(history);
+  add_test(session);
+  add_test(lazy_fill);
 
   run_tests_and_exit();
 }
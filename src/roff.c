@@ -0,0 +1,1926 @@
+// Built-in man(7) formatter (implementation)
+
+#include "lib.h"
+
+//
+// Global variables
+//
+
+roff_special_t roff_specials[] = {
+    {L"em", L"—"},  {L"en", L"–"},  {L"hy", L"-"},  {L"mi", L"-"},
+    {L"-", L"-"},   {L"aq", L"'"},  {L"dq", L"\""}, {L"lq", L"“"},
+    {L"rq", L"”"},  {L"oq", L"‘"},  {L"cq", L"’"},  {L"Bq", L"„"},
+    {L"bq", L"‚"},  {L"Fo", L"«"},  {L"Fc", L"»"},  {L"fo", L"‹"},
+    {L"fc", L"›"},  {L"bu", L"•"},  {L"pc", L"·"},  {L"ci", L"○"},
+    {L"sq", L"□"},  {L"co", L"©"},  {L"rg", L"®"},  {L"tm", L"™"},
+    {L"de", L"°"},  {L"+-", L"±"},  {L"mu", L"×"},  {L"di", L"÷"},
+    {L"<=", L"≤"},  {L">=", L"≥"},  {L"!=", L"≠"},  {L"==", L"≡"},
+    {L"~=", L"≅"},  {L"ap", L"~"},  {L"->", L"→"},  {L"<-", L"←"},
+    {L"<>", L"↔"},  {L"ua", L"↑"},  {L"da", L"↓"},  {L"rA", L"⇒"},
+    {L"lA", L"⇐"},  {L"sc", L"§"},  {L"ps", L"¶"},  {L"dg", L"†"},
+    {L"dd", L"‡"},  {L"ti", L"~"},  {L"ha", L"^"},  {L"rs", L"\\"},
+    {L"sl", L"/"},  {L"ba", L"|"},  {L"br", L"│"},  {L"or", L"|"},
+    {L"ul", L"_"},  {L"ru", L"_"},  {L"ga", L"`"},  {L"aa", L"´"},
+    {L"at", L"@"},  {L"sh", L"#"},  {L"Do", L"$"},  {L"Eu", L"€"},
+    {L"eu", L"€"},  {L"ct", L"¢"},  {L"Po", L"£"},  {L"Ye", L"¥"},
+    {L"ss", L"ß"},  {L"12", L"½"},  {L"14", L"¼"},  {L"34", L"¾"},
+    {L"S1", L"¹"},  {L"S2", L"²"},  {L"S3", L"³"},  {L"lB", L"["},
+    {L"rB", L"]"},  {L"lC", L"{"},  {L"rC", L"}"},  {L"la", L"⟨"},
+    {L"ra", L"⟩"},  {L"OK", L"✓"},  {L"if", L"∞"},  {L"no", L"¬"},
+    {L"AN", L"∧"},  {L"OR", L"∨"},  {L"pl", L"+"},  {L"eq", L"="},
+    {L"'e", L"é"},  {L"`e", L"è"},  {L":u", L"ü"},  {L":o", L"ö"},
+    {L":a", L"ä"},  {L":U", L"Ü"},  {L":O", L"Ö"},  {L":A", L"Ä"},
+    {L"~n", L"ñ"},  {L",c", L"ç"},  {L"oA", L"Å"},  {L"oa", L"å"},
+    {L"/o", L"ø"},  {L"/O", L"Ø"},  {L"'a", L"á"},  {L"'i", L"í"},
+    {L"'o", L"ó"},  {L"'u", L"ú"},  {NULL, NULL}};
+
+roff_special_t roff_predefs[] = {{L"R", L"®"},  {L"Tm", L"™"}, {L"lq", L"“"},
+                                 {L"rq", L"”"}, {L"S", L""},   {NULL, NULL}};
+
+//
+// Helper macros and functions
+//
+
+// Helper of most functions. Mark formatter state `st` as having encountered an
+// unsupported construct.
+#define roff_fail(st) (st)->ok = false
+
+// Helper of `roff_word()` and `roff_justify()`. Append character `c`, in font
+// `f`, to the output line of `st`.
+void roff_out(roff_t *st, wchar_t c, roff_font_t f) {
+  if (st->out_len == st->out_size) {
+    st->out_size += BS_SHORT;
+    st->out = xreallocarray(st->out, st->out_size, sizeof(roff_char_t));
+    st->gaps = xreallocarray(st->gaps, st->out_size, sizeof(unsigned));
+  }
+
+  st->out[st->out_len].c = c;
+  st->out[st->out_len].font = f;
+  st->out_len++;
+}
+
+// Helper of `roff_word()` and `roff_line_end()`. Pad the output line of `st`
+// with spaces, until its length becomes `col`.
+void roff_pad(roff_t *st, unsigned col) {
+  while (st->out_len < col)
+    roff_out(st, L' ', RF_R);
+}
+
+// Helper of `roff_flush()` and `roff_th()`. Convert the output line of `st`
+// into a `line_t`, append it to the output buffer, and clear it.
+void roff_put(roff_t *st) {
+  const unsigned len = st->lmargin + st->out_len; // line text length
+  roff_font_t font = RF_R;                        // current font
+  unsigned i, j;                                  // iterators
+
+  if (st->ln == st->res_len) {
+    st->res_len += BS_LINE;
+    st->res = xreallocarray(st->res, st->res_len, sizeof(line_t));
+  }
+
+  line_alloc(st->res[st->ln], len + 1);
+  for (j = 0; j < st->lmargin; j++)
+    st->res[st->ln].text[j] = L' ';
+  for (i = 0; i < st->out_len; i++, j++) {
+    if (font != st->out[i].font) {
+      font = st->out[i].font;
+      if (RF_R == font)
+        bset(st->res[st->ln].reg, j);
+      else if (RF_I == font)
+        bset(st->res[st->ln].uline, j);
+      else
+        bset(st->res[st->ln].bold, j);
+    }
+    st->res[st->ln].text[j] = st->out[i].c;
+  }
+  if (RF_R != font)
+    bset(st->res[st->ln].reg, j);
+  st->res[st->ln].text[j] = L'\0';
+  st->res[st->ln].length = j + 1;
+  st->ln++;
+
+  st->out_len = 0;
+  st->gaps_len = 0;
+}
+
+// Helper of `roff_flush()`. Justify the output line of `st`, by distributing
+// extra spaces among its inter-word gaps.
+void roff_justify(roff_t *st) {
+  const int extra = (int)st->width - (int)st->out_len; // spaces to distribute
+  const roff_char_t *out = st->out;                    // original line
+  const unsigned out_len = st->out_len;                // its length
+  unsigned i, g = 0, k;                                // iterators
+
+  if (extra <= 0 || 0 == st->gaps_len)
+    return;
+
+  const unsigned per = extra / st->gaps_len; // spaces added to every gap
+  const unsigned rem = extra % st->gaps_len; // gaps that get one more
+
+  st->out = aalloc(st->out_size, roff_char_t);
+  st->out_len = 0;
+  for (i = 0; i < out_len; i++) {
+    if (g < st->gaps_len && i == st->gaps[g]) {
+      unsigned add = per;
+      if (st->jdir ? g >= st->gaps_len - rem : g < rem)
+        add++;
+      for (k = 0; k < add; k++)
+        roff_out(st, L' ', out[i].font);
+      g++;
+    }
+    roff_out(st, out[i].c, out[i].font);
+  }
+  st->jdir = !st->jdir;
+
+  free((void *)out);
+}
+
+// Helper of most functions. Output the line being filled (if any), justifying
+// it first if `justify` is true.
+void roff_flush(roff_t *st, bool justify) {
+  if (0 == st->out_len)
+    return;
+
+  if (justify && st->fill && st->adjust)
+    roff_justify(st);
+  roff_put(st);
+}
+
+// Helper of most functions. Place the word being assembled on the line being
+// filled, breaking the line first if the word doesn't fit.
+void roff_word(roff_t *st) {
+  unsigned i; // iterator
+
+  if (0 == st->word_len)
+    return;
+
+  // Text before `.TH` is not supported
+  if (!st->th_seen) {
+    roff_fail(st);
+    st->word_len = 0;
+    return;
+  }
+
+  if (0 == st->out_len) {
+    // First word on the line; indent
+    roff_pad(st, st->ti >= 0 ? st->ti : st->indent);
+    st->ti = -1;
+  } else if (st->fill) {
+    if (st->out_len + st->spaces + st->word_len > st->width) {
+      // Word doesn't fit; break the line
+      roff_flush(st, true);
+      roff_pad(st, st->indent);
+    } else if (st->spaces > 0) {
+      // Word fits; place a gap before it, in the word's font if that's the
+      // same as the font of the preceding character
+      roff_font_t f = st->out[st->out_len - 1].font == st->word[0].font
+                          ? st->word[0].font
+                          : RF_R;
+      st->gaps[st->gaps_len++] = st->out_len;
+      for (i = 0; i < st->spaces; i++)
+        roff_out(st, L' ', f);
+    }
+  }
+
+  for (i = 0; i < st->word_len; i++)
+    roff_out(st, st->word[i].c, st->word[i].font);
+
+  st->word_len = 0;
+  st->spaces = 0;
+  st->nospace = false;
+}
+
+// Helper of most functions. Cause a break: place the word being assembled, and
+// output the line being filled without justifying it.
+void roff_break(roff_t *st) {
+  roff_word(st);
+  roff_flush(st, false);
+  st->spaces = 0;
+}
+
+// Helper of `roff_macro()`. Cause a break, and then output `n` blank lines,
+// unless no-space mode is on.
+void roff_blank(roff_t *st, unsigned n) {
+  unsigned i; // iterator
+
+  roff_break(st);
+  if (st->nospace)
+    return;
+
+  for (i = 0; i < n; i++)
+    roff_put(st);
+}
+
+// Helper of `roff_text()` and `roff_escape()`. Append character `c` to the word
+// being assembled, using the current font.
+void roff_char(roff_t *st, wchar_t c) {
+  unsigned i; // iterator
+
+  if (BS_LINE == st->word_len)
+    roff_word(st);
+
+  for (i = 0; i < st->tr_len; i++)
+    if (c == st->tr_from[i]) {
+      c = st->tr_to[i];
+      break;
+    }
+
+  st->word[st->word_len].c = c;
+  st->word[st->word_len].font = st->font;
+  st->word_len++;
+  st->noeos = false;
+}
+
+// Helper of `roff_escape()` and `roff_macro()`. Change the current font to the
+// one named `name`.
+void roff_font(roff_t *st, const wchar_t *name) {
+  roff_font_t f; // new font
+
+  if (0 == wcscmp(name, L"") || 0 == wcscmp(name, L"P")) {
+    f = st->font_prev;
+  } else if (0 == wcscmp(name, L"R") || 0 == wcscmp(name, L"1") ||
+             0 == wcscmp(name, L"CR") || 0 == wcscmp(name, L"CW") ||
+             0 == wcscmp(name, L"C") || 0 == wcscmp(name, L"TR")) {
+    f = RF_R;
+  } else if (0 == wcscmp(name, L"B") || 0 == wcscmp(name, L"3") ||
+             0 == wcscmp(name, L"CB") || 0 == wcscmp(name, L"TB")) {
+    f = RF_B;
+  } else if (0 == wcscmp(name, L"I") || 0 == wcscmp(name, L"2") ||
+             0 == wcscmp(name, L"CI") || 0 == wcscmp(name, L"TI")) {
+    f = RF_I;
+  } else if (0 == wcscmp(name, L"BI") || 0 == wcscmp(name, L"4") ||
+             0 == wcscmp(name, L"CBI") || 0 == wcscmp(name, L"TBI")) {
+    f = RF_BI;
+  } else {
+    roff_fail(st);
+    return;
+  }
+
+  st->font_prev = st->font;
+  st->font = f;
+}
+
+// Helper of `roff_escape()`. Read an escape sequence argument, in any of the
+// `x`, `(xx`, or `[xxx]` forms, from `src[i]` into `dst` (of length
+// `BS_SHORT`). Return the position in `src` right after the argument, or 0 if
+// the argument is malformed.
+unsigned roff_name(wchar_t *dst, const wchar_t *src, unsigned i) {
+  unsigned j = 0; // iterator
+
+  if (L'\0' == src[i]) {
+    return 0;
+  } else if (L'(' == src[i]) {
+    if (L'\0' == src[i + 1] || L'\0' == src[i + 2])
+      return 0;
+    dst[0] = src[i + 1];
+    dst[1] = src[i + 2];
+    dst[2] = L'\0';
+    return i + 3;
+  } else if (L'[' == src[i]) {
+    i++;
+    while (L']' != src[i]) {
+      if (L'\0' == src[i] || BS_SHORT - 1 == j)
+        return 0;
+      dst[j++] = src[i++];
+    }
+    dst[j] = L'\0';
+    return i + 1;
+  }
+
+  dst[0] = src[i];
+  dst[1] = L'\0';
+  return i + 1;
+}
+
+// Helper of `roff_escape()`. Return the replacement text for `name` from table
+// `tbl`, or NULL if `name` isn't in `tbl`.
+const wchar_t *roff_lookup(const roff_special_t *tbl, const wchar_t *name) {
+  unsigned i; // iterator
+
+  for (i = 0; NULL != tbl[i].name; i++)
+    if (0 == wcscmp(tbl[i].name, name))
+      return tbl[i].value;
+
+  return NULL;
+}
+
+// Helper of `roff_escape()` and `roff_cond()`. Return the value of the
+// user-defined string named `name`, or NULL if there's no such string.
+const wchar_t *roff_string(const roff_t *st, const wchar_t *name) {
+  unsigned i; // iterator
+
+  for (i = 0; i < st->strings_len; i++)
+    if (0 == wcscmp(st->strings[i].name, name))
+      return st->strings[i].value;
+
+  return NULL;
+}
+
+// Helper of `roff_escape()`, `roff_term()`, `roff_cond()`, and others. Place
+// the value of the number register named `name` into `dst`. Return false if no
+// such register exists.
+bool roff_reg_get(const roff_t *st, const wchar_t *name, int *dst) {
+  unsigned i; // iterator
+
+  // Built-in read-only registers
+  const roff_register_t builtins[] = {
+      {L".g", 1},                       // we pretend to be groff
+      {L".H", 24},                      // horizontal resolution
+      {L".V", 40},                      // vertical resolution
+      {L".i", 24 * st->indent},         // indentation
+      {L".l", 24 * st->width},          // line length
+      {L".ss", 12},                     // word space size
+      {L"an-margin", 24 * st->margin}}; // man(7)'s left margin
+
+  for (i = 0; i < sizeof(builtins) / sizeof(builtins[0]); i++)
+    if (0 == wcscmp(builtins[i].name, name)) {
+      *dst = builtins[i].value;
+      return true;
+    }
+
+  for (i = 0; i < st->registers_len; i++)
+    if (0 == wcscmp(st->registers[i].name, name)) {
+      *dst = st->registers[i].value;
+      return true;
+    }
+
+  return false;
+}
+
+// Helper of `roff_macro()`. Set the value of the number register named `name`
+// to `value`, creating the register if it doesn't exist.
+void roff_reg_set(roff_t *st, const wchar_t *name, int value) {
+  unsigned i; // iterator
+
+  for (i = 0; i < st->registers_len; i++)
+    if (0 == wcscmp(st->registers[i].name, name)) {
+      st->registers[i].value = value;
+      return;
+    }
+
+  if (ROFF_REGISTERS == st->registers_len) {
+    roff_fail(st);
+    return;
+  }
+  st->registers[i].name = xwcsdup(name);
+  st->registers[i].value = value;
+  st->registers_len++;
+}
+
+// Helper of `roff_escape()` and `roff_cond()`. Read a delimited escape sequence
+// argument (e.g. `'-4'` in `\h'-4'`) that starts at `src[*i]` into `dst` (of
+// length `BS_SHORT`), and advance `*i` right after it. Return false if the
+// argument is malformed.
+bool roff_delim(wchar_t *dst, const wchar_t *src, unsigned *i) {
+  const wchar_t delim = src[*i]; // delimiter
+  unsigned j = 0;                // iterator
+
+  for ((*i)++; delim != src[*i]; (*i)++) {
+    if (L'\0' == src[*i] || BS_SHORT - 1 == j)
+      return false;
+    dst[j++] = src[*i];
+  }
+  dst[j] = L'\0';
+  (*i)++;
+
+  return true;
+}
+
+bool roff_expr(roff_t *st, const wchar_t *src, unsigned *i, double scale,
+               int *dst);
+
+// Helper of `roff_term()`. Return the width, in characters, of text `src`, or
+// -1 if `src` contains escape sequences other than those commonly found in
+// `\w` arguments.
+int roff_width(const wchar_t *src) {
+  wchar_t name[BS_SHORT]; // escape sequence argument
+  int res = 0;            // return value
+  unsigned i = 0;         // iterator
+
+  while (L'\0' != src[i]) {
+    if (L'\\' != src[i]) {
+      res++;
+      i++;
+      continue;
+    }
+    i++;
+    switch (src[i]) {
+    case L'f':
+      i = roff_name(name, src, i + 1);
+      if (0 == i)
+        return -1;
+      break;
+    case L'(':
+    case L'[':
+      i = roff_name(name, src, i);
+      if (0 == i)
+        return -1;
+      res++;
+      break;
+    case L'-':
+    case L' ':
+    case L'~':
+    case L'0':
+    case L'e':
+    case L'\\':
+      res++;
+      i++;
+      break;
+    case L'&':
+    case L'|':
+    case L'^':
+    case L'%':
+      i++;
+      break;
+    default:
+      return -1;
+    }
+  }
+
+  return res;
+}
+
+// Helper of `roff_expr()`. Evaluate the term at `src[*i]` (a number, a number
+// register, or a parenthesized expression), and advance `*i` right after it.
+// Arguments and return value are the same as those of `roff_expr()`.
+bool roff_term(roff_t *st, const wchar_t *src, unsigned *i, double scale,
+               int *dst) {
+  wchar_t name[BS_SHORT]; // register name
+  wchar_t *end;           // end of number in `src`
+  double val;             // value of number
+
+  if (L'-' == src[*i] || L'+' == src[*i]) {
+    const bool neg = L'-' == src[*i];
+    (*i)++;
+    if (!roff_term(st, src, i, scale, dst))
+      return false;
+    if (neg)
+      *dst = -*dst;
+    return true;
+  } else if (L'(' == src[*i]) {
+    (*i)++;
+    if (!roff_expr(st, src, i, scale, dst) || L')' != src[*i])
+      return false;
+    (*i)++;
+    return true;
+  } else if (L'\\' == src[*i] && L'w' == src[*i + 1]) {
+    // Width of a string
+    *i += 2;
+    if (L'\0' == src[*i] || !roff_delim(name, src, i))
+      return false;
+    *dst = 24 * roff_width(name);
+    if (*dst < 0)
+      return false;
+    if (L'u' == src[*i])
+      (*i)++;
+    return true;
+  } else if (L'\\' == src[*i] && L'n' == src[*i + 1]) {
+    const unsigned j = roff_name(name, src, *i + 2);
+    if (0 == j || !roff_reg_get(st, name, dst))
+      return false;
+    *i = j;
+    return true;
+  }
+
+  val = wcstod(&src[*i], &end);
+  if (end == &src[*i])
+    return false;
+  *i = end - src;
+
+  // Scaling units (1 character = 24u, 1 line = 40u)
+  switch (src[*i]) {
+  case L'n':
+  case L'm':
+    val *= 24;
+    break;
+  case L'v':
+  case L'P':
+    val *= 40;
+    break;
+  case L'i':
+    val *= 240;
+    break;
+  case L'c':
+    val *= 240 / 2.54;
+    break;
+  case L'p':
+    val *= 240 / 72.0;
+    break;
+  case L'u':
+    break;
+  default:
+    val *= scale;
+    (*i)--;
+  }
+  (*i)++;
+
+  *dst = (int)(val < 0 ? val - 0.5 : val + 0.5);
+  return true;
+}
+
+// Helper of `roff_escape()`, `roff_cond()`, and `roff_macro()`. Evaluate the
+// numeric expression at `src[*i]` (strictly from left to right, as troff does),
+// and advance `*i` right after it. Place its value, in basic units, into `dst`.
+// `scale` is the number of basic units in numbers that lack a scaling unit.
+// Return false if the expression can't be evaluated.
+bool roff_expr(roff_t *st, const wchar_t *src, unsigned *i, double scale,
+               int *dst) {
+  int rhs; // right-hand side of current operation
+
+  if (!roff_term(st, src, i, scale, dst))
+    return false;
+
+  while (true) {
+    const wchar_t op = src[*i];        // operator
+    const wchar_t op2 = src[*i + 1];   // second character of operator
+    if (NULL == wcschr(L"+-*/%<>=&:", op) || L'\0' == op)
+      return true;
+    *i += ((L'<' == op || L'>' == op) && (L'=' == op2 || L'?' == op2)) ||
+                  (L'=' == op && L'=' == op2)
+              ? 2
+              : 1;
+    if (!roff_term(st, src, i, scale, &rhs))
+      return false;
+
+    switch (op) {
+    case L'+':
+      *dst += rhs;
+      break;
+    case L'-':
+      *dst -= rhs;
+      break;
+    case L'*':
+      *dst *= rhs;
+      break;
+    case L'/':
+    case L'%':
+      if (0 == rhs)
+        return false;
+      *dst = L'/' == op ? *dst / rhs : *dst % rhs;
+      break;
+    case L'<':
+      *dst = L'?' == op2   ? MIN(*dst, rhs)
+             : L'=' == op2 ? *dst <= rhs
+                           : *dst < rhs;
+      break;
+    case L'>':
+      *dst = L'?' == op2   ? MAX(*dst, rhs)
+             : L'=' == op2 ? *dst >= rhs
+                           : *dst > rhs;
+      break;
+    case L'=':
+      *dst = *dst == rhs;
+      break;
+    case L'&':
+      *dst = *dst > 0 && rhs > 0;
+      break;
+    case L':':
+      *dst = *dst > 0 || rhs > 0;
+      break;
+    }
+  }
+}
+
+void roff_text(roff_t *st, const wchar_t *src);
+
+// Helper of `roff_text()`. Interpret the escape sequence at `src[i]` (`i` being
+// the position right after the backslash), and return the position right after
+// it.
+unsigned roff_escape(roff_t *st, const wchar_t *src, unsigned i) {
+  wchar_t name[BS_SHORT]; // escape sequence argument
+  const wchar_t *value;   // replacement text
+  int num;                // numeric value
+  unsigned j;             // iterator
+
+  switch (src[i]) {
+  case L'\0':
+    // Escaped newline
+    st->cont = true;
+    return i;
+  case L'\\':
+  case L'e':
+  case L'E':
+    roff_char(st, L'\\');
+    return i + 1;
+  case L'-':
+    roff_char(st, L'-');
+    return i + 1;
+  case L'.':
+    roff_char(st, L'.');
+    return i + 1;
+  case L'\'':
+    roff_char(st, L'\'');
+    return i + 1;
+  case L'`':
+    roff_char(st, L'`');
+    return i + 1;
+  case L' ':
+  case L'~':
+  case L'0':
+    // Unbreakable space
+    roff_char(st, L' ');
+    return i + 1;
+  case L'&':
+  case L')':
+    // Zero-width characters that prevent end-of-sentence recognition
+    st->noeos = true;
+    return i + 1;
+  case L'|':
+  case L'^':
+  case L'%':
+  case L':':
+  case L',':
+  case L'/':
+  case L'!':
+    // Zero-width characters and hints
+    return i + 1;
+  case L'c':
+    // Continuation
+    st->cont = true;
+    return i + 1;
+  case L'{':
+  case L'}':
+    // Conditional block delimiters (see `roff_branch()`)
+    return i + 1;
+  case L'"':
+  case L'#':
+    // Comment
+    return wcslen(src);
+  case L'f':
+    // Font change
+    i = roff_name(name, src, i + 1);
+    if (0 == i) {
+      roff_fail(st);
+      return wcslen(src);
+    }
+    roff_font(st, name);
+    return i;
+  case L'(':
+  case L'[':
+    // Special character
+    j = roff_name(name, src, i);
+    if (0 == j) {
+      roff_fail(st);
+      return wcslen(src);
+    }
+    if (L'u' == name[0] && wcslen(name) >= 5 &&
+        wcsspn(&name[1], L"0123456789ABCDEFabcdef") == wcslen(name) - 1) {
+      roff_char(st, (wchar_t)wcstol(&name[1], NULL, 16));
+      return j;
+    }
+    value = roff_lookup(roff_specials, name);
+    if (NULL == value) {
+      roff_fail(st);
+      return j;
+    }
+    for (; L'\0' != *value; value++)
+      roff_char(st, *value);
+    return j;
+  case L'*':
+    // String interpolation
+    j = roff_name(name, src, i + 1);
+    if (0 == j || st->depth >= ROFF_DEPTH) {
+      roff_fail(st);
+      return wcslen(src);
+    }
+    value = roff_string(st, name);
+    if (NULL == value)
+      value = roff_lookup(roff_predefs, name);
+    if (NULL == value) {
+      roff_fail(st);
+      return j;
+    }
+    st->depth++;
+    roff_text(st, value);
+    st->depth--;
+    return j;
+  case L's':
+    // Point size change (ignored)
+    i++;
+    if (L'+' == src[i] || L'-' == src[i])
+      i++;
+    if (L'(' == src[i] || L'[' == src[i]) {
+      j = roff_name(name, src, i);
+      if (0 == j)
+        roff_fail(st);
+      return 0 == j ? wcslen(src) : j;
+    } else if (L'\'' == src[i]) {
+      for (i++; L'\0' != src[i] && L'\'' != src[i]; i++)
+        ;
+      return L'\0' == src[i] ? i : i + 1;
+    } else if (iswdigit(src[i])) {
+      if (src[i] >= L'1' && src[i] <= L'3' && iswdigit(src[i + 1]))
+        return i + 2;
+      return i + 1;
+    }
+    roff_fail(st);
+    return i;
+  case L'n':
+    // Number register interpolation
+    j = roff_name(name, src, i + 1);
+    if (0 == j || !roff_reg_get(st, name, &num)) {
+      roff_fail(st);
+      return wcslen(src);
+    }
+    swprintf(name, BS_SHORT, L"%d", num);
+    for (value = name; L'\0' != *value; value++)
+      roff_char(st, *value);
+    return j;
+  case L'h':
+    // Horizontal motion; only motions that can be emulated using spaces, or
+    // by adjusting the indentation of the next output line, are supported
+    j = i + 1;
+    if (L'\0' == src[j] || !roff_delim(name, src, &j) ||
+        !roff_expr(st, name, &(unsigned){0}, 24, &num)) {
+      roff_fail(st);
+      return wcslen(src);
+    }
+    num = num >= 0 ? (num + 12) / 24 : -((-num + 12) / 24);
+    if (num >= 0) {
+      for (; num > 0; num--)
+        roff_char(st, L' ');
+    } else if (0 == st->out_len && 0 == st->word_len) {
+      st->ti = MAX(0, (st->ti >= 0 ? st->ti : (int)st->indent) + num);
+    } else
+      roff_fail(st);
+    return j;
+  case L'u':
+  case L'd':
+    // Half-line vertical motions (ignored, as they are by grotty(1))
+    return i + 1;
+  case L'm':
+  case L'M':
+    // Color change (ignored)
+    j = roff_name(name, src, i + 1);
+    if (0 == j) {
+      roff_fail(st);
+      return wcslen(src);
+    }
+    return j;
+  }
+
+  // Anything else (motions, registers, width computations, etc.) is not
+  // supported
+  roff_fail(st);
+  return i + 1;
+}
+
+// Helper of `roff_line_end()`. Return true if the word being assembled ends a
+// sentence.
+bool roff_eos(const roff_t *st) {
+  int i = st->word_len - 1; // iterator
+
+  if (st->noeos)
+    return false;
+
+  while (i >= 0 && NULL != wcschr(L"\"')]*”’", st->word[i].c))
+    i--;
+
+  return i >= 0 && NULL != wcschr(L".?!", st->word[i].c);
+}
+
+// Helper of `roff_macro()` and `roff()`. Process text `src`, appending its
+// characters to the word being assembled, and placing words on the line being
+// filled whenever a space is encountered.
+void roff_text(roff_t *st, const wchar_t *src) {
+  unsigned i = 0; // iterator
+
+  while (st->ok && L'\0' != src[i]) {
+    if (L'\\' == src[i]) {
+      i = roff_escape(st, src, i + 1);
+    } else if (st->fill && (L' ' == src[i] || L'\t' == src[i])) {
+      roff_word(st);
+      st->spaces++;
+      i++;
+    } else if (L'\t' == src[i]) {
+      // No-fill mode tab; expand it
+      do
+        roff_char(st, L' ');
+      while (0 != st->word_len % 8);
+      i++;
+    } else {
+      roff_char(st, src[i]);
+      i++;
+    }
+  }
+}
+
+// Helper of `roff_macro()` and `roff()`. Handle the end of an input text line,
+// and spring any pending traps.
+void roff_line_end(roff_t *st) {
+  if (st->cont) {
+    st->cont = false;
+    return;
+  }
+
+  if (st->fill) {
+    const bool eos = roff_eos(st);
+    roff_word(st);
+    st->spaces = eos ? 2 : 1;
+  } else {
+    if (0 == st->out_len && 0 == st->word_len) {
+      // Empty line
+      st->nospace = false;
+      roff_put(st);
+    }
+    roff_break(st);
+  }
+
+  if (st->trap_font) {
+    st->trap_font = false;
+    st->font = RF_R;
+  }
+
+  if (st->trap_an) {
+    int flag; // value of `an-break-flag`
+    st->trap_an = false;
+    st->font = RF_R;
+    if (roff_reg_get(st, L"an-break-flag", &flag) && flag > 0) {
+      roff_break(st);
+      roff_reg_set(st, L"an-break-flag", 0);
+    }
+  }
+
+  if (st->trap_heading) {
+    st->trap_heading = false;
+    roff_break(st);
+    st->font = RF_R;
+    st->indent = st->margin;
+    st->nospace = true;
+  }
+
+  if (st->trap_tag) {
+    st->trap_tag = false;
+    if (st->out_len < st->indent) {
+      // Tag fits; continue with the paragraph body on the same line
+      roff_pad(st, st->indent);
+      st->spaces = 0;
+    } else
+      roff_break(st);
+  }
+}
+
+// Helper of `roff_macro()`. Evaluate numeric expression `src`, and place the
+// result (in characters, or in lines if `vert` is true) into `dst`. Return
+// false if `src` can't be evaluated.
+bool roff_num(roff_t *st, int *dst, const wchar_t *src, bool vert) {
+  const int unit = vert ? 40 : 24; // basic units per line or character
+  unsigned i = 0;                  // iterator
+  int res;                         // result, in basic units
+
+  if (!roff_expr(st, src, &i, unit, &res) || L'\0' != src[i])
+    return false;
+
+  *dst = res >= 0 ? (res + unit / 2) / unit : -((-res + unit / 2) / unit);
+  return true;
+}
+
+// Helper of `roff_macro()`. Parse a macro's arguments from `src`, splitting it
+// in place, and place pointers to them in `dst` (of length `ROFF_ARGS`). Return
+// the number of arguments.
+unsigned roff_args(wchar_t **dst, wchar_t *src) {
+  unsigned n = 0; // number of arguments
+  wchar_t *r = src, *w = src;
+
+  while (n < ROFF_ARGS) {
+    while (L' ' == *r || L'\t' == *r)
+      r++;
+    if (L'\0' == *r || (L'\\' == r[0] && L'"' == r[1]))
+      break;
+
+    bool quoted = L'"' == *r; // argument is quoted
+    if (quoted)
+      r++;
+    dst[n++] = w = r;
+
+    while (L'\0' != *r) {
+      if (L'\\' == r[0] && L'"' == r[1]) {
+        // Comment; discard the rest of the line
+        *w = L'\0';
+        return n;
+      } else if (L'\\' == r[0] && L'\0' != r[1]) {
+        *w++ = *r++;
+        *w++ = *r++;
+      } else if (quoted && L'"' == r[0]) {
+        if (L'"' == r[1]) {
+          *w++ = L'"';
+          r += 2;
+        } else {
+          r++;
+          break;
+        }
+      } else if (!quoted && (L' ' == *r || L'\t' == *r)) {
+        r++;
+        break;
+      } else
+        *w++ = *r++;
+    }
+    *w = L'\0';
+  }
+
+  return n;
+}
+
+// Helper of `roff_macro()`. Process `.TH` arguments `argv` (of length `argc`):
+// set up the page's footer, and output its header.
+void roff_th(roff_t *st, wchar_t **argv, unsigned argc) {
+  wchar_t title[BS_SHORT];  // page title
+  wchar_t manual[BS_SHORT]; // manual name (shown in the header)
+  wchar_t *arg;             // current argument
+  unsigned i, a;            // iterators
+  const roff_font_t font = st->font;
+  const bool fill = st->fill;
+
+  // Render the arguments as plain text, using `st->word` as scratch space
+  for (a = 0; a < 5; a++) {
+    wchar_t *dst = 0 == a   ? title
+                   : 1 == a ? st->th_id
+                   : 2 == a ? st->th_date
+                   : 3 == a ? st->th_source
+                            : manual;
+    dst[0] = L'\0';
+    if (a >= argc)
+      continue;
+    st->fill = false;
+    st->word_len = 0;
+    roff_text(st, argv[a]);
+    for (i = 0; i < st->word_len && i < BS_SHORT - 1; i++)
+      dst[i] = st->word[i].c;
+    dst[i] = L'\0';
+    st->word_len = 0;
+  }
+  st->fill = fill;
+  st->font = font;
+
+  // Default manual names, as used by groff
+  if (L'\0' == manual[0]) {
+    arg = L"";
+    switch (st->th_id[0]) {
+    case L'1':
+      arg = L"General Commands Manual";
+      break;
+    case L'2':
+      arg = L"System Calls Manual";
+      break;
+    case L'3':
+      arg = L"Library Functions Manual";
+      break;
+    case L'4':
+      arg = L"Kernel Interfaces Manual";
+      break;
+    case L'5':
+      arg = L"File Formats Manual";
+      break;
+    case L'6':
+      arg = L"Games Manual";
+      break;
+    case L'7':
+      arg = L"Miscellaneous Information Manual";
+      break;
+    case L'8':
+      arg = L"System Manager's Manual";
+      break;
+    case L'9':
+      arg = L"Kernel Developer's Manual";
+      break;
+    }
+    wcslcpy(manual, arg, BS_SHORT);
+  }
+
+  // `th_id` becomes `TITLE(SECTION)`
+  wchar_t section[BS_SHORT];
+  wcslcpy(section, st->th_id, BS_SHORT);
+  swprintf(st->th_id, BS_SHORT, L"%ls(%ls)", title, section);
+
+  // Header line
+  roff_flush(st, false);
+  const unsigned id_len = wcslen(st->th_id);
+  const unsigned manual_len = wcslen(manual);
+  for (i = 0; i < id_len; i++)
+    roff_out(st, st->th_id[i], RF_R);
+  roff_pad(st, MAX(id_len + 1, (st->width - manual_len) / 2));
+  for (i = 0; i < manual_len; i++)
+    roff_out(st, manual[i], RF_R);
+  roff_pad(st, MAX(st->out_len + 1, st->width - id_len));
+  for (i = 0; i < id_len; i++)
+    roff_out(st, st->th_id[i], RF_R);
+  roff_put(st);
+  roff_put(st);
+
+  st->th_seen = true;
+  st->nospace = true;
+}
+
+// Helper of `roff()`. Output the page's footer.
+void roff_footer(roff_t *st) {
+  const unsigned id_len = wcslen(st->th_id);
+  const unsigned date_len = wcslen(st->th_date);
+  const unsigned source_len = wcslen(st->th_source);
+  unsigned i; // iterator
+
+  // Discard trailing blank lines, and replace them with exactly one
+  while (st->ln > 2 &&
+         L'\0' == st->res[st->ln - 1]
+                      .text[wmargend(st->res[st->ln - 1].text, NULL)]) {
+    st->ln--;
+    line_free(st->res[st->ln]);
+  }
+  roff_put(st);
+
+  for (i = 0; i < source_len; i++)
+    roff_out(st, st->th_source[i], RF_R);
+  roff_pad(st, MAX(st->out_len + 1, (st->width - date_len) / 2));
+  for (i = 0; i < date_len; i++)
+    roff_out(st, st->th_date[i], RF_R);
+  roff_pad(st, MAX(st->out_len + 1, st->width - id_len));
+  for (i = 0; i < id_len; i++)
+    roff_out(st, st->th_id[i], RF_R);
+  roff_put(st);
+}
+
+// Helper of `roff_macro()`. Process the arguments of a font macro (e.g. `.B` or
+// `.BR`), alternating between fonts `f1` and `f2`. If `f1` is the same as
+// `f2`, separate the arguments with spaces.
+void roff_font_macro(roff_t *st, wchar_t **argv, unsigned argc, roff_font_t f1,
+                     roff_font_t f2) {
+  unsigned i; // iterator
+
+  if (0 == argc) {
+    if (f1 == f2) {
+      // Apply `f1` to the next text line
+      st->font = f1;
+      st->trap_font = true;
+    }
+    return;
+  }
+
+  for (i = 0; i < argc; i++) {
+    if (i > 0 && f1 == f2)
+      roff_text(st, L" ");
+    st->font = 0 == i % 2 ? f1 : f2;
+    roff_text(st, argv[i]);
+  }
+  st->font = RF_R;
+  roff_line_end(st);
+}
+
+// Helper of `roff_macro()`. Start a paragraph, section heading, or
+// sub-section heading.
+void roff_para(roff_t *st, unsigned blank) {
+  int flag; // value of `an-no-space-flag`
+
+  // DocBook sets man(7)'s `an-no-space-flag` to suppress the space before
+  // the paragraph that follows an inline heading
+  if (roff_reg_get(st, L"an-no-space-flag", &flag) && flag > 0)
+    roff_reg_set(st, L"an-no-space-flag", 0);
+  else
+    roff_blank(st, blank);
+  st->font = RF_R;
+  st->pi = ROFF_IN;
+  st->indent = st->margin;
+  st->ti = -1;
+}
+
+void roff_line(roff_t *st, wchar_t *src);
+
+// Helper of `roff_macro()` and `roff_line()`. Interpret `src` in copy mode
+// (i.e. replace each `\\` with `\`), in place.
+void roff_copy(wchar_t *src) {
+  wchar_t *r = src, *w = src;
+
+  while (L'\0' != *r) {
+    if (L'\\' == r[0] && L'\\' == r[1])
+      r++;
+    *w++ = *r++;
+  }
+  *w = L'\0';
+}
+
+// Helper of `roff_macro()` and `roff_cond()`. Return the user-defined macro
+// named `name`, or NULL if there's no such macro.
+roff_macro_t *roff_find(roff_t *st, const wchar_t *name) {
+  unsigned i; // iterator
+
+  for (i = 0; i < st->macros_len; i++)
+    if (0 == wcscmp(st->macros[i].name, name))
+      return &st->macros[i];
+
+  return NULL;
+}
+
+// Helper of `roff_branch()` and `roff_line()`. Return the number of
+// conditional blocks opened (`\{`) minus the number of conditional blocks
+// closed (`\}`) in `src`.
+int roff_braces(const wchar_t *src) {
+  int res = 0; // return value
+  unsigned i;  // iterator
+
+  for (i = 0; L'\0' != src[i]; i++)
+    if (L'\\' == src[i] && L'\0' != src[i + 1]) {
+      i++;
+      if (L'{' == src[i])
+        res++;
+      else if (L'}' == src[i])
+        res--;
+    }
+
+  return res;
+}
+
+// Helper of `roff_macro()`. Evaluate the condition of a `.if` or `.ie` request
+// that starts at `src[*i]`, and advance `*i` right after it. Return 1 if the
+// condition is true, 0 if it's false, or -1 if it can't be evaluated.
+int roff_cond(roff_t *st, const wchar_t *src, unsigned *i) {
+  wchar_t a[BS_SHORT], b[BS_SHORT]; // operands of string comparison
+  bool neg = false;                 // condition is negated
+  bool res;                         // condition outcome
+  wchar_t c;                        // condition type
+  int num;                          // numeric condition value
+  unsigned j = 0;                   // iterator
+
+  while (L'!' == src[*i]) {
+    neg = !neg;
+    (*i)++;
+  }
+
+  switch (src[*i]) {
+  case L'n':
+  case L'o':
+    // We're nroff, and we only ever output odd-numbered pages
+    res = true;
+    (*i)++;
+    break;
+  case L't':
+  case L'v':
+  case L'e':
+    res = false;
+    (*i)++;
+    break;
+  case L'r':
+  case L'd':
+    // Register, or string or macro, exists
+    c = src[(*i)++];
+    *i += wmargend(&src[*i], NULL);
+    while (L'\0' != src[*i] && L' ' != src[*i] && L'\t' != src[*i] &&
+           BS_SHORT - 1 > j)
+      a[j++] = src[(*i)++];
+    a[j] = L'\0';
+    res = L'r' == c ? roff_reg_get(st, a, &num)
+                    : NULL != roff_string(st, a) || NULL != roff_find(st, a);
+    break;
+  default:
+    if (L'\0' != src[*i] && NULL == wcschr(L"0123456789.+-(\\", src[*i])) {
+      // String comparison (`'a'b'`); escape sequences are not interpolated
+      if (!roff_delim(a, src, i))
+        return -1;
+      (*i)--;
+      if (!roff_delim(b, src, i) || NULL != wcschr(a, L'\\') ||
+          NULL != wcschr(b, L'\\'))
+        return -1;
+      res = 0 == wcscmp(a, b);
+    } else {
+      // Numeric expression
+      if (!roff_expr(st, src, i, 1, &num))
+        return -1;
+      res = num > 0;
+    }
+  }
+
+  return neg != res;
+}
+
+// Helper of `roff_macro()`. Process the body `src` of a `.if`, `.ie`, or `.el`
+// request whose condition evaluated to `cond`. If the body opens a conditional
+// block (`\{`) and `cond` is false, skip input lines until the block closes.
+void roff_branch(roff_t *st, wchar_t *src, bool cond) {
+  src += wmargend(src, NULL);
+
+  if (cond) {
+    if (L'\\' == src[0] && L'{' == src[1])
+      src += 2 + wmargend(&src[2], NULL);
+    if (L'\0' != src[0])
+      roff_line(st, src);
+  } else
+    st->skip = MAX(0, roff_braces(src));
+}
+
+// Helper of `roff_invoke()`. Copy macro body line `src` into `dst` (of length
+// `BS_LINE`), replacing argument references (`\$1`, `\$*`, etc.) with the
+// arguments `argv` (of length `argc`) of an invocation of macro `m`. Return
+// false if the result doesn't fit in `dst`, or if `src` contains an invalid
+// argument reference.
+bool roff_subst(wchar_t *dst, const wchar_t *src, const roff_macro_t *m,
+                wchar_t **argv, unsigned argc) {
+  wchar_t ref[BS_SHORT]; // argument reference
+  wchar_t *end;          // end of argument number in `ref`
+  unsigned i = 0, j = 0; // iterators
+  unsigned k;            // argument index
+
+#define push(c)                                                                \
+  if (BS_LINE - 1 == j)                                                        \
+    return false;                                                              \
+  dst[j++] = c;
+
+  while (L'\0' != src[i]) {
+    if (L'\\' != src[i] || L'$' != src[i + 1]) {
+      // Anything other than an argument reference; escape sequences are
+      // copied verbatim
+      if (L'\\' == src[i] && L'\0' != src[i + 1]) {
+        push(src[i]);
+        i++;
+      }
+      push(src[i]);
+      i++;
+      continue;
+    }
+
+    i = roff_name(ref, src, i + 2);
+    if (0 == i)
+      return false;
+    if (0 == wcscmp(ref, L"*") || 0 == wcscmp(ref, L"@")) {
+      // All arguments (`\$@` quotes each of them)
+      for (k = 0; k < argc; k++) {
+        if (k > 0) {
+          push(L' ');
+        }
+        if (L'@' == ref[0]) {
+          push(L'"');
+        }
+        for (end = argv[k]; L'\0' != *end; end++) {
+          push(*end);
+        }
+        if (L'@' == ref[0]) {
+          push(L'"');
+        }
+      }
+    } else {
+      // A single argument (`\$0` is the macro name)
+      k = wcstol(ref, &end, 10);
+      if (L'\0' != *end || end == ref)
+        return false;
+      for (end = 0 == k ? m->name : k <= argc ? argv[k - 1] : L"";
+           L'\0' != *end; end++) {
+        push(*end);
+      }
+    }
+  }
+  dst[j] = L'\0';
+
+#undef push
+
+  return true;
+}
+
+// Helper of `roff_macro()`. Invoke user-defined macro `m` with arguments `argv`
+// (of length `argc`).
+void roff_invoke(roff_t *st, const roff_macro_t *m, wchar_t **argv,
+                 unsigned argc) {
+  wchar_t line[BS_LINE]; // current body line, with arguments substituted
+  unsigned i;            // iterator
+
+  if (st->depth >= ROFF_DEPTH) {
+    roff_fail(st);
+    return;
+  }
+
+  st->depth++;
+  for (i = 0; st->ok && i < m->body_len; i++) {
+    if (!roff_subst(line, m->body[i], m, argv, argc)) {
+      roff_fail(st);
+      break;
+    }
+    roff_line(st, line);
+  }
+  st->depth--;
+}
+
+// Helper of `roff_macro()`. Remove the user-defined string or macro named
+// `name`, if it exists.
+void roff_remove(roff_t *st, const wchar_t *name) {
+  roff_macro_t *m = roff_find(st, name); // macro to remove
+  unsigned i;                            // iterator
+
+  for (i = 0; i < st->strings_len; i++)
+    if (0 == wcscmp(st->strings[i].name, name)) {
+      free(st->strings[i].name);
+      free(st->strings[i].value);
+      st->strings[i] = st->strings[--st->strings_len];
+      break;
+    }
+
+  if (NULL != m) {
+    if (st->depth > 0) {
+      // The macro might be executing
+      roff_fail(st);
+      return;
+    }
+    free(m->name);
+    for (i = 0; i < m->body_len; i++)
+      free(m->body[i]);
+    free(m->body);
+    *m = st->macros[--st->macros_len];
+  }
+}
+
+// Helper of `roff_macro()`. Copy the arguments `src` of a request or macro into
+// `dst` (of length `BS_LINE`), interpolating any number registers (`\n`) they
+// reference. Return false if a register doesn't exist, or if the result
+// doesn't fit in `dst`.
+bool roff_interp(roff_t *st, wchar_t *dst, const wchar_t *src) {
+  wchar_t name[BS_LINE];  // register name
+  wchar_t value[BS_SHORT]; // register value
+  unsigned i = 0, j = 0;  // iterators
+  unsigned k, depth;      // iterator and bracket nesting depth
+  int num;                // register value
+
+  while (L'\0' != src[i]) {
+    if (L'\\' != src[i] || L'n' != src[i + 1]) {
+      if (L'\\' == src[i] && L'\0' != src[i + 1]) {
+        if (BS_LINE - 1 == j)
+          return false;
+        dst[j++] = src[i++];
+      }
+      if (BS_LINE - 1 == j)
+        return false;
+      dst[j++] = src[i++];
+      continue;
+    }
+
+    i += 2;
+    if (L'[' == src[i]) {
+      // `\n[xxx]`, where `xxx` may itself reference registers
+      for (k = i + 1, depth = 1; L'\0' != src[k]; k++)
+        if (L'[' == src[k])
+          depth++;
+        else if (L']' == src[k] && 0 == --depth)
+          break;
+      if (L'\0' == src[k] || k - i >= BS_SHORT)
+        return false;
+      wcsncpy(value, &src[i + 1], k - i - 1);
+      value[k - i - 1] = L'\0';
+      if (!roff_interp(st, name, value))
+        return false;
+      i = k + 1;
+    } else {
+      i = roff_name(name, src, i);
+      if (0 == i)
+        return false;
+    }
+    if (!roff_reg_get(st, name, &num))
+      return false;
+
+    swprintf(value, BS_SHORT, L"%d", num);
+    for (k = 0; L'\0' != value[k]; k++) {
+      if (BS_LINE - 1 == j)
+        return false;
+      dst[j++] = value[k];
+    }
+  }
+  dst[j] = L'\0';
+
+  return true;
+}
+
+// Helper of `roff_macro()`. Read a single character argument of `.tr`, starting
+// at `src[i]`, into `dst`. Return the position right after it, or 0 if it's not
+// a single character.
+unsigned roff_tr_char(wchar_t *dst, const wchar_t *src, unsigned i) {
+  wchar_t name[BS_SHORT]; // special character name
+  const wchar_t *value;   // special character value
+
+  if (L'\\' != src[i]) {
+    *dst = src[i];
+    return i + 1;
+  }
+
+  i++;
+  if (L'-' == src[i] || L'e' == src[i]) {
+    *dst = L'-' == src[i] ? L'-' : L'\\';
+    return i + 1;
+  } else if (L'(' == src[i] || L'[' == src[i]) {
+    i = roff_name(name, src, i);
+    if (0 == i)
+      return 0;
+    // Special characters we don't know can't appear in the output, hence
+    // translating them is a no-op
+    value = roff_lookup(roff_specials, name);
+    if (NULL != value && L'\0' != value[0] && L'\0' != value[1])
+      return 0;
+    *dst = NULL == value ? L'\0' : value[0];
+    return i;
+  }
+
+  return 0;
+}
+
+// Helper of `roff_line()`. Process control line `src`.
+void roff_macro(roff_t *st, wchar_t *src) {
+  wchar_t name[BS_SHORT];   // macro name
+  wchar_t args[BS_LINE];    // macro arguments, with registers interpolated
+  wchar_t *argv[ROFF_ARGS]; // macro arguments
+  unsigned argc;            // number of arguments
+  roff_macro_t *m;          // user-defined macro
+  unsigned i = 1, j = 0;    // iterators
+  int num;                  // numeric argument
+  int cond;                 // condition outcome
+
+  // Macro name
+  while (L' ' == src[i] || L'\t' == src[i])
+    i++;
+  if (L'\0' == src[i])
+    return;
+  if (L'\\' == src[i] && (L'"' == src[i + 1] || L'#' == src[i + 1]))
+    return;
+  while (L'\0' != src[i] && L' ' != src[i] && L'\t' != src[i] &&
+         L'\\' != src[i]) {
+    if (BS_SHORT - 1 == j) {
+      roff_fail(st);
+      return;
+    }
+    name[j++] = src[i++];
+  }
+  name[j] = L'\0';
+  if (0 == j)
+    // E.g. `.\}`
+    return;
+
+#define is(m) (0 == wcscmp(name, m))
+#define num_arg(k, vert) (argc > k && roff_num(st, &num, argv[k], vert))
+
+  // Conditionals need the raw remainder of the line
+  if (is(L"if") || is(L"ie") || is(L"el")) {
+    i += wmargend(&src[i], NULL);
+    if (is(L"el")) {
+      cond = st->el;
+    } else {
+      cond = roff_cond(st, src, &i);
+      if (cond < 0) {
+        roff_fail(st);
+        return;
+      }
+      if (is(L"ie"))
+        st->el = !cond;
+    }
+    roff_branch(st, &src[i], cond);
+    return;
+  }
+
+  // `.ds` and `.as` need the raw remainder of the line as well
+  if (is(L"ds") || is(L"as")) {
+    wchar_t *sname = &src[i + wmargend(&src[i], NULL)]; // string name
+    wchar_t *svalue = sname;                            // string value
+    while (L'\0' != *svalue && L' ' != *svalue && L'\t' != *svalue)
+      svalue++;
+    if (L'\0' != *svalue)
+      *svalue++ = L'\0';
+    svalue += wmargend(svalue, NULL);
+    if (L'"' == *svalue)
+      svalue++;
+    if (L'\0' == *sname) {
+      roff_fail(st);
+      return;
+    }
+    const wchar_t *prev = roff_string(st, sname); // previous value
+    wchar_t *value = is(L"as") && NULL != prev
+                         ? walloc(wcslen(prev) + wcslen(svalue))
+                         : NULL; // new value
+    if (NULL != value) {
+      wcscpy(value, prev);
+      wcscat(value, svalue);
+    } else
+      value = xwcsdup(svalue);
+    roff_remove(st, sname);
+    if (ROFF_STRINGS == st->strings_len) {
+      free(value);
+      roff_fail(st);
+      return;
+    }
+    st->strings[st->strings_len].name = xwcsdup(sname);
+    st->strings[st->strings_len].value = value;
+    st->strings_len++;
+    return;
+  }
+
+  if (!roff_interp(st, args, &src[i])) {
+    roff_fail(st);
+    return;
+  }
+  argc = roff_args(argv, args);
+
+  // User-defined macros take precedence over built-in ones
+  m = roff_find(st, name);
+  if (NULL != m) {
+    for (j = 0; j < argc; j++)
+      roff_copy(argv[j]);
+    roff_invoke(st, m, argv, argc);
+    return;
+  }
+
+  if (is(L"TH")) {
+    if (st->th_seen || argc < 2) {
+      roff_fail(st);
+      return;
+    }
+    roff_th(st, argv, argc);
+  } else if (is(L"SH") || is(L"SS")) {
+    roff_para(st, 1);
+    st->margin = ROFF_IN;
+    st->rs_len = 0;
+    st->indent = is(L"SH") ? 0 : ROFF_SN;
+    st->font = RF_B;
+    st->trap_heading = true;
+    if (argc > 0) {
+      for (i = 0; i < argc; i++) {
+        if (i > 0)
+          roff_text(st, L" ");
+        roff_text(st, argv[i]);
+      }
+      roff_line_end(st);
+    }
+  } else if (is(L"PP") || is(L"P") || is(L"LP")) {
+    roff_para(st, st->pd);
+  } else if (is(L"TP") || is(L"IP") || is(L"HP")) {
+    const unsigned pi_arg = is(L"IP") ? 1 : 0; // index of indentation argument
+    const unsigned pi = st->pi;
+    roff_para(st, st->pd);
+    st->pi = pi;
+    if (num_arg(pi_arg, false))
+      st->pi = MAX(0, num);
+    else if (argc > pi_arg) {
+      roff_fail(st);
+      return;
+    }
+    st->indent = st->margin + st->pi;
+    if (is(L"TP")) {
+      st->ti = st->margin;
+      st->trap_tag = true;
+    } else if (is(L"HP")) {
+      st->ti = st->margin;
+    } else if (argc > 0 && L'\0' != argv[0][0]) {
+      st->ti = st->margin;
+      st->trap_tag = true;
+      roff_text(st, argv[0]);
+      roff_line_end(st);
+    }
+  } else if (is(L"TQ")) {
+    roff_break(st);
+    st->ti = st->margin;
+    st->trap_tag = true;
+  } else if (is(L"RS")) {
+    roff_break(st);
+    if (BS_SHORT == st->rs_len) {
+      roff_fail(st);
+      return;
+    }
+    st->rs_margin[st->rs_len] = st->margin;
+    st->rs_pi[st->rs_len] = st->pi;
+    st->rs_len++;
+    if (num_arg(0, false))
+      st->margin += MAX(0, num);
+    else
+      st->margin += st->pi;
+    st->pi = ROFF_IN;
+    st->indent = st->margin;
+  } else if (is(L"RE")) {
+    roff_break(st);
+    if (st->rs_len > 0) {
+      st->rs_len--;
+      st->margin = st->rs_margin[st->rs_len];
+      st->pi = st->rs_pi[st->rs_len];
+    }
+    st->indent = st->margin;
+  } else if (is(L"B")) {
+    roff_font_macro(st, argv, argc, RF_B, RF_B);
+  } else if (is(L"I")) {
+    roff_font_macro(st, argv, argc, RF_I, RF_I);
+  } else if (is(L"SM")) {
+    roff_font_macro(st, argv, argc, RF_R, RF_R);
+  } else if (is(L"SB")) {
+    roff_font_macro(st, argv, argc, RF_B, RF_B);
+  } else if (is(L"BI")) {
+    roff_font_macro(st, argv, argc, RF_B, RF_I);
+  } else if (is(L"BR")) {
+    roff_font_macro(st, argv, argc, RF_B, RF_R);
+  } else if (is(L"IB")) {
+    roff_font_macro(st, argv, argc, RF_I, RF_B);
+  } else if (is(L"IR")) {
+    roff_font_macro(st, argv, argc, RF_I, RF_R);
+  } else if (is(L"RB")) {
+    roff_font_macro(st, argv, argc, RF_R, RF_B);
+  } else if (is(L"RI")) {
+    roff_font_macro(st, argv, argc, RF_R, RF_I);
+  } else if (is(L"MR")) {
+    // Manual page reference: `page(section)trailer`
+    if (argc < 2) {
+      roff_fail(st);
+      return;
+    }
+    st->font = RF_I;
+    roff_text(st, argv[0]);
+    st->font = RF_R;
+    roff_text(st, L"(");
+    roff_text(st, argv[1]);
+    roff_text(st, L")");
+    if (argc > 2)
+      roff_text(st, argv[2]);
+    roff_line_end(st);
+  } else if (is(L"UR") || is(L"MT")) {
+    wcslcpy(st->url, argc > 0 ? argv[0] : L"", BS_LINE);
+  } else if (is(L"UE") || is(L"ME")) {
+    // Render the link target in angle brackets, so that it gets discovered
+    // by `man()` along with all other links
+    if (L'\0' != st->url[0]) {
+      roff_text(st, L"<");
+      roff_text(st, st->url);
+      roff_text(st, L">");
+      st->url[0] = L'\0';
+    }
+    if (argc > 0)
+      roff_text(st, argv[0]);
+    roff_line_end(st);
+  } else if (is(L"nf") || is(L"EX")) {
+    roff_break(st);
+    st->fill = false;
+  } else if (is(L"fi") || is(L"EE")) {
+    roff_break(st);
+    st->fill = true;
+  } else if (is(L"br")) {
+    roff_break(st);
+  } else if (is(L"sp")) {
+    if (0 == argc)
+      roff_blank(st, 1);
+    else if (num_arg(0, true) && num >= 0)
+      roff_blank(st, num);
+    else
+      roff_fail(st);
+  } else if (is(L"PD")) {
+    if (0 == argc)
+      st->pd = 1;
+    else if (num_arg(0, true) && num >= 0)
+      st->pd = num;
+    else
+      roff_fail(st);
+  } else if (is(L"in") || is(L"ti")) {
+    roff_break(st);
+    if (0 == argc) {
+      if (is(L"in")) {
+        // Restore previous indentation
+        const unsigned tmp = st->indent;
+        st->indent = st->indent_prev;
+        st->indent_prev = tmp;
+      }
+      return;
+    }
+    if (!roff_num(st, &num, argv[0], false)) {
+      roff_fail(st);
+      return;
+    }
+    if (L'+' == argv[0][0] || L'-' == argv[0][0])
+      num += st->indent;
+    if (is(L"in")) {
+      st->indent_prev = st->indent;
+      st->indent = MAX(0, num);
+    } else
+      st->ti = MAX(0, num);
+  } else if (is(L"ad")) {
+    st->adjust = 0 == argc || NULL != wcschr(L"bBnN", argv[0][0]);
+  } else if (is(L"na")) {
+    st->adjust = false;
+  } else if (is(L"ft")) {
+    roff_font(st, argc > 0 ? argv[0] : L"P");
+  } else if (is(L"ns")) {
+    st->nospace = true;
+  } else if (is(L"rs")) {
+    st->nospace = false;
+  } else if (is(L"bp")) {
+    roff_break(st);
+  } else if (is(L"de") || is(L"de1") || is(L"am")) {
+    if (argc < 1) {
+      roff_fail(st);
+      return;
+    }
+    m = roff_find(st, argv[0]);
+    if (NULL != m && !is(L"am"))
+      roff_remove(st, argv[0]);
+    if (NULL == m || !is(L"am")) {
+      if (ROFF_MACROS == st->macros_len) {
+        roff_fail(st);
+        return;
+      }
+      m = &st->macros[st->macros_len++];
+      m->name = xwcsdup(argv[0]);
+      m->body_size = BS_SHORT;
+      m->body = aalloc(m->body_size, wchar_t *);
+      m->body_len = 0;
+    }
+    st->def = m;
+    wcslcpy(st->def_end, argc > 1 ? argv[1] : L".", BS_SHORT);
+  } else if (is(L"ig")) {
+    st->ig = true;
+    wcslcpy(st->def_end, argc > 0 ? argv[0] : L".", BS_SHORT);
+  } else if (is(L"tr")) {
+    for (i = 0; argc > 0 && L'\0' != argv[0][i];) {
+      if (BS_SHORT == st->tr_len ||
+          0 == (i = roff_tr_char(&st->tr_from[st->tr_len], argv[0], i))) {
+        roff_fail(st);
+        return;
+      }
+      if (L'\0' == argv[0][i])
+        st->tr_to[st->tr_len] = L' ';
+      else if (0 == (i = roff_tr_char(&st->tr_to[st->tr_len], argv[0], i))) {
+        roff_fail(st);
+        return;
+      }
+      st->tr_len++;
+    }
+  } else if (is(L"it") && 2 == argc && 0 == wcscmp(argv[1], L"an-trap")) {
+    // DocBook's inline headings
+    st->trap_an = true;
+  } else if (is(L"rm")) {
+    for (i = 0; i < argc; i++)
+      roff_remove(st, argv[i]);
+  } else if (is(L"nr")) {
+    // Increment or decrement if the value has a sign
+    const bool incr = argc > 1 && (L'+' == argv[1][0] || L'-' == argv[1][0]);
+    i = incr ? 1 : 0;
+    if (argc < 2 || !roff_expr(st, argv[1], &i, 1, &num) ||
+        L'\0' != argv[1][i]) {
+      roff_fail(st);
+      return;
+    }
+    if (incr) {
+      int prev = 0; // previous value
+      roff_reg_get(st, argv[0], &prev);
+      num = L'+' == argv[1][0] ? prev + num : prev - num;
+    }
+    roff_reg_set(st, argv[0], num);
+  } else if (is(L"rr")) {
+    for (i = 0; i < argc; i++)
+      for (j = 0; j < st->registers_len; j++)
+        if (0 == wcscmp(st->registers[j].name, argv[i])) {
+          free(st->registers[j].name);
+          st->registers[j] = st->registers[--st->registers_len];
+          break;
+        }
+  } else if (is(L"hy") || is(L"nh") || is(L"ne") || is(L"IX") ||
+             is(L"ss") || is(L"cs") || is(L"lf") || is(L"ps") ||
+             is(L"vs") || is(L"ll") || is(L"hw") || is(L"DT") ||
+             is(L"UC") || is(L"AT") || is(L"PU") || is(L"LINKSTYLE") ||
+             is(L"tm") || is(L"warn")) {
+    // Harmless requests and macros with no effect on terminal output
+  } else {
+    // Everything else (tables, diversions, traps, mdoc(7) macros, etc.) is
+    // not supported
+    roff_fail(st);
+  }
+
+#undef is
+#undef num_arg
+}
+
+// Helper of `roff()`, `roff_branch()`, and `roff_invoke()`. Process input line
+// `src`.
+void roff_line(roff_t *st, wchar_t *src) {
+  unsigned i; // iterator
+
+  if (st->skip > 0) {
+    // Inside a skipped conditional block
+    st->skip = MAX(0, (int)st->skip + roff_braces(src));
+    return;
+  }
+
+  if (NULL != st->def || st->ig) {
+    // Inside a macro definition or an `.ig` block
+    if (L'.' == src[0] &&
+        0 == wcscmp(&src[1 + wmargend(&src[1], NULL)], st->def_end)) {
+      st->def = NULL;
+      st->ig = false;
+    } else if (NULL != st->def) {
+      roff_macro_t *m = st->def;
+      if (m->body_len == m->body_size) {
+        m->body_size *= 2;
+        m->body = xreallocarray(m->body, m->body_size, sizeof(wchar_t *));
+      }
+      m->body[m->body_len] = xwcsdup(src);
+      roff_copy(m->body[m->body_len++]);
+    }
+    return;
+  }
+
+  if (L'.' == src[0] || L'\'' == src[0]) {
+    roff_macro(st, src);
+    return;
+  }
+
+  // A line that consists only of conditional block ends produces no output
+  for (i = 0; L'\\' == src[i] && L'}' == src[i + 1]; i += 2)
+    ;
+  if (i > 0 && L'\0' == src[i + wmargend(&src[i], NULL)])
+    return;
+
+  if (st->fill && L'\0' == src[0]) {
+    // Blank line
+    roff_blank(st, 1);
+  } else {
+    if (st->fill && (L' ' == src[0] || L'\t' == src[0])) {
+      // Leading whitespace causes a break, and indents the next line
+      roff_break(st);
+      i = wmargend(src, NULL);
+      st->ti = st->indent + i;
+      roff_text(st, &src[i]);
+    } else
+      roff_text(st, src);
+    roff_line_end(st);
+  }
+}
+
+//
+// Functions
+//
+
+unsigned roff(line_t **dst, const char *path, unsigned width,
+              unsigned lmargin) {
+  char tmp[BS_LINE];      // current input line (NUL-terminated)
+  wchar_t gline[BS_LINE]; // current input line (decoded)
+  const char *line;       // current input line (as returned by `arline()`)
+  size_t line_len;        // length of `line`
+  int glen = 0;           // length of `gline`
+  unsigned i, j;          // iterators
+
+  roff_t *st = xcalloc(1, sizeof(roff_t));
+  st->ok = true;
+  st->width = width;
+  st->lmargin = lmargin;
+  st->res_len = BS_LINE;
+  st->res = aalloc(st->res_len, line_t);
+  st->out_size = BS_LINE;
+  st->out = aalloc(st->out_size, roff_char_t);
+  st->gaps = aalloc(st->out_size, unsigned);
+  st->margin = ROFF_IN;
+  st->pi = ROFF_IN;
+  st->indent = ROFF_IN;
+  st->indent_prev = ROFF_IN;
+  st->ti = -1;
+  st->fill = true;
+  st->adjust = config.capabilities.justify;
+  st->pd = 1;
+
+  archive_t gp = aropen(path);
+
+  while (st->ok && 0 != (line_len = arline(&gp, &line))) {
+    // Decode the line, appending it to `gline` if the previous one ended in
+    // an escaped newline
+    if (line_len >= BS_LINE) {
+      roff_fail(st);
+      break;
+    }
+    memcpy(tmp, line, line_len);
+    tmp[line_len] = '\0';
+    if (line_len > 0 && '\n' == tmp[line_len - 1])
+      tmp[line_len - 1] = '\0';
+    const size_t len = mbstowcs(&gline[glen], tmp, BS_LINE - glen);
+    if ((size_t)-1 == len || BS_LINE - glen == len) {
+      roff_fail(st);
+      break;
+    }
+    glen += len;
+    if (glen > 0 && L'\\' == gline[glen - 1] && !wescaped(gline, glen - 1)) {
+      gline[--glen] = L'\0';
+      continue;
+    }
+    glen = 0;
+
+    roff_line(st, gline);
+  }
+
+  arclose(&gp);
+
+  if (st->ok && st->th_seen) {
+    roff_break(st);
+    roff_footer(st);
+  }
+
+  const bool ok = st->ok && st->th_seen;
+  const unsigned ln = st->ln;
+  if (ok)
+    *dst = st->res;
+  else
+    lines_free(st->res, st->ln);
+  for (i = 0; i < st->strings_len; i++) {
+    free(st->strings[i].name);
+    free(st->strings[i].value);
+  }
+  for (i = 0; i < st->registers_len; i++)
+    free(st->registers[i].name);
+  for (i = 0; i < st->macros_len; i++) {
+    free(st->macros[i].name);
+    for (j = 0; j < st->macros[i].body_len; j++)
+      free(st->macros[i].body[j]);
+    free(st->macros[i].body);
+  }
+  free(st->out);
+  free(st->gaps);
+  free(st);
+
+  return ok ? ln : 0;
+}
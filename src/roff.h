@@ -0,0 +1,163 @@
+// Built-in man(7) formatter (definition)
+
+#ifndef ROFF_H
+
+#define ROFF_H
+
+#include "lib.h"
+
+//
+// Constants
+//
+
+// Default indentation of body text, as well as of tagged paragraph bodies
+#define ROFF_IN 7
+
+// Indentation of sub-section headings
+#define ROFF_SN 3
+
+// Maximum number of macro arguments
+#define ROFF_ARGS 16
+
+// Maximum number of user-defined strings, number registers, and macros
+#define ROFF_STRINGS 64
+#define ROFF_REGISTERS 64
+#define ROFF_MACROS 64
+
+// Maximum nesting depth of string interpolations and macro invocations
+#define ROFF_DEPTH 16
+
+//
+// Types
+//
+
+// Font
+typedef enum {
+  RF_R, // roman (regular)
+  RF_B, // bold
+  RF_I, // italic (rendered as underline, like grotty(1) does)
+  RF_BI // bold italic (rendered as bold)
+} roff_font_t;
+
+// A formatted character
+typedef struct {
+  wchar_t c;        // the character
+  roff_font_t font; // its font
+} roff_char_t;
+
+// A special character, or predefined string, and its replacement text
+typedef struct {
+  wchar_t *name;  // name (e.g. `em` for `\(em`)
+  wchar_t *value; // replacement text (e.g. `—`)
+} roff_special_t;
+
+// A number register (`.nr`)
+typedef struct {
+  wchar_t *name; // name
+  int value;     // value
+} roff_register_t;
+
+// A user-defined macro (`.de`)
+typedef struct {
+  wchar_t *name;      // name
+  wchar_t **body;     // body lines
+  unsigned body_len;  // number of body lines
+  unsigned body_size; // allocated length of `body`
+} roff_macro_t;
+
+// Formatter state
+typedef struct {
+  bool ok;          // false once an unsupported construct has been encountered
+  unsigned width;   // width of the text area
+  unsigned lmargin; // number of spaces prepended to each output line
+  // Output lines
+  line_t *res;      // output buffer
+  unsigned res_len; // output buffer length
+  unsigned ln;      // number of lines in `res`
+  // Output line being filled
+  roff_char_t *out;  // its characters
+  unsigned out_len;  // its length
+  unsigned out_size; // allocated length of `out`
+  unsigned *gaps;    // inter-word gap positions in `out` (for justification)
+  unsigned gaps_len; // number of gaps
+  bool jdir;         // direction of extra space distribution when justifying
+  // Word being assembled
+  roff_char_t word[BS_LINE]; // its characters
+  unsigned word_len;         // its length
+  unsigned spaces;           // number of spaces to place before it
+  bool noeos;                // `\&` was seen after its last character
+  bool cont;                 // `\c` was seen; next input line continues it
+  // Layout
+  unsigned margin;               // left margin (moved by `.RS`/`.RE`)
+  unsigned pi;                   // prevailing indentation of tagged paragraphs
+  unsigned indent;               // current indentation
+  unsigned indent_prev;          // previous indentation (for `.in`)
+  int ti;                        // indentation of next output line, or -1
+  unsigned rs_margin[BS_SHORT];  // saved values of `margin` (for `.RS`)
+  unsigned rs_pi[BS_SHORT];      // saved values of `pi` (for `.RS`)
+  unsigned rs_len;               // number of saved values
+  bool fill;                     // fill mode is on
+  bool adjust;                   // justification is on
+  bool nospace;                  // no-space mode is on
+  unsigned pd;                   // number of lines between paragraphs
+  roff_font_t font, font_prev;   // current and previous font
+  // Traps (pending actions to be taken after the next text line)
+  bool trap_font;    // restore font to `RF_R`
+  bool trap_heading; // end a section or sub-section heading
+  bool trap_tag;     // end the tag of a tagged paragraph
+  bool trap_an;      // invoke man(7)'s `an-trap` (set up by `.it`)
+  // `.UR`/`.MT` target, or empty string
+  wchar_t url[BS_LINE];
+  // `.TH` data
+  bool th_seen;            // `.TH` has been seen
+  wchar_t th_id[BS_SHORT]; // page title and section (e.g. `LS(1)`)
+  wchar_t th_date[BS_SHORT];
+  wchar_t th_source[BS_SHORT];
+  // User-defined strings (`.ds`), number registers (`.nr`), and macros
+  // (`.de`)
+  roff_special_t strings[ROFF_STRINGS];
+  unsigned strings_len;
+  roff_register_t registers[ROFF_REGISTERS];
+  unsigned registers_len;
+  roff_macro_t macros[ROFF_MACROS];
+  unsigned macros_len;
+  unsigned depth; // string interpolation and macro invocation depth
+  // Character translations (`.tr`)
+  wchar_t tr_from[BS_SHORT];
+  wchar_t tr_to[BS_SHORT];
+  unsigned tr_len;
+  // Input state
+  roff_macro_t *def;         // macro being defined, or NULL
+  wchar_t def_end[BS_SHORT]; // line that ends the definition or `.ig` block
+  bool ig;                   // inside an `.ig` block
+  unsigned skip;             // nesting depth of skipped conditional block
+  bool el;                   // the next `.el` branch is to be taken
+} roff_t;
+
+//
+// Global variables
+//
+
+// Special characters (`\(xx` and `\[xxx]`), terminated by a `{NULL, NULL}`
+// entry
+extern roff_special_t roff_specials[];
+
+// Predefined strings (`\*x`, `\*(xx`, and `\*[xxx]`), terminated by a
+// `{NULL, NULL}` entry
+extern roff_special_t roff_predefs[];
+
+//
+// Functions
+//
+
+// Format the man(7) source file at `path` into `dst`, rendering it as the
+// external pipeline (`man` and `groff`) would: a header line, the page's body,
+// and a footer line. `width` is the width of the text area, and `lmargin` the
+// number of spaces to prepend to each line. Return the number of lines in
+// `dst`. If the source uses any construct that the formatter doesn't support
+// (e.g. tables, motions, or mdoc(7) macros), return 0 and leave `dst`
+// untouched; the caller is expected to fall back to the external pipeline.
+extern unsigned roff(line_t **dst, const char *path, unsigned width,
+                     unsigned lmargin);
+
+#endif
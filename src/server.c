@@ -0,0 +1,417 @@
+// Resident server mode (implementation)
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // for `struct ucred`
+#endif
+
+#include "lib.h"
+
+//
+// Global variables
+//
+
+server_page_t server_cache[SERVER_CACHE];
+
+unsigned server_cache_next = 0;
+
+time_t server_cache_time = 0;
+
+//
+// Helper macros and functions
+//
+
+// Helper of `page_read()`. If `cond` holds, free the lines read so far, and
+// make `page_read()` return false.
+#define page_fail_if(cond)                                                     \
+  if (cond) {                                                                  \
+    lines_free(res, res_len);                                                  \
+    return false;                                                              \
+  }
+
+// Helper of `page_read()`. Read `nmemb` items of size `size` from `fp` into
+// `ptr`, and fail if the data is truncated (or can't be read).
+#define page_get(ptr, size, nmemb)                                             \
+  page_fail_if(nmemb != fread(ptr, size, nmemb, fp))
+
+// Helper of `server_fetch()` and `server_serve()`. Write all `len` bytes of
+// `buf` to file descriptor `fd`. Return false on failure.
+bool fd_write(int fd, const void *buf, size_t len) {
+  const char *p = buf; // current position in `buf`
+
+  while (len > 0) {
+    const ssize_t cnt = write(fd, p, len);
+    if (-1 == cnt) {
+      if (EINTR == errno)
+        continue;
+      return false;
+    }
+    p += cnt;
+    len -= cnt;
+  }
+
+  return true;
+}
+
+// Helper of `server()`. Read exactly `len` bytes from file descriptor `fd` into
+// `buf`. Return false on failure, or if fewer bytes are available.
+bool fd_read(int fd, void *buf, size_t len) {
+  char *p = buf; // current position in `buf`
+
+  while (len > 0) {
+    const ssize_t cnt = read(fd, p, len);
+    if (-1 == cnt && EINTR == errno)
+      continue;
+    if (cnt <= 0)
+      return false;
+    p += cnt;
+    len -= cnt;
+  }
+
+  return true;
+}
+
+// Helper of `server_fetch()` and `server()`. Place the path of the directory
+// that holds the current user's server socket into `dst` (of length `dst_len`).
+void server_dir(char *dst, unsigned dst_len) {
+  const char *dir = getenv("XDG_RUNTIME_DIR");
+
+  if (NULL != dir && '\0' != dir[0])
+    snprintf(dst, dst_len, "%s/qman", dir);
+  else
+    snprintf(dst, dst_len, "/tmp/qman-%u", (unsigned)getuid());
+}
+
+// Helper of `server_fetch()` and `server()`. Return true if `server_dir()` is a
+// directory (and not a symbolic link) that belongs to the current user, and
+// that nobody else can access. If `create`, create it first, if it doesn't
+// exist.
+bool server_dir_ok(bool create) {
+  char dir[BS_LINE]; // `server_dir()`
+  struct stat st;    // its status
+
+  server_dir(dir, BS_LINE);
+  if (create && -1 == mkdir(dir, S_IRWXU) && EEXIST != errno)
+    return false;
+
+  return 0 == lstat(dir, &st) && S_ISDIR(st.st_mode) &&
+         st.st_uid == getuid() && 0 == (st.st_mode & (S_IRWXG | S_IRWXO));
+}
+
+// Helper of `server_fetch()` and `server()`. Return true if the process on the
+// other end of the socket `fd` runs as the current user.
+bool peer_ok(int fd) {
+#if defined(__linux__)
+  struct ucred cred;                   // peer credentials
+  socklen_t cred_len = sizeof(cred);   // length of `cred`
+  return 0 == getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) &&
+         cred.uid == getuid();
+#else
+  uid_t uid; // peer user ID
+  gid_t gid; // peer group ID
+  return 0 == getpeereid(fd, &uid, &gid) && uid == getuid();
+#endif
+}
+
+// Helper of `server_fetch()` and `server()`. Place a socket address for
+// `server_path()` into `dst`. Return false if that path doesn't fit in a
+// socket address.
+bool server_addr(struct sockaddr_un *dst) {
+  memset(dst, 0, sizeof(*dst));
+  dst->sun_family = AF_UNIX;
+
+  return server_path(dst->sun_path, sizeof(dst->sun_path));
+}
+
+// Helper of `server_serve()`. If `SERVER_TTL` seconds have passed since
+// `server_cache_time`, empty `server_cache`, and perform `late_init()` again.
+void server_expire() {
+  const time_t now = time(NULL); // current time
+  unsigned i;                    // iterator
+
+  if (now - server_cache_time < SERVER_TTL)
+    return;
+
+  for (i = 0; i < SERVER_CACHE; i++) {
+    free(server_cache[i].data);
+    server_cache[i].data = NULL;
+  }
+  server_cache_next = 0;
+  late_init();
+  aw_last_keep(RT_NONE, NULL, NULL, 0);
+  server_cache_time = now;
+}
+
+// Helper of `server()`. Serve request `req` to the client connected to `fd`:
+// render the requested page (or fetch it from the cache), and send it back,
+// preceded by its `err` flag. If the page can't be rendered, send `err_msg`
+// instead of the page. If the client's configuration differs from the
+// server's, hang up without replying, so that it renders the page itself.
+void server_serve(int fd, const server_request_t *req) {
+  server_page_t *cp = NULL; // cache entry for `req`
+  char desc[4 * BS_LINE];   // server's configuration description
+  unsigned i;               // iterator
+
+  conf_index_desc(desc, 4 * BS_LINE);
+  if (0 != strcmp(desc, req->index_desc))
+    return;
+  conf_page_desc(desc, 4 * BS_LINE);
+  if (0 != strcmp(desc, req->page_desc))
+    return;
+
+  server_expire();
+  for (i = 0; i < SERVER_CACHE; i++)
+    if (NULL != server_cache[i].data &&
+        0 == memcmp(&server_cache[i].req, req, sizeof(server_request_t))) {
+      cp = &server_cache[i];
+      break;
+    }
+
+  if (NULL == cp) {
+    // Render the page, as the client would have
+    config.layout.main_width = req->width;
+    config.misc.global_apropos = req->global_apropos;
+    config.misc.global_whatis = req->global_whatis;
+    history_replace(req->request_type,
+                    L'\0' == req->args[0] ? NULL : req->args);
+    populate_page();
+
+    if (err) {
+      fd_write(fd, &err, sizeof(bool));
+      fd_write(fd, err_msg, sizeof(err_msg));
+      return;
+    }
+
+    // Serialize it into a cache entry, replacing the oldest one
+    cp = &server_cache[server_cache_next];
+    server_cache_next = (server_cache_next + 1) % SERVER_CACHE;
+    if (NULL != cp->data)
+      free(cp->data);
+    cp->req = *req;
+    FILE *ms = open_memstream(&cp->data, &cp->data_len);
+    if (NULL == ms)
+      winddown(ES_OPER_ERROR, L"Unable to open_memstream()");
+    page_write(ms, page, page_len);
+    fclose(ms);
+  }
+
+  const bool ok = false; // value of `err` sent to the client
+  if (fd_write(fd, &ok, sizeof(bool)))
+    fd_write(fd, cp->data, cp->data_len);
+}
+
+//
+// Functions (generic)
+//
+
+bool server_path(char *dst, unsigned dst_len) {
+  char dir[BS_LINE]; // `server_dir()`
+
+  server_dir(dir, BS_LINE);
+  const int len = snprintf(dst, dst_len, "%s/qman.sock", dir);
+
+  return len >= 0 && (unsigned)len < dst_len;
+}
+
+void page_write(FILE *fp, const line_t *lines, unsigned lines_len) {
+  unsigned ln, l; // line and link iterators
+  unsigned len;   // length of current link target
+
+  xfwrite(&lines_len, sizeof(unsigned), 1, fp);
+  for (ln = 0; ln < lines_len; ln++) {
+    const line_t *line = line_at(lines, ln);
+    const unsigned ba_len =
+        line->length % 8 == 0 ? line->length / 8 : 1 + line->length / 8;
+    xfwrite(&line->length, sizeof(unsigned), 1, fp);
+    xfwrite(line->text, sizeof(wchar_t), line->length + 1, fp);
+    if (line->length > 0) {
+      xfwrite(line->reg, 1, ba_len, fp);
+      xfwrite(line->bold, 1, ba_len, fp);
+      xfwrite(line->italic, 1, ba_len, fp);
+      xfwrite(line->uline, 1, ba_len, fp);
+    }
+    xfwrite(&line->links_length, sizeof(unsigned), 1, fp);
+    for (l = 0; l < line->links_length; l++) {
+      // `trgt` is sent separately, and the pointer itself is ignored by
+      // `page_read()`
+      len = wcslen(line->links[l].trgt);
+      xfwrite(&line->links[l], sizeof(link_t), 1, fp);
+      xfwrite(&len, sizeof(unsigned), 1, fp);
+      xfwrite(line->links[l].trgt, sizeof(wchar_t), len + 1, fp);
+    }
+  }
+}
+
+bool page_read(line_t **dst, unsigned *dst_len, FILE *fp) {
+  unsigned ln, l;       // line and link iterators
+  unsigned len;         // line length, or link target length
+  unsigned links_len;   // number of links in line
+  link_t link;          // current link
+  unsigned res_len = 0; // number of lines
+
+  if (1 != fread(&res_len, sizeof(unsigned), 1, fp) || res_len > PAGE_MAX_LINES)
+    return false;
+  line_t *res = aalloc(res_len, line_t); // result
+
+  // (Lines and links that haven't been read yet are zeroed by `aalloc()`, and
+  // anything that points to memory is read into a temporary first, so that
+  // `page_fail_if()` can free `res` at any point)
+  for (ln = 0; ln < res_len; ln++) {
+    page_get(&len, sizeof(unsigned), 1);
+    page_fail_if(len > PAGE_MAX_WIDTH);
+    line_alloc(res[ln], len);
+    const unsigned ba_len = len % 8 == 0 ? len / 8 : 1 + len / 8;
+    page_get(res[ln].text, sizeof(wchar_t), len + 1);
+    res[ln].text[len] = L'\0';
+    if (len > 0) {
+      page_get(res[ln].reg, 1, ba_len);
+      page_get(res[ln].bold, 1, ba_len);
+      page_get(res[ln].italic, 1, ba_len);
+      page_get(res[ln].uline, 1, ba_len);
+    }
+    page_get(&links_len, sizeof(unsigned), 1);
+    page_fail_if(links_len > len); // links can't be empty, or overlap
+    res[ln].links = aalloc(links_len, link_t);
+    res[ln].links_length = links_len;
+    for (l = 0; l < links_len; l++) {
+      page_get(&link, sizeof(link_t), 1);
+      res[ln].links[l] = link;
+      res[ln].links[l].trgt = NULL;
+      page_fail_if(link.start > link.end || link.end > res[ln].length ||
+                   (unsigned)link.type > LT_LS ||
+                   (link.in_next && (link.start_next > link.end_next ||
+                                     link.end_next > PAGE_MAX_WIDTH)));
+      page_get(&len, sizeof(unsigned), 1);
+      page_fail_if(len >= BS_LINE);
+      res[ln].links[l].trgt = walloc(len);
+      page_get(res[ln].links[l].trgt, sizeof(wchar_t), len + 1);
+      res[ln].links[l].trgt[len] = L'\0';
+    }
+  }
+
+  *dst = res;
+  *dst_len = res_len;
+  return true;
+}
+
+bool server_fetch() {
+  server_request_t req;     // request
+  bool res_err;             // value of `err` returned by the server
+  wchar_t res_msg[BS_LINE]; // value of `err_msg` returned by the server
+
+  // Local files are looked up relative to the client's working directory
+  if (RT_MAN_LOCAL == history[history_cur].request_type)
+    return false;
+
+  // Only talk to a server that runs as the current user, from a socket nobody
+  // else could have planted
+  struct sockaddr_un addr; // server socket address
+  if (!server_dir_ok(false) || !server_addr(&addr))
+    return false;
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (-1 == fd)
+    return false;
+  if (-1 == connect(fd, (const struct sockaddr *)&addr, sizeof(addr)) ||
+      !peer_ok(fd)) {
+    close(fd);
+    return false;
+  }
+
+  memset(&req, 0, sizeof(req));
+  req.request_type = history[history_cur].request_type;
+  req.width = config.layout.main_width;
+  req.global_apropos = config.misc.global_apropos;
+  req.global_whatis = config.misc.global_whatis;
+  if (NULL != history[history_cur].args)
+    wcslcpy(req.args, history[history_cur].args, BS_LINE);
+  conf_index_desc(req.index_desc, 4 * BS_LINE);
+  conf_page_desc(req.page_desc, 4 * BS_LINE);
+  if (!fd_write(fd, &req, sizeof(req))) {
+    close(fd);
+    return false;
+  }
+
+  FILE *fp = fdopen(fd, "r");
+  if (NULL == fp) {
+    close(fd);
+    return false;
+  }
+  // If the server goes away before it's done answering, give up on it, and
+  // let the caller render the page locally
+  bool ok = 1 == fread(&res_err, sizeof(bool), 1, fp); // reply is complete
+  if (ok && res_err) {
+    ok = 1 == fread(res_msg, sizeof(res_msg), 1, fp);
+    res_msg[BS_LINE - 1] = L'\0';
+  } else if (ok)
+    ok = page_read(&page, &page_len, fp);
+  fclose(fp);
+  if (ok) {
+    err = res_err;
+    if (err)
+      wcslcpy(err_msg, res_msg, BS_LINE);
+  }
+
+  return ok;
+}
+
+//
+// Functions (handlers)
+//
+
+void server() {
+  configure();
+  late_init();
+  server_cache_time = time(NULL);
+
+  // Listen on the server socket, replacing any stale socket left behind by a
+  // previous server; the socket lives in a directory that only the current
+  // user can access
+  if (!server_dir_ok(true)) {
+    char dir[BS_LINE]; // `server_dir()`
+    static wchar_t errmsg[BS_LINE];
+    server_dir(dir, BS_LINE);
+    swprintf(errmsg, BS_LINE,
+             L"Directory '%s' is not private to the current user", dir);
+    winddown(ES_OPER_ERROR, errmsg);
+  }
+  struct sockaddr_un addr; // server socket address
+  if (!server_addr(&addr)) {
+    char path[BS_LINE]; // `server_path()`
+    static wchar_t errmsg[BS_LINE];
+    server_path(path, BS_LINE);
+    swprintf(errmsg, BS_LINE, L"Socket path '%s' is too long", path);
+    winddown(ES_OPER_ERROR, errmsg);
+  }
+  const int sfd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (-1 == sfd) {
+    static wchar_t errmsg[BS_SHORT];
+    serror(errmsg, L"Unable to socket()");
+    winddown(ES_OPER_ERROR, errmsg);
+  }
+  unlink(addr.sun_path);
+  if (-1 == bind(sfd, (const struct sockaddr *)&addr, sizeof(addr)) ||
+      -1 == listen(sfd, BS_SHORT)) {
+    static wchar_t errmsg[BS_LINE];
+    wchar_t errpre[BS_LINE];
+    swprintf(errpre, BS_LINE, L"Unable to listen on '%s'", addr.sun_path);
+    serror(errmsg, errpre);
+    winddown(ES_OPER_ERROR, errmsg);
+  }
+
+  // Clients that hang up early must not bring the server down
+  signal(SIGPIPE, SIG_IGN);
+
+  // Serve requests, one at a time
+  while (true) {
+    server_request_t req; // current request
+    const int fd = accept(sfd, NULL, NULL);
+    if (-1 == fd)
+      continue;
+    if (peer_ok(fd) && fd_read(fd, &req, sizeof(req))) {
+      req.args[BS_LINE - 1] = L'\0';
+      req.index_desc[4 * BS_LINE - 1] = '\0';
+      req.page_desc[4 * BS_LINE - 1] = '\0';
+      server_serve(fd, &req);
+    }
+    close(fd);
+  }
+}
@@ -0,0 +1,98 @@
+// Resident server mode (definition)
+
+#ifndef SERVER_H
+
+#define SERVER_H
+
+#include "lib.h"
+
+//
+// Constants
+//
+
+// Maximum number of rendered pages kept by the server
+#define SERVER_CACHE 64
+
+// Number of seconds after which the server forgets all rendered pages and
+// rebuilds its list of manual pages, to pick up changes to the system's manual
+#define SERVER_TTL 300
+
+// Maximum number of lines `page_read()` accepts in a page
+#define PAGE_MAX_LINES 0x100000
+
+// Maximum number of characters `page_read()` accepts in a line
+#define PAGE_MAX_WIDTH 0x10000
+
+//
+// Types
+//
+
+// A page request, as sent by a client to the server
+typedef struct {
+  request_type_t request_type;  // request type
+  unsigned width;               // value of `config.layout.main_width`
+  bool global_apropos;          // value of `config.misc.global_apropos`
+  bool global_whatis;           // value of `config.misc.global_whatis`
+  wchar_t args[BS_LINE];        // request arguments
+  char index_desc[4 * BS_LINE]; // client's `conf_index_desc()`
+  char page_desc[4 * BS_LINE];  // client's `conf_page_desc()`
+} server_request_t;
+
+// A rendered page, as cached by the server
+typedef struct {
+  server_request_t req; // the request that produced the page
+  char *data;           // the page, serialized by `page_write()`
+  size_t data_len;      // length of `data`
+} server_page_t;
+
+//
+// Global variables
+//
+
+// Pages rendered by the server, most of them recently
+extern server_page_t server_cache[SERVER_CACHE];
+
+// Index of the `server_cache` entry to be replaced next
+extern unsigned server_cache_next;
+
+// Time `server_cache` was last emptied (and `late_init()` last performed)
+extern time_t server_cache_time;
+
+//
+// Functions (generic)
+//
+
+// Place the path of the current user's server socket into `dst` (of length
+// `dst_len`). The socket lives in directory `qman` under `$XDG_RUNTIME_DIR` if
+// that's set, and in directory `/tmp/qman-UID` otherwise; either directory
+// must belong to the current user and have mode 0700. Return false if the
+// path doesn't fit in `dst` (and was therefore truncated).
+extern bool server_path(char *dst, unsigned dst_len);
+
+// Serialize `lines` (of length `lines_len`) into `fp`
+extern void page_write(FILE *fp, const line_t *lines, unsigned lines_len);
+
+// Deserialize lines written by `page_write()` from `fp` into `*dst`, and their
+// number into `*dst_len`. Return false, leaving `*dst` and `*dst_len`
+// untouched, if the data is truncated, can't be read, or exceeds
+// `PAGE_MAX_LINES`, `PAGE_MAX_WIDTH` or `BS_LINE`.
+extern bool page_read(line_t **dst, unsigned *dst_len, FILE *fp);
+
+// If a server is running, ask it to render the page that corresponds to
+// `history[history_cur]`, and place the result into `page` and `page_len` (or,
+// on failure, set `err` and `err_msg`), as `populate_page()` would. Return
+// false, without touching any of the above, if no server could be reached or
+// if the request can't be served remotely. The server only serves clients
+// whose configuration, as described by `conf_index_desc()` and
+// `conf_page_desc()`, matches its own.
+extern bool server_fetch();
+
+//
+// Functions (handlers)
+//
+
+// Main handler for the server. Listen on `server_path()` and serve page
+// requests from clients forever.
+extern void server();
+
+#endif
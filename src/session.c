@@ -0,0 +1,223 @@
+// Session persistence (implementation)
+
+#include "lib.h"
+
+//
+// Helper macros and functions
+//
+
+// Helper of `session_load()`. Read the `len` history entries that follow the
+// header of the session file `fp` into `*dst`. Return false if the entries are
+// truncated or invalid.
+bool session_entries(request_t **dst, unsigned len, FILE *fp) {
+  session_entry_t ent;                     // current entry
+  request_t *res = aalloc(len, request_t); // result
+  unsigned i;                              // iterator
+
+  for (i = 0; i < len; i++) {
+    if (1 != fread(&ent, sizeof(session_entry_t), 1, fp) ||
+        ent.request_type <= RT_NONE || ent.request_type > RT_FULLTEXT ||
+        ((unsigned)-1 != ent.args_len && ent.args_len >= BS_LINE)) {
+      requests_free(res, len);
+      return false;
+    }
+    res[i].request_type = ent.request_type;
+    res[i].top = ent.top;
+    res[i].left = ent.left;
+    res[i].flink = ent.flink;
+    if ((unsigned)-1 != ent.args_len) {
+      res[i].args = walloc(ent.args_len);
+      if (ent.args_len !=
+          fread(res[i].args, sizeof(wchar_t), ent.args_len, fp)) {
+        requests_free(res, len);
+        return false;
+      }
+      res[i].args[ent.args_len] = L'\0';
+    }
+  }
+
+  *dst = res;
+  return true;
+}
+
+// Helper of `session_save()` and `session_load()`. Return the modification
+// time of the source file of the manual page that corresponds to
+// `history[history_cur]`, or 0 if it isn't a manual page (or its source file
+// can't be found).
+time_t session_mtime() {
+  const request_t *req = &history[history_cur]; // current request
+  char path[BS_LINE];                          // source file path
+  struct stat st;                              // its status
+
+  if ((RT_MAN != req->request_type && RT_MAN_LOCAL != req->request_type) ||
+      NULL == req->args ||
+      !man_loc(path, BS_LINE, req->args, RT_MAN_LOCAL == req->request_type) ||
+      -1 == stat(path, &st))
+    return 0;
+
+  return st.st_mtime;
+}
+
+//
+// Functions (generic)
+//
+
+void session_path(char *dst, unsigned dst_len) {
+  const char *dir = getenv("XDG_CACHE_HOME");
+
+  if (NULL != dir && '\0' != dir[0])
+    snprintf(dst, dst_len, "%s/qman/session", dir);
+  else
+    snprintf(dst, dst_len, "%s/.cache/qman/session",
+             NULL != getenv("HOME") ? getenv("HOME") : "");
+}
+
+void session_save() {
+  char path[BS_LINE];      // session file path
+  char tpath[BS_LINE + 8]; // temporary session file path
+  session_header_t hdr;    // header
+  session_entry_t ent;     // current history entry
+  char *data;              // serialized current page
+  size_t data_len;         // length of `data`
+  unsigned i;              // iterator
+
+  // Record the user's position in the current page
+  history[history_cur].top = page_top;
+  history[history_cur].left = page_left;
+  history[history_cur].flink = page_flink;
+
+  // Serialize the current page
+  FILE *ms = open_memstream(&data, &data_len);
+  if (NULL == ms)
+    winddown(ES_OPER_ERROR, L"Unable to open_memstream()");
+  page_write(ms, page, page_len);
+  fclose(ms);
+
+  // Write the session into a temporary file, and move it into place once it's
+  // complete, so that an interrupted save doesn't destroy the previous session
+  session_path(path, BS_LINE);
+  ft_mkdirs(path);
+  snprintf(tpath, BS_LINE + 8, "%s.tmp", path);
+  FILE *fp = fopen(tpath, "w");
+  if (NULL == fp) {
+    static wchar_t errmsg[BS_LINE];
+    wchar_t errpre[BS_LINE];
+    swprintf(errpre, BS_LINE, L"Unable to create '%s'", tpath);
+    serror(errmsg, errpre);
+    winddown(ES_OPER_ERROR, errmsg);
+  }
+
+  memset(&hdr, 0, sizeof(session_header_t));
+  memcpy(hdr.magic, SESSION_MAGIC, sizeof(hdr.magic));
+  hdr.header_len = sizeof(session_header_t);
+  hdr.width = config.layout.main_width;
+  conf_page_desc(hdr.page_desc, 4 * BS_LINE);
+  hdr.mtime = session_mtime();
+  hdr.history_len = history_top + 1;
+  hdr.history_cur = history_cur;
+  xfwrite(&hdr, sizeof(session_header_t), 1, fp);
+
+  for (i = 0; i <= history_top; i++) {
+    memset(&ent, 0, sizeof(session_entry_t));
+    ent.request_type = history[i].request_type;
+    ent.top = history[i].top;
+    ent.left = history[i].left;
+    ent.flink = history[i].flink;
+    ent.args_len = NULL == history[i].args ? (unsigned)-1
+                                           : wcslen(history[i].args);
+    xfwrite(&ent, sizeof(session_entry_t), 1, fp);
+    if (NULL != history[i].args)
+      xfwrite(history[i].args, sizeof(wchar_t), ent.args_len, fp);
+  }
+
+  xfwrite(page_title, sizeof(wchar_t), BS_SHORT, fp);
+  xfwrite(&data_len, sizeof(size_t), 1, fp);
+  xfwrite(data, 1, data_len, fp);
+  free(data);
+  xfclose(fp);
+
+  if (-1 == rename(tpath, path)) {
+    static wchar_t errmsg[BS_LINE];
+    wchar_t errpre[BS_LINE];
+    swprintf(errpre, BS_LINE, L"Unable to rename '%s'", tpath);
+    serror(errmsg, errpre);
+    winddown(ES_OPER_ERROR, errmsg);
+  }
+}
+
+bool session_load() {
+  char path[BS_LINE];      // session file path
+  struct stat st;          // session file status
+  session_header_t hdr;    // header
+  request_t *reqs;         // saved history entries
+  wchar_t title[BS_SHORT]; // saved `page_title`
+  size_t data_len = 0;     // length of the serialized page
+  char desc[4 * BS_LINE];  // current `conf_page_desc()`
+  unsigned i;              // iterator
+
+  session_path(path, BS_LINE);
+  FILE *fp = fopen(path, "r");
+  if (NULL == fp)
+    return false;
+
+  // Read and check the header, and the history entries
+  if (-1 == fstat(fileno(fp), &st) ||
+      1 != fread(&hdr, sizeof(session_header_t), 1, fp) ||
+      0 != memcmp(hdr.magic, SESSION_MAGIC, sizeof(hdr.magic)) ||
+      sizeof(session_header_t) != hdr.header_len || 0 == hdr.history_len ||
+      hdr.history_cur >= hdr.history_len ||
+      hdr.history_len > st.st_size / sizeof(session_entry_t) ||
+      !session_entries(&reqs, hdr.history_len, fp)) {
+    fclose(fp);
+    return false;
+  }
+  if (1 != fread(title, sizeof(wchar_t) * BS_SHORT, 1, fp) ||
+      1 != fread(&data_len, sizeof(size_t), 1, fp) ||
+      data_len > (size_t)st.st_size)
+    data_len = 0;
+  title[BS_SHORT - 1] = L'\0';
+
+  // Restore history, one entry at a time, as if the user had visited every
+  // page again (so that the oldest entries are evicted, if `history_size` has
+  // been reduced in the meantime); `history_push()` records `page_top`,
+  // `page_left`, and `page_flink` into each entry before moving on to the next
+  for (i = 0; i < hdr.history_len; i++) {
+    if (0 == i)
+      history_replace(reqs[i].request_type, reqs[i].args);
+    else
+      history_push(reqs[i].request_type, reqs[i].args);
+    page_top = reqs[i].top;
+    page_left = reqs[i].left;
+    page_flink = reqs[i].flink;
+  }
+  requests_free(reqs, hdr.history_len);
+
+  // Go to the saved current entry, unless it has been evicted
+  const unsigned evicted = hdr.history_len - (history_top + 1);
+  if (hdr.history_cur < evicted) {
+    data_len = 0;
+    history_jump(0);
+  } else
+    history_jump(hdr.history_cur - evicted);
+
+  // Restore the current page, if it was rendered for the same width and
+  // configuration, from the same source file
+  hdr.page_desc[4 * BS_LINE - 1] = '\0';
+  conf_page_desc(desc, 4 * BS_LINE);
+  if (data_len > 0 && hdr.width == config.layout.main_width &&
+      0 == strcmp(hdr.page_desc, desc) && hdr.mtime == session_mtime()) {
+    char *data = xcalloc(data_len, 1); // serialized page
+    if (1 == fread(data, data_len, 1, fp)) {
+      FILE *ms = fmemopen(data, data_len, "r");
+      if (NULL == ms)
+        winddown(ES_OPER_ERROR, L"Unable to fmemopen()");
+      if (page_read(&page, &page_len, ms))
+        wcslcpy(page_title, title, BS_SHORT);
+      fclose(ms);
+    }
+    free(data);
+  }
+
+  fclose(fp);
+  return true;
+}
@@ -0,0 +1,67 @@
+// Session persistence (definition)
+
+#ifndef SESSION_H
+
+#define SESSION_H
+
+#include "lib.h"
+
+//
+// Constants
+//
+
+// Signature at the beginning of a session file (to be changed whenever the
+// file format changes)
+#define SESSION_MAGIC "QMANSS02"
+
+//
+// Types
+//
+
+// Session file header. The header is followed by `history_len` history
+// entries, each of them a `session_entry_t` followed by its `args`, then by
+// `page_title`, and finally by the current page, as serialized by
+// `page_write()` (preceded by its length, as a `size_t`).
+typedef struct {
+  char magic[8];               // `SESSION_MAGIC`
+  unsigned header_len;         // `sizeof(session_header_t)`
+  unsigned width;              // `config.layout.main_width` for the page
+  char page_desc[4 * BS_LINE]; // `conf_page_desc()` for the page
+  time_t mtime;                // modification time of the page's source file
+                               // (see `session_mtime()`)
+  unsigned history_len;        // no. of history entries (`history_top + 1`)
+  unsigned history_cur;        // value of `history_cur`
+} session_header_t;
+
+// A saved history entry
+typedef struct {
+  request_type_t request_type; // request type
+  unsigned top;                // latest `page_top`
+  unsigned left;               // latest `page_left`
+  link_loc_t flink;            // latest `page_flink`
+  unsigned args_len;           // length of `args`, or -1 if `args` is NULL
+} session_entry_t;
+
+//
+// Functions (generic)
+//
+
+// Place the path of the current user's session file into `dst` (of length
+// `dst_len`). The session file lives next to the full-text index (see
+// `ft_path()`).
+extern void session_path(char *dst, unsigned dst_len);
+
+// Save `history` (including the user's position in the current page) and the
+// current page into the session file
+extern void session_save();
+
+// Restore `history` (including the user's position in every page) from the
+// session file, and return true. If the current page was saved for the same
+// `config.layout.main_width` and `conf_page_desc()`, and its source file
+// hasn't been modified since, also restore `page`, `page_len`, and
+// `page_title`, so that it doesn't have to be rendered again; otherwise, leave
+// `page` NULL. If there is no valid session file, change nothing and return
+// false.
+extern bool session_load();
+
+#endif
@@ -20,6 +20,14 @@ action_t action = PA_NULL;
 
 mouse_t mouse_status = MS_EMPTY;
 
+bool scroll_only = false;
+
+unsigned wmain_top = 0;
+
+link_loc_t wmain_flink = {false, 0, 0};
+
+unsigned page_width = 0;
+
 //
 // Helper macros and functions
 //
@@ -66,6 +74,178 @@ mouse_t mouse_status = MS_EMPTY;
     }                                                                          \
   }
 
+// Helper of `draw_page()`. Paint `n` columns of `row`, starting at column `x`,
+// with color `col`, the way `apply_colour()` would paint them in `wmain`.
+// Columns past the end of the line are filled with blanks (as left by
+// `werase()`), and columns outside `row` are ignored.
+void row_paint(row_t *row, int x, int n, colour_t col) {
+  attr_t attr; // text attribute for `col`
+  short pair;  // color pair for `col`
+  int i;       // iterator
+
+  if (tcap.colours) {
+    attr = col.bold ? WA_BOLD : WA_NORMAL;
+    pair = col.pair;
+  } else {
+    attr = COLOR_BLACK == col.fg ? WA_REVERSE : WA_NORMAL;
+    pair = config.colours.fallback.pair;
+  }
+
+  if (x < 0 || x >= (int)row->width || n <= 0)
+    return;
+  n = MIN(n, (int)row->width - x);
+  for (i = row->len; i < x + n; i++) {
+    row->text[i] = L' ';
+    row->attrs[i] = WA_NORMAL;
+    row->pairs[i] = config.colours.text.pair;
+  }
+  row->len = MAX(row->len, x + n);
+  for (i = x; i < x + n; i++) {
+    row->attrs[i] = attr;
+    row->pairs[i] = pair;
+  }
+}
+
+// Helper of `draw_page()`. Output `row` to row `y` of `wmain`, one run of
+// identically colored characters at a time.
+void row_draw(const row_t *row, unsigned y) {
+  unsigned beg, end; // beginning and end of current run
+
+  for (beg = 0; beg < row->len; beg = end) {
+    for (end = beg + 1; end < row->len; end++)
+      if (row->attrs[end] != row->attrs[beg] ||
+          row->pairs[end] != row->pairs[beg])
+        break;
+    wattr_set(wmain, row->attrs[beg], row->pairs[beg], NULL);
+    mvwaddnwstr(wmain, y, beg, &row->text[beg], end - beg);
+  }
+}
+
+// Helper of `draw_page()` and `draw_page_scroll()`. Draw line `ly` of `lines`
+// (of length `lines_len`) into row `y` of `wmain`, or leave the row blank if
+// there's no such line. `flink` indicates the location of the focused link.
+void draw_page_row(line_t *lines, unsigned lines_len, unsigned ly, unsigned y,
+                   link_loc_t flink) {
+  unsigned x;   // current terminal column
+  unsigned lx;  // current column in line
+  unsigned l;   // current link
+  unsigned s;   // current search result
+  attr_t attr;  // current text attribute
+  colour_t col; // color of current link, search result, or mark
+
+  // Clear the row
+  wmove(wmain, y, 0);
+  wclrtoeol(wmain);
+  if (ly >= lines_len)
+    return;
+  const line_t *line = line_at(lines, ly);                      // the line
+  const line_t *prev = ly > 0 ? line_at(lines, ly - 1) : NULL; // previous one
+
+  // The row is composed in `row` first, and then output one run of
+  // identically colored characters at a time
+  row_t row;
+  row.width = getmaxx(wmain);
+  row.text = walloca(row.width);
+  row.attrs = aalloca(row.width, attr_t);
+  row.pairs = aalloca(row.width, short);
+  const short pair = tcap.colours ? config.colours.text.pair
+                                  : config.colours.fallback.pair; // text pair
+
+  // Skip all search results prior to the line
+  s = search_index(results, results_len, ly);
+
+  // Place the visible part of the line into `row`, along with its text
+  // attributes (the attribute of each character is the one last set at or
+  // before it, so the part of the line scrolled out of view is also
+  // examined)
+  const unsigned end = MIN(line->length, page_left + row.width);
+  attr = WA_NORMAL;
+  for (lx = 0; lx < end; lx++) {
+    if (bget(line->bold, lx))
+      attr = WA_BOLD;
+    if (bget(line->italic, lx))
+      attr = WA_STANDOUT;
+    if (bget(line->uline, lx))
+      attr = WA_UNDERLINE;
+    if (bget(line->reg, lx))
+      attr = WA_NORMAL;
+    if (lx >= page_left) {
+      // (NULs are left blank, as `werase()` left them)
+      x = lx - page_left;
+      const bool blank = L'\0' == line->text[lx];
+      row.text[x] = blank ? L' ' : line->text[lx];
+      row.attrs[x] = blank ? WA_NORMAL : attr;
+      row.pairs[x] = blank ? config.colours.text.pair : pair;
+    }
+  }
+  row.len = end > page_left ? end - page_left : 0;
+
+  // For each link...
+  for (l = 0; l < line->links_length; l++) {
+    const link_t link = line->links[l];
+
+    // Apply the the appropriate color, based on link type and whether the
+    // link is focused
+    set_link_col(ly, l, link.type);
+    if (page_left <= link.start)
+      row_paint(&row, link.start - page_left, link.end - link.start, col);
+  }
+
+  // If we are below the first line, and the previous line has links...
+  if (NULL != prev && prev->links_length > 0) {
+    l = prev->links_length - 1;
+
+    // ...and its last link is hyphenated...
+    if (prev->links[l].in_next) {
+      const link_t link = prev->links[l];
+
+      // Apply the the appropriate color, based on link type and whether the
+      // link is focused
+      set_link_col(ly - 1, l, link.type);
+      if (page_left <= link.start)
+        row_paint(&row, (int)link.start_next - (int)page_left,
+                  link.end_next - link.start_next, col);
+    }
+  }
+
+  // Go through all search results for current line, and highlight them
+  // (using a different color for each term of multi-term searches)
+  while (s < results_len && results[s].line == ly) {
+    if (page_left <= results[s].start) {
+      const colour_t search_cols[] = {
+          config.colours.search, config.colours.search_2,
+          config.colours.search_3, config.colours.search_4};
+      row_paint(&row, results[s].start - page_left,
+                results[s].end - results[s].start,
+                search_cols[results[s].term % 4]);
+    }
+    s++;
+  }
+
+  // If some text is marked, apply the appropriate color to it
+  if (mark.enabled) {
+    unsigned cx = 0, cn = 0; // `x` and `n` parameters for `row_paint()`
+    if (ly == mark.start_line && ly == mark.end_line) {
+      cx = MAX(0, (int)mark.start_char - (int)page_left);
+      cn = MAX(0, (int)mark.end_char - (int)mark.start_char + 1);
+      if (mark.start_char < page_left)
+        cn = MAX(0, (int)cn - (int)(page_left - mark.start_char));
+    } else if (ly == mark.start_line && ly < mark.end_line) {
+      cx = MAX(0, (int)mark.start_char - (int)page_left);
+      cn = getmaxx(wmain) - 1;
+    } else if (ly > mark.start_line && ly < mark.end_line) {
+      cx = 0;
+      cn = getmaxx(wmain) - 1;
+    } else if (ly > mark.start_line && ly == mark.end_line) {
+      cx = 0;
+      cn = MAX(0, (int)mark.end_char - (int)page_left + 1);
+    }
+    row_paint(&row, cx, cn, config.colours.mark);
+  }
+
+  row_draw(&row, y);
+}
+
 // Helper of `tui_open()`. Re-initialize ncurses after shelling out.
 #define tui_reset                                                              \
   {                                                                            \
@@ -96,37 +276,23 @@ mouse_t mouse_status = MS_EMPTY;
     return false;                                                              \
   }
 
-// Helper of `tui_toc()`. Search the current page for a line whose text matches
-// the text of the `focus`ed entry in `toc`.
-//
-// This function calls `ls_jump()`. To increase accuracy, it tries to set its
-// `trgt_prev` argument to the section or subsection that preceeds the `focus`ed
-// entry in `toc`.
-#define toc_jump(toc, focus)                                                   \
-  int prev;                                                                    \
-  for (prev = MAX(0, focus - 1); prev >= 0; prev--)                            \
-    if (TT_HEAD == toc[prev].type || TT_SUBHEAD == toc[prev].type)             \
-      break;                                                                   \
-  ls_jump(toc[focus].text, toc[prev].text);
+// Helper of `tui_open()`, `tui_open_apropos()` and `tui_open_whatis()`. The
+// link `page_flink` points to.
+#define flink_link (line_at(page, page_flink.line)->links[page_flink.link])
+
+// Helper of `tui_toc()`. Jump to the line of the current page that the
+// `focus`ed entry in `toc` points to.
+#define toc_jump(toc, focus) ln_jump(toc[focus].line)
 
-// Helper of `tui_open()` and `toc_jump()`, i.e. `tui_toc()`. Search the current
-// page for a line whose text matches `trgt`, and jump to said line. (But if
-// `trgt_prev` is not NULL, make sure that the matched line is preceded by a
-// line whose text matches `trgt_prev`.)
-#define ls_jump(trgt, trgt_prev)                                               \
+// Helper of `tui_open()`. Search the current page for a line whose text matches
+// `trgt`, and jump to said line.
+#define ls_jump(trgt) ln_jump(ls_discover(trgt, 0))
+
+// Helper of `toc_jump()` and `ls_jump()`. Jump to line number `ln` of the
+// current page, or fail if `ln` is negative.
+#define ln_jump(ln)                                                            \
   {                                                                            \
-    wchar_t trgt_clone[BS_LINE];                                               \
-    wcslcpy(trgt_clone, trgt, BS_LINE);                                        \
-    int best;                                                                  \
-    if (NULL == trgt_prev)                                                     \
-      best = 0;                                                                \
-    else {                                                                     \
-      wchar_t trgt_prev_clone[BS_LINE];                                        \
-      /* ?/: is necessary to avoid a spurious -Wnonnull compiler warning */    \
-      wcslcpy(trgt_prev_clone, NULL != trgt_prev ? trgt_prev : L"", BS_LINE);  \
-      best = ls_discover(trgt_prev_clone, 0);                                  \
-    }                                                                          \
-    best = ls_discover(trgt_clone, best);                                      \
+    const int best = ln;                                                       \
     if (best < 0) {                                                            \
       tui_error(L"Unable to jump to requested location");                      \
       return false;                                                            \
@@ -139,6 +305,23 @@ mouse_t mouse_status = MS_EMPTY;
     }                                                                          \
   }
 
+// Helper of `tui()`. Return true if program action `act`, with mouse status
+// `ms`, moves up or down the page, i.e. if it's one of `PA_UP`, `PA_DOWN`,
+// `PA_PGUP`, `PA_PGDN`, or a mouse wheel scroll.
+bool is_motion(action_t act, mouse_t ms) {
+  switch (act) {
+  case PA_UP:
+  case PA_DOWN:
+  case PA_PGUP:
+  case PA_PGDN:
+    return true;
+  case PA_NULL:
+    return WH_UP == ms.wheel || WH_DOWN == ms.wheel;
+  default:
+    return false;
+  }
+}
+
 // Helper of `sigusr1_handler()`. Reset terminal RGB color values to their
 // defaults.
 void sigusr1_reset() {
@@ -168,6 +351,10 @@ void sigusr1_reset() {
 CC_IGNORE_UNUSED_PARAMETER
 void sigusr1_handler(int signum) {
   CC_IGNORE_ENDS
+  char index_desc[4 * BS_LINE]; // `conf_index_desc()` before reconfiguring
+  char page_desc[4 * BS_LINE];  // `conf_page_desc()` before reconfiguring
+  char desc[4 * BS_LINE];       // either of them, after reconfiguring
+
   // Don't attempt attempt to reconfigure on ancient terminals
   if (tcap.colours < 256 || tcap.term == strstr(tcap.term, "rxvt")) {
     return;
@@ -176,8 +363,9 @@ void sigusr1_handler(int signum) {
   sigusr1_reset();
 
   // Reconfigure
+  conf_index_desc(index_desc, 4 * BS_LINE);
+  conf_page_desc(page_desc, 4 * BS_LINE);
   configure();
-  late_init();
   init_tui_tcap();
   if (-1 == config.tcap.colours || t_auto == config.tcap.rgb ||
       t_auto == config.tcap.unicode || t_auto == config.tcap.clipboard)
@@ -186,78 +374,81 @@ void sigusr1_handler(int signum) {
   init_tui_mouse();
   doupdate();
 
+  // Rebuild `aw_all` and `sc_all` (and forget everything derived from them)
+  // only if the commands that list manual pages have changed, and populate
+  // `page` again only if it would turn out differently; changes to colors,
+  // keys, etc. only need a redraw
+  conf_index_desc(desc, 4 * BS_LINE);
+  if (0 != strcmp(desc, index_desc)) {
+    late_init();
+    aw_last_keep(RT_NONE, NULL, NULL, 0);
+    page_width = 0;
+  }
+  conf_page_desc(desc, 4 * BS_LINE);
+  if (0 != strcmp(desc, page_desc))
+    page_width = 0;
+
   // Cause next `termsize_changed()` to succeed, thus forcing a redraw
   config.layout.width = 0;
   config.layout.height = 0;
 }
 
-// Helper of `ls_jump()`, i.e. of `tui_open()` and `tui_toc()`. Return the line
-// number that best matches local searh link target `trgt`, or -1 if error.
-// Start searching at line number `sln`.
-int ls_discover(wchar_t *trgt, unsigned sln) {
-  wchar_t **trgt_words = alloca(BS_SHORT * sizeof(wchar_t *)); // words in trgt
-  unsigned trgt_words_len; // no. of words in trgt
-  wchar_t **cand_words =
-      walloca(BS_SHORT * sizeof(wchar_t *)); // words in current candidate line
-  unsigned cand_words_len;       // no. of words in current candidate line
-  unsigned ln;                   // current line number
-  unsigned line_nos[BS_LINE];    // candidate line numbers
-  unsigned line_scores[BS_LINE]; // candidate line scores
-  unsigned max_no = 0;           // line number with maximum score
-  unsigned max_score = 0;        // maximum score
-  unsigned i, j;                 // iterators
-
-  trgt_words_len = wsplit(&trgt_words, BS_SHORT, trgt, NULL, false);
-  if (0 == trgt_words_len)
-    return -1;
-
-  if (sln >= page_len)
-    return -1;
-
-  // Record candidate lines and their scores
-  j = 0;
-  for (ln = sln; ln < page_len && j < BS_LINE; ln++) {
-    wchar_t text[BS_LINE]; // current line text
-    wcslcpy(text, page[ln].text, BS_LINE);
-    if (wcsstr(text, trgt_words[0]) == &text[wmargend(text, NULL)]) {
-      // In order for a line to be a candidate, it must begin with the first
-      // word in `trgt`
-      line_nos[j] = ln;
-      line_scores[j] = 0;
-      // Candidate line score is calculated as 2x the number of its words that
-      // exactly match the words in `trgt`. An extra point is added to said
-      // score if the last word in `trgt` matches just the beginning of its
-      // corresponding word in `cand`
-      cand_words_len = wsplit(&cand_words, BS_SHORT, text, NULL, false);
-      for (i = 0; i < MIN(trgt_words_len, cand_words_len); i++)
-        if (0 == wcscmp(cand_words[i], trgt_words[i]))
-          line_scores[j] += 2;
-        else if (trgt_words_len - 1 == i)
-          if (cand_words[i] == wcsstr(cand_words[i], trgt_words[i]))
-            line_scores[j]++;
-      // Candidates that got full marks, and either (a) don't include any
-      // additional words or (b) are less indended than the following line, get
-      // an extra point
-      if (line_scores[j] == trgt_words_len) {
-        if (cand_words_len == trgt_words_len)
-          line_scores[j]++;
-        else if (ln < page_len - 1) {
-          if (wmargend(page[ln + 1].text, NULL) > wmargend(text, NULL))
-            line_scores[j]++;
-        }
-      }
-      j++;
-    }
+// Helper of `aw_quick_search()`. Place the positions in `aw_all` of the (at
+// most `res_len`) pages whose idents best match `needle` fuzzily into `res`,
+// highest score first, and return their number. Pages that score the same are
+// ordered by ident length, and then by their position in `aw_all`. As in fzf,
+// the match is case-insensitive, unless `needle` contains upper-case
+// characters.
+unsigned aw_fuzzy_search(unsigned *res, unsigned res_len,
+                         const wchar_t *needle) {
+  static unsigned long long *masks = NULL; // signatures of `aw_all` idents
+  static unsigned masks_gen = 0;           // `aw_all_gen` when `masks` was made
+  int *scores = aalloca(res_len, int);     // scores of `res` entries
+  unsigned len = 0;                        // number of entries in `res`
+  unsigned i, j;                           // iterators
+
+  // Character signatures of all idents are computed once, so that pages that
+  // can't possibly match are skipped with a single bit test. (They are
+  // recomputed whenever `late_init()` replaces `aw_all`.)
+  if (NULL == masks || masks_gen != aw_all_gen) {
+    if (NULL != masks)
+      free(masks);
+    masks = aalloc(MAX(1, aw_all_len), unsigned long long);
+    for (i = 0; i < aw_all_len; i++)
+      masks[i] = fz_mask(aw_all[i].ident);
+    masks_gen = aw_all_gen;
+  }
+
+  bool cs = true; // whether to match case-insensitively
+  for (i = 0; L'\0' != needle[i]; i++)
+    cs = cs && !iswupper(needle[i]);
+  const unsigned long long needle_mask = fz_mask(needle); // `needle` signature
+
+  for (i = 0; i < aw_all_len; i++) {
+    if (0 != (needle_mask & ~masks[i]))
+      continue;
+    const int score = fz_score(needle, aw_all[i].ident, cs); // page score
+    if (-1 == score)
+      continue;
+
+    // Insert the page into `res`, keeping it sorted
+    const unsigned ident_len = wcslen(aw_all[i].ident);
+    for (j = len; j > 0; j--)
+      if (scores[j - 1] > score ||
+          (scores[j - 1] == score &&
+           wcslen(aw_all[res[j - 1]].ident) <= ident_len))
+        break;
+    if (j >= res_len)
+      continue;
+    if (len < res_len)
+      len++;
+    memmove(&res[j + 1], &res[j], (len - j - 1) * sizeof(unsigned));
+    memmove(&scores[j + 1], &scores[j], (len - j - 1) * sizeof(int));
+    res[j] = i;
+    scores[j] = score;
   }
 
-  // Return the candidate line with the highest score
-  for (i = 0; i < j; i++)
-    if (line_scores[i] > max_score) {
-      max_no = line_nos[i];
-      max_score = line_scores[i];
-    }
-
-  return max_no;
+  return len;
 }
 
 // Helper of `tui_sp_open()`. Print incremental search results in `wimm` as the
@@ -279,18 +470,25 @@ wchar_t *aw_quick_search(wchar_t *needle, int last, bool qident) {
   unsigned ln = 0;              // current line
   wchar_t *ret = NULL;
 
-  // Search `aw_all` for pages beginning with `needle`, and add them into `res`
-  pos = 0;
-  pos = aprowhat_search(needle, aw_all, aw_all_len, pos, false);
-  while (-1 != pos && ln < lines) {
-    res[ln] = pos;
-    pos = aprowhat_search(needle, aw_all, aw_all_len, ++pos, false);
-    ln++;
+  if (config.capabilities.sp_fuzzy && needle_len > 0) {
+    // Rank all pages in `aw_all` that contain the characters of `needle` in
+    // order, and add the best ones into `res`, highest score first
+    ln = aw_fuzzy_search(res, lines, needle);
+  } else {
+    // Search `aw_all` for pages beginning with `needle`, and add them into
+    // `res`
+    pos = 0;
+    pos = aprowhat_search(needle, aw_all, aw_all_len, pos, false);
+    while (-1 != pos && ln < lines) {
+      res[ln] = pos;
+      pos = aprowhat_search(needle, aw_all, aw_all_len, ++pos, false);
+      ln++;
+    }
   }
 
   // If there's space, also search for pages that contain `needle`, and add them
   // to `res` as well (only if `config.misc.sp_substrings` is true)
-  if (config.capabilities.sp_substrings) {
+  if (config.capabilities.sp_substrings && !config.capabilities.sp_fuzzy) {
     pos = 0;
     pos = aprowhat_search(needle, aw_all, aw_all_len, pos, true);
     while (-1 != pos && ln < lines) {
@@ -303,9 +501,10 @@ wchar_t *aw_quick_search(wchar_t *needle, int last, bool qident) {
   lines = ln; // `lines` becomes exact no. of lines to display
 
   // Update `focus`, if the user has used the arrow keys or mouse to highlight a
-  // line
+  // line (when opening pages ranked by fuzzy matching, the best match is
+  // highlighted until the user chooses otherwise)
   if (0 == needle_len || last_needle_len != needle_len) {
-    focus = -1;
+    focus = config.capabilities.sp_fuzzy && qident && needle_len > 0 ? 0 : -1;
     last_needle_len = needle_len;
   } else {
     if (-KEY_DOWN == last || -0x09 == last || -GSN_WH_UP == last) {
@@ -565,6 +764,9 @@ void init_tui_colours() {
   if (tcap.colours) {
     init_colour(config.colours.text);
     init_colour(config.colours.search);
+    init_colour(config.colours.search_2);
+    init_colour(config.colours.search_3);
+    init_colour(config.colours.search_4);
     init_colour(config.colours.mark);
     init_colour(config.colours.link_man);
     init_colour(config.colours.link_man_f);
@@ -642,6 +844,7 @@ void init_windows() {
     delwin(wmain);
   wmain = newwin(config.layout.main_height, config.layout.main_width, 0, 0);
   keypad(wmain, true);
+  scroll_only = false;
 
   if (NULL != wsbar)
     delwin(wsbar);
@@ -658,6 +861,12 @@ void init_windows() {
   wnoutrefresh(stdscr);
 }
 
+bool input_pending() {
+  struct pollfd pfd = {STDIN_FILENO, POLLIN, 0}; // standard input
+
+  return poll(&pfd, 1, 0) > 0;
+}
+
 bool termsize_changed() {
   const int width = getmaxx(stdscr);
   const int height = getmaxy(stdscr);
@@ -815,6 +1024,16 @@ void termsize_adjust() {
   }
 }
 
+void repopulate_page() {
+  if (page_width == config.layout.main_width)
+    return;
+
+  populate_page();
+  if (err)
+    winddown(ES_OPER_ERROR, err_msg);
+  page_width = config.layout.main_width;
+}
+
 void draw_box(WINDOW *w, unsigned tl_y, unsigned tl_x, unsigned br_y,
               unsigned br_x) {
   unsigned i;
@@ -840,104 +1059,58 @@ void draw_page(line_t *lines, unsigned lines_len, unsigned lines_top,
   wbkgd(wmain, COLOR_PAIR(config.colours.text.pair));
   change_colour_attr(wmain, config.colours.text, WA_NORMAL);
 
-  unsigned y;     // current terminal row
-  unsigned ly;    // current line
-  unsigned x;     // current terminal column
-  unsigned lx;    // current column in line
-  unsigned l;     // current link
-  unsigned s = 0; // current search result
+  unsigned y; // current terminal row
 
   // For each terminal row...
-  for (y = 0; y < getmaxy(wmain); y++) {
-    ly = lines_top + y;
-    if (ly >= lines_len)
-      break;
-
-    // For each terminal column...
-    for (x = 0; x < getmaxx(wmain); x++) {
-      lx = x + page_left;
-      if (lx >= lines[ly].length)
-        break;
-
-      // Set text attributes
-      if (bget(lines[ly].bold, lx))
-        change_colour_attr(wmain, config.colours.text, WA_BOLD);
-      if (bget(lines[ly].italic, lx))
-        change_colour_attr(wmain, config.colours.text, WA_STANDOUT);
-      if (bget(lines[ly].uline, lx))
-        change_colour_attr(wmain, config.colours.text, WA_UNDERLINE);
-      if (bget(lines[ly].reg, lx))
-        change_colour_attr(wmain, config.colours.text, WA_NORMAL);
-
-      // Place character on screen
-      mvwaddnwstr(wmain, y, x, &lines[ly].text[lx], 1);
-    }
-
-    // For each link...
-    for (l = 0; l < lines[ly].links_length; l++) {
-      const link_t link = lines[ly].links[l];
+  for (y = 0; y < getmaxy(wmain) && lines_top + y < lines_len; y++)
+    draw_page_row(lines, lines_len, lines_top + y, y, flink);
 
-      // Apply the the appropriate color, based on link type and whether the
-      // link is focused
-      colour_t col;
-      set_link_col(ly, l, link.type);
-      if (page_left <= link.start)
-        apply_colour(wmain, y, link.start - page_left, link.end - link.start,
-                     col);
-    }
-
-    // If we are below the first line, and the previous line has links...
-    if (ly > 0 && lines[ly - 1].links_length > 0) {
-      l = lines[ly - 1].links_length - 1;
-
-      // ...and its last link is hyphenated...
-      if (lines[ly - 1].links[l].in_next) {
-        const link_t link = lines[ly - 1].links[l];
-
-        // Apply the the appropriate color, based on link type and whether the
-        // link is focused
-        colour_t col;
-        set_link_col(ly - 1, l, link.type);
-        if (page_left <= link.start)
-          apply_colour(wmain, y, link.start_next - page_left,
-                       link.end_next - link.start_next, col);
-      }
-    }
-
-    // Skip all search results prior to current line
-    while (s < results_len && results[s].line < ly)
-      s++;
+  wmain_top = lines_top;
+  wmain_flink = flink;
+  wnoutrefresh(wmain);
+}
 
-    // Go through all search results for current line, and highlight them
-    while (s < results_len && results[s].line == ly) {
-      if (page_left <= results[s].start)
-        apply_colour(wmain, y, results[s].start - page_left,
-                     results[s].end - results[s].start, config.colours.search);
-      s++;
-    }
+void draw_page_scroll(line_t *lines, unsigned lines_len, unsigned lines_top,
+                      link_loc_t flink) {
+  const int height = getmaxy(wmain);                  // window height
+  const int dy = (int)lines_top - (int)wmain_top;     // lines to scroll by
+  const link_loc_t old_flink = wmain_flink;           // previous focused link
+  int y;                                              // current terminal row
 
-    // If some text is marked, apply the appropriate color to it
-    if (mark.enabled) {
-      unsigned cx = 0, cn = 0; // `x` and `n` parameters for `apply_colour()`
-      if (ly == mark.start_line && ly == mark.end_line) {
-        cx = MAX(0, (int)mark.start_char - (int)page_left);
-        cn = MAX(0, (int)mark.end_char - (int)mark.start_char + 1);
-        if (mark.start_char < page_left)
-          cn = MAX(0, (int)cn - (int)(page_left - mark.start_char));
-      } else if (ly == mark.start_line && ly < mark.end_line) {
-        cx = MAX(0, (int)mark.start_char - (int)page_left);
-        cn = getmaxx(wmain) - 1;
-      } else if (ly > mark.start_line && ly < mark.end_line) {
-        cx = 0;
-        cn = getmaxx(wmain) - 1;
-      } else if (ly > mark.start_line && ly == mark.end_line) {
-        cx = 0;
-        cn = MAX(0, (int)mark.end_char - (int)page_left + 1);
-      }
-      apply_colour(wmain, y, cx, cn, config.colours.mark);
-    }
+  // If the whole window would change anyway, draw it anew
+  if (abs(dy) >= height) {
+    draw_page(lines, lines_len, lines_top, flink);
+    return;
   }
 
+  // Scroll the window, and draw the rows it exposed
+  if (0 != dy) {
+    scrollok(wmain, true);
+    wscrl(wmain, dy);
+    scrollok(wmain, false);
+  }
+  if (dy > 0)
+    for (y = height - dy; y < height; y++)
+      draw_page_row(lines, lines_len, lines_top + y, y, flink);
+  else
+    for (y = 0; y < -dy; y++)
+      draw_page_row(lines, lines_len, lines_top + y, y, flink);
+
+  // If the focused link has changed, redraw the rows of both the previous and
+  // the new one (as well as the rows after them, where hyphenated links end)
+  if (old_flink.ok != flink.ok || old_flink.line != flink.line ||
+      old_flink.link != flink.link) {
+    const link_loc_t fls[] = {old_flink, flink}; // links to redraw
+    unsigned i, ly;                              // iterators
+    for (i = 0; i < asizeof(fls); i++)
+      if (fls[i].ok)
+        for (ly = fls[i].line; ly <= fls[i].line + 1; ly++)
+          if (ly >= lines_top && ly < lines_top + height)
+            draw_page_row(lines, lines_len, ly, ly - lines_top, flink);
+  }
+
+  wmain_top = lines_top;
+  wmain_flink = flink;
   wnoutrefresh(wmain);
 }
 
@@ -1091,10 +1264,12 @@ int get_str_next(WINDOW *w, unsigned y, unsigned x, wchar_t *trgt,
   mouse_t ms = MS_EMPTY;   // mouse status corresponding to `wget_stat`
 
   if (NULL != trgt) {
-    // First call; initialize `res`, `res_len`, and `pos`
+    // First call; initialize `res`, `res_len`, and `pos` (`res` must hold a
+    // valid string even if the first key doesn't change it, e.g. TAB)
     res = trgt;
     res_len = trgt_len;
     pos = 0;
+    res[0] = L'\0';
   }
 
   // Get input from user
@@ -1382,7 +1557,11 @@ void winddown_tui() {
 
 void tui_redraw() {
   // Main page
-  draw_page(page, page_len, page_top, page_flink);
+  if (scroll_only)
+    draw_page_scroll(page, page_len, page_top, page_flink);
+  else
+    draw_page(page, page_len, page_top, page_flink);
+  scroll_only = false;
 
   // Scrollbar
   draw_sbar(page_len, page_top);
@@ -1438,6 +1617,7 @@ bool tui_up() {
     return false;
   }
 
+  scroll_only = true;
   return true;
 }
 
@@ -1463,6 +1643,7 @@ bool tui_down() {
     return false;
   }
 
+  scroll_only = true;
   return true;
 }
 
@@ -1583,13 +1764,13 @@ bool tui_open() {
   error_on_invalid_flink;
 
   // Open the link
-  switch (page[page_flink.line].links[page_flink.link].type) {
+  switch (flink_link.type) {
   case LT_MAN:
     // The link is a manual page; add a new page request to show it
     {
       wchar_t trgt[BS_LINE];
       swprintf(trgt, BS_LINE, L"'%ls'",
-               page[page_flink.line].links[page_flink.link].trgt);
+               flink_link.trgt);
       history_push(RT_MAN, trgt);
       populate_page();
       if (err) {
@@ -1611,7 +1792,7 @@ bool tui_open() {
     {
       char trgt[BS_LINE];
       snprintf(trgt, BS_LINE, "%s '%ls' 2>>/dev/null", config.misc.browser_path,
-               page[page_flink.line].links[page_flink.link].trgt);
+               flink_link.trgt);
 
       // Shell out
       res = xsystem(trgt, false);
@@ -1632,7 +1813,7 @@ bool tui_open() {
     {
       char trgt[BS_LINE];
       snprintf(trgt, BS_LINE, "%s '%ls' 2>>/dev/null", config.misc.mailer_path,
-               page[page_flink.line].links[page_flink.link].trgt);
+               flink_link.trgt);
 
       // Shell out
       res = xsystem(trgt, false);
@@ -1654,7 +1835,7 @@ bool tui_open() {
     {
       char trgt[BS_LINE];
       snprintf(trgt, BS_LINE, "%s '%ls' 2>>/dev/null", config.misc.viewer_path,
-               page[page_flink.line].links[page_flink.link].trgt);
+               flink_link.trgt);
 
       // Shell out
       res = xsystem(trgt, false);
@@ -1672,7 +1853,7 @@ bool tui_open() {
     break;
   case LT_LS:
     // The link is a local search link; jump to the appropriate page location
-    ls_jump(page[page_flink.line].links[page_flink.link].trgt, NULL);
+    ls_jump(flink_link.trgt);
     break;
   }
 
@@ -1685,8 +1866,8 @@ bool tui_open_apropos() {
 
   error_on_invalid_flink;
 
-  if (LT_MAN == page[page_flink.line].links[page_flink.link].type) {
-    wcslcpy(wtrgt, page[page_flink.line].links[page_flink.link].trgt, BS_LINE);
+  if (LT_MAN == flink_link.type) {
+    wcslcpy(wtrgt, flink_link.trgt, BS_LINE);
     wtrgt_stripped = wcstok(wtrgt, L"()", &buf);
 
     if (NULL == wtrgt_stripped) {
@@ -1721,8 +1902,8 @@ bool tui_open_whatis() {
 
   error_on_invalid_flink;
 
-  if (LT_MAN == page[page_flink.line].links[page_flink.link].type) {
-    wcslcpy(wtrgt, page[page_flink.line].links[page_flink.link].trgt, BS_LINE);
+  if (LT_MAN == flink_link.type) {
+    wcslcpy(wtrgt, flink_link.trgt, BS_LINE);
     wtrgt_stripped = wcstok(wtrgt, L"()", &buf);
 
     if (NULL == wtrgt_stripped) {
@@ -1770,10 +1951,14 @@ bool tui_sp_open(request_type_t rt) {
     draw_imm(true, true, config.colours.sp_input, L"Apropos what?", help);
   else if (RT_WHATIS == rt)
     draw_imm(true, true, config.colours.sp_input, L"Whatis what?", help);
+  else if (RT_FULLTEXT == rt)
+    draw_imm(true, true, config.colours.sp_input, L"Full-text search for what?",
+             help);
   doupdate();
 
-  // Get input (and show incremental search results as the user types)
-  awqsr = aw_quick_search(inpt, 0, RT_MAN == rt);
+  // Get input (and show incremental search results as the user types, except
+  // for full-text searches, whose words needn't be page names)
+  awqsr = RT_FULLTEXT == rt ? NULL : aw_quick_search(inpt, 0, RT_MAN == rt);
   doupdate();
   change_colour(wimm, config.colours.sp_input);
   got_inpt = get_str_next(wimm, 2, 2, inpt,
@@ -1783,9 +1968,7 @@ bool tui_sp_open(request_type_t rt) {
     if (termsize_changed()) {
       del_imm();
       init_windows();
-      populate_page();
-      if (err)
-        winddown(ES_OPER_ERROR, err_msg);
+      repopulate_page();
       termsize_adjust();
       tui_redraw();
       if (RT_MAN == rt)
@@ -1795,11 +1978,15 @@ bool tui_sp_open(request_type_t rt) {
         draw_imm(true, true, config.colours.sp_text, L"Apropos what?", help);
       else if (RT_WHATIS == rt)
         draw_imm(true, true, config.colours.sp_text, L"Whatis what?", help);
+      else if (RT_FULLTEXT == rt)
+        draw_imm(true, true, config.colours.sp_text,
+                 L"Full-text search for what?", help);
       change_colour(wimm, config.colours.sp_input);
       mvwaddnwstr(wimm, 2, 2, inpt, wcslen(inpt));
     }
 
-    awqsr = aw_quick_search(inpt, got_inpt, RT_MAN == rt);
+    awqsr = RT_FULLTEXT == rt ? NULL
+                              : aw_quick_search(inpt, got_inpt, RT_MAN == rt);
     doupdate();
     change_colour(wimm, config.colours.sp_input);
     got_inpt = get_str_next(wimm, 2, 2, NULL, 0);
@@ -1993,9 +2180,7 @@ bool tui_history() {
     if (termsize_changed()) {
       del_imm();
       init_windows();
-      populate_page();
-      if (err)
-        winddown(ES_OPER_ERROR, err_msg);
+      repopulate_page();
       termsize_adjust();
       tui_redraw();
       top = 0;
@@ -2121,9 +2306,7 @@ bool tui_toc() {
     if (termsize_changed()) {
       del_imm();
       init_windows();
-      populate_page();
-      if (err)
-        winddown(ES_OPER_ERROR, err_msg);
+      repopulate_page();
       populate_toc();
       termsize_adjust();
       tui_redraw();
@@ -2139,11 +2322,37 @@ bool tui_toc() {
   return true;
 }
 
+// Helper of `tui_search()`. The name of the search mode selected by `re` and
+// `multi`, as shown in the status bar.
+#define search_mode (re ? L"REGEX" : multi ? L"MULTI" : L"SEARCH")
+
+// Helper of `tui_search()`. Return the line the page should be scrolled to, in
+// order to show the first member of `results` that follows line `base` (or
+// precedes it, if `back` is true).
+unsigned search_top(unsigned base, bool back) {
+  const int tmp = back ? search_prev(results, results_len, base)
+                       : search_next(results, results_len, base);
+  unsigned res = -1 == tmp ? base : tmp; // return value
+
+  if (res + config.layout.main_height > page_len) {
+    if (page_len >= config.layout.main_height)
+      res = MIN(res, page_len - config.layout.main_height);
+    else
+      res = 0;
+  }
+
+  return res;
+}
+
 bool tui_search(bool back) {
   wchar_t *prompt = back ? L"?" : L"/"; // search prompt
   wchar_t help[BS_SHORT];               // help message
-  swprintf(help, BS_SHORT, L"Press %ls to search or %ls/%ls to abort",
-           ch2name(KEY_ENTER), ch2name(KEY_BREAK), ch2name('\e'));
+  swprintf(help, BS_SHORT,
+           L"Press %ls to search, %ls/%ls to abort, or %ls to change mode",
+           ch2name(KEY_ENTER), ch2name(KEY_BREAK), ch2name('\e'),
+           ch2name('\t'));
+  bool re = config.capabilities.regex_search; // search for a regex
+  bool multi = false; // search for several terms, separated by '|'
   wchar_t inpt[BS_SHORT - 2]; // search string
   wchar_t pout[BS_SHORT];     // search prompt and string printout
   const unsigned width = config.layout.width / 2 - 1; // search string width
@@ -2151,10 +2360,11 @@ bool tui_search(bool back) {
   unsigned my_top =
       page_top; // temporary `page_top` that will be set to the line number of
                 // the first search result, as the user types
+  unsigned base = page_top; // line the search is relative to
 
   // Get search string
   swprintf(pout, BS_SHORT, prompt);
-  draw_stat(L"SEARCH", page_title, page_len, page_top + 1,
+  draw_stat(search_mode, page_title, page_len, page_top + 1,
             page_left / config.layout.tabstop + 1, pout, help, NULL);
   got_inpt = get_str_next(wstat, 1, 1, inpt, MIN(BS_SHORT - 3, width));
 
@@ -2163,66 +2373,82 @@ bool tui_search(bool back) {
     // If terminal size has changed, regenerate page and redraw everything
     if (termsize_changed()) {
       init_windows();
-      populate_page();
-      if (err)
-        winddown(ES_OPER_ERROR, err_msg);
+      repopulate_page();
       termsize_adjust();
       tui_redraw();
       doupdate();
     }
 
-    // Free previous `results`
-    if (NULL != results && results_len > 0)
-      free(results);
+    // If user hit TAB, switch to the next search mode (plain text, regex, or
+    // multi-term)
+    if (-0x09 == got_inpt) {
+      if (re) {
+        re = false;
+        multi = true;
+      } else if (multi)
+        multi = false;
+      else
+        re = true;
+    }
 
-    // Populate `results` and `results_len`
-    if (0 == wcslen(inpt)) {
-      // Input is empty; set `results` to NULL, `results_len` to 0, and `my_top`
-      // to `page_top`
-      results = NULL;
-      results_len = 0;
-      my_top = page_top;
-    } else {
-      // Input is not empty; populate `results` and `results_len` from input,
-      // and set `my_top` to the location of the first match
-      results_len = search(&results, inpt, page, page_len,
-                           config.capabilities.icase_search);
-      if (back) {
-        const int tmp = search_prev(results, results_len, my_top);
-        my_top = -1 == tmp ? my_top : tmp;
+    // Search the page a slice at a time, redrawing after each slice, until
+    // either the whole page has been searched or the user has typed something
+    base = my_top;
+    do {
+      // Free previous `results`
+      if (NULL != results && results_len > 0)
+        free(results);
+
+      // Populate `results` and `results_len`
+      if (0 == wcslen(inpt)) {
+        // Input is empty; set `results` to NULL, `results_len` to 0, and
+        // `my_top` to `page_top`
+        results = NULL;
+        results_len = 0;
+        my_top = page_top;
+        isearch_reset();
       } else {
-        const int tmp = search_next(results, results_len, my_top);
-        my_top = -1 == tmp ? my_top : tmp;
+        // Input is not empty; populate `results` and `results_len` from
+        // input, and set `my_top` to the location of the first match
+        results_len =
+            search_inc(&results, inpt, page, page_len,
+                       config.capabilities.icase_search, re, multi, base,
+                       SEARCH_SLICE);
+        my_top = search_top(base, back);
       }
-      if (my_top + config.layout.main_height > page_len) {
-        if (page_len >= config.layout.main_height)
-          my_top = MIN(my_top, page_len - config.layout.main_height);
-        else
-          my_top = 0;
-      }
-    }
 
-    // Redraw all windows, scrolling over to `my_top`
-    draw_page(page, page_len, my_top, page_flink);
-    draw_sbar(page_len, my_top);
-    swprintf(pout, BS_SHORT, L"%ls%ls", prompt, inpt);
-    if (0 == results_len) {
-      draw_stat(L"SEARCH", page_title, page_len, my_top + 1,
-                page_left / config.layout.tabstop + 1, pout, NULL,
-                L"Search string not found");
-      cbeep();
-    } else {
-      draw_stat(L"SEARCH", page_title, page_len, my_top + 1,
-                page_left / config.layout.tabstop + 1, pout, help, NULL);
-    }
-    doupdate();
+      // Redraw all windows, scrolling over to `my_top`
+      draw_page(page, page_len, my_top, page_flink);
+      draw_sbar(page_len, my_top);
+      swprintf(pout, BS_SHORT, L"%ls%ls", prompt, inpt);
+      if (0 == results_len && !isearch_pending()) {
+        draw_stat(search_mode, page_title, page_len, my_top + 1,
+                  page_left / config.layout.tabstop + 1, pout, NULL,
+                  L"Search string not found");
+        cbeep();
+      } else {
+        draw_stat(search_mode, page_title, page_len, my_top + 1,
+                  page_left / config.layout.tabstop + 1, pout, help, NULL);
+      }
+      doupdate();
+    } while (isearch_pending() && !input_pending());
 
     // Get next user input
     got_inpt = get_str_next(wstat, 1, 1, NULL, 0);
   }
 
   if (got_inpt > 0) {
-    // User entered a string and hit ENTER; retain search results
+    // User entered a string and hit ENTER; retain search results. If the user
+    // was quicker than the search, scan the rest of the page first, so that
+    // the results cover all of it.
+    if (isearch_pending()) {
+      if (NULL != results && results_len > 0)
+        free(results);
+      results_len =
+          search_inc(&results, inpt, page, page_len,
+                     config.capabilities.icase_search, re, multi, base, 0);
+      my_top = search_top(base, back);
+    }
     page_top = my_top;
     const link_loc_t fl = first_link(page, page_len, page_top,
                                      page_top + config.layout.main_height - 1);
@@ -2430,9 +2656,7 @@ bool tui_help() {
     if (termsize_changed()) {
       del_imm();
       init_windows();
-      populate_page();
-      if (err)
-        winddown(ES_OPER_ERROR, err_msg);
+      repopulate_page();
       termsize_adjust();
       tui_redraw();
       top = 1;
@@ -2472,7 +2696,8 @@ bool tui_mouse_click(short y, short x) {
     unsigned ln = page_top + my; // line number that corresponds to `my`
     if (ln < page_len) {
       for (unsigned i = 0; i < page[ln].links_length; i++) {
-        if (mx >= page[ln].links[i].start && mx < page[ln].links[i].end) {
+        const link_t *link = &line_at(page, ln)->links[i]; // current link
+        if (mx >= link->start && mx < link->end) {
           page_flink.ok = true;
           page_flink.line = ln;
           page_flink.link = i;
@@ -2569,6 +2794,8 @@ bool tui_mouse_dnd(short y, short x, short dy, short dx) {
 void tui() {
   int input;                // keyboard/mouse input from user
   bool redraw = true;       // set this to true to redraw the screen
+  bool ahead = false;       // set to true if `input` has already been read
+  unsigned folded = 0;      // number of motions performed since last frame
   wchar_t errmsg[BS_SHORT]; // error message
   swprintf(errmsg, BS_SHORT, L"Invalid keystroke; press %ls for help",
            ch2name(config.keys[PA_HELP][0]));
@@ -2597,13 +2824,39 @@ void tui() {
   init_windows();
 
   // Initialize `page`, `page_len`, `page_title`, `page_top`, `page_left`, and
-  // `page_flink`
-  populate_page();
-  if (err)
-    winddown(ES_NOT_FOUND, err_msg);
-  page_top = 0;
-  page_left = 0;
-  page_flink = next_link(page, page_len, page_flink);
+  // `page_flink` (but if the user asked for it, restore `history` and the
+  // user's location from the last saved session, and also restore `page` if it
+  // doesn't have to be rendered again). If the user has also asked for a page
+  // other than the index, show it on top of the restored history.
+  request_type_t req_rt = RT_NONE; // page requested along with the session
+  wchar_t *req_args = NULL;        // its arguments
+  if (resume_mode && RT_INDEX != history[history_cur].request_type) {
+    req_rt = history[history_cur].request_type;
+    if (NULL != history[history_cur].args)
+      req_args = xwcsdup(history[history_cur].args);
+  }
+  bool resumed = resume_mode && session_load();
+  if (resumed && RT_NONE != req_rt) {
+    history_push(req_rt, req_args);
+    if (NULL != page) {
+      lines_free(page, page_len);
+      page = NULL;
+      page_len = 0;
+    }
+    resumed = false;
+  }
+  free(req_args);
+  if (NULL == page) {
+    populate_page();
+    if (err)
+      winddown(ES_NOT_FOUND, err_msg);
+  }
+  page_width = config.layout.main_width;
+  if (!resumed) {
+    page_top = 0;
+    page_left = 0;
+    page_flink = next_link(page, page_len, page_flink);
+  }
 
   // Initialize `action`
   action = PA_NULL;
@@ -2612,19 +2865,33 @@ void tui() {
     // If terminal size has changed, regenerate `page` and ask for a redraw
     if (termsize_changed()) {
       init_windows();
-      populate_page();
-      if (err)
-        winddown(ES_OPER_ERROR, err_msg);
+      repopulate_page();
       termsize_adjust();
       redraw = true;
     }
 
+    // If the last action moved up or down the page and more input is already
+    // waiting, read it; if that's another motion, perform it before drawing a
+    // frame, so that auto-repeated keys and mouse wheel spins are folded into
+    // a single frame
+    bool fold = false; // set this to true to skip drawing a frame
+    if (!ahead && is_motion(action, mouse_status) && input_pending()) {
+      input = getch();
+      action = get_action(input);
+      mouse_status = get_mouse_status(input);
+      ahead = true;
+      fold = is_motion(action, mouse_status) && ++folded < INPUT_BATCH;
+    }
+
     // If redraw is necessary, redraw
-    if (redraw) {
-      tui_redraw();
-      redraw = false;
+    if (!fold) {
+      if (redraw) {
+        tui_redraw();
+        redraw = false;
+      }
+      doupdate();
+      folded = 0;
     }
-    doupdate();
 
     // Get user input
     if (PA_NULL != first_action) {
@@ -2632,19 +2899,23 @@ void tui() {
       // perform upon startup
       action = first_action;
       first_action = PA_NULL;
+    } else if (ahead) {
+      // Edge case: input has already been read above
+      ahead = false;
     } else {
       input = cgetch();
       action = get_action(input);
       mouse_status = get_mouse_status(input);
     }
 
-    // Perform the requested action
+    // Perform the requested action (motions must not cancel a redraw that has
+    // been put off by folding, see above)
     switch (action) {
     case PA_UP:
-      redraw = tui_up();
+      redraw = tui_up() || redraw;
       break;
     case PA_DOWN:
-      redraw = tui_down();
+      redraw = tui_down() || redraw;
       break;
     case PA_LEFT:
       redraw = tui_left();
@@ -2653,10 +2924,10 @@ void tui() {
       redraw = tui_right();
       break;
     case PA_PGUP:
-      redraw = tui_pgup();
+      redraw = tui_pgup() || redraw;
       break;
     case PA_PGDN:
-      redraw = tui_pgdn();
+      redraw = tui_pgdn() || redraw;
       break;
     case PA_HOME:
       redraw = tui_home();
@@ -2682,6 +2953,9 @@ void tui() {
     case PA_SP_WHATIS:
       redraw = tui_sp_open(RT_WHATIS);
       break;
+    case PA_SP_FULLTEXT:
+      redraw = tui_sp_open(RT_FULLTEXT);
+      break;
     case PA_INDEX:
       redraw = tui_index();
       break;
@@ -2718,10 +2992,10 @@ void tui() {
     default:
       if (WH_UP == mouse_status.wheel) {
         // Mouse wheel scroll up causes `PA_UP`
-        redraw = tui_up();
+        redraw = tui_up() || redraw;
       } else if (WH_DOWN == mouse_status.wheel) {
         // Mouse wheel scroll down causes `PA_DOWN`
-        redraw = tui_down();
+        redraw = tui_down() || redraw;
       } else if (BT_WHEEL == mouse_status.button && mouse_status.up) {
         // Mouse wheel click causes `PA_OPEN`
         redraw = tui_open();
@@ -2740,4 +3014,8 @@ void tui() {
       break;
     }
   }
+
+  // Save the session, so that it can be restored with `-R`
+  if (config.misc.save_session || resume_mode)
+    session_save();
 }
@@ -50,6 +50,15 @@ typedef struct {
   short x;             // cursor horizontal position
 } mouse_t;
 
+// A row of `wmain`, as it's being painted by `draw_page()`
+typedef struct {
+  wchar_t *text;  // characters (one per column)
+  attr_t *attrs;  // text attributes of `text`
+  short *pairs;   // color pairs of `text`
+  unsigned width; // number of columns
+  unsigned len;   // number of columns to be painted (the rest are left blank)
+} row_t;
+
 //
 // Constants
 //
@@ -57,6 +66,14 @@ typedef struct {
 // empty mouse status (used for initialization)
 #define MS_EMPTY {BT_NONE, false, false, false, -1, -1, WH_NONE, -1, -1}
 
+// Number of lines searched between checks for user input, while the user types
+// a search string (see `tui_search()`)
+#define SEARCH_SLICE 4096
+
+// Maximum number of queued-up motions performed between two frames (see
+// `tui()`)
+#define INPUT_BATCH 64
+
 // Return values of `get_str_next()` (more info in its docstring)
 #define _GSN (1 << 24)
 #define GSN_WH_DOWN (_GSN)
@@ -92,6 +109,21 @@ extern action_t action;
 // Latest mouse status
 extern mouse_t mouse_status;
 
+// True if, since `wmain` was last drawn, nothing but `page_top` and
+// `page_flink` has changed (set by `tui_up()` and `tui_down()`), in which case
+// `tui_redraw()` scrolls `wmain` instead of drawing it anew
+extern bool scroll_only;
+
+// Value of `lines_top` when `wmain` was last drawn
+extern unsigned wmain_top;
+
+// Value of `flink` when `wmain` was last drawn
+extern link_loc_t wmain_flink;
+
+// Value of `config.layout.main_width` when `page` was last populated, or 0 if
+// `page` must be populated again regardless (see `repopulate_page()`)
+extern unsigned page_width;
+
 //
 // Macros
 //
@@ -170,6 +202,9 @@ extern void sendescseq(char *s);
 // also call all `draw..()` functions as needed.
 extern void init_windows();
 
+// Return true if user input is waiting to be read
+extern bool input_pending();
+
 // If terminal width and/or height have changed, update `config.layout` and
 // return true. Otherwise, return false.
 extern bool termsize_changed();
@@ -186,6 +221,12 @@ extern wchar_t *ch2name(int k);
 // calling `tui_redraw()`.
 extern void termsize_adjust();
 
+// Populate `page` again (or exit with an error, if that fails), unless it was
+// populated for the current `config.layout.main_width` and nothing else that
+// affects it has changed since (see `page_width`). Must be called whenever
+// `termsize_changed()` returned true, right after `init_windows()`.
+extern void repopulate_page();
+
 // Draw a box in `w`, starting at (`tl_y`, `tl_x`) and ending at
 // (`br_y`, `br_x`)
 extern void draw_box(WINDOW *w, unsigned tl_y, unsigned tl_x, unsigned br_y,
@@ -198,6 +239,13 @@ extern void draw_box(WINDOW *w, unsigned tl_y, unsigned tl_x, unsigned br_y,
 extern void draw_page(line_t *lines, unsigned lines_len, unsigned lines_top,
                       link_loc_t flink);
 
+// Same as `draw_page()`, but assume that `wmain` still shows `lines` the way it
+// was last drawn, with a different `lines_top` and `flink`. Scroll `wmain`
+// accordingly, and only draw the rows that have been exposed, and those whose
+// link focus has changed.
+extern void draw_page_scroll(line_t *lines, unsigned lines_len,
+                             unsigned lines_top, link_loc_t flink);
+
 // Draw the scrollbar in `wsbar`. `lines_len` is total number of lines in the
 // page being displayed, and `lines_top` the line number where the visible
 // portion of said page begins.
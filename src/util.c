@@ -326,6 +326,30 @@ size_t xmbstowcs(wchar_t *dest, const char *src, size_t n) {
   return res;
 }
 
+int xpipe(int pipefd[2]) {
+  const int res = pipe(pipefd);
+
+  if (-1 == res) {
+    static wchar_t errmsg[BS_SHORT];
+    serror(errmsg, L"Unable to pipe()");
+    winddown(ES_OPER_ERROR, errmsg);
+  }
+
+  return res;
+}
+
+pid_t xfork() {
+  const pid_t res = fork();
+
+  if (-1 == res) {
+    static wchar_t errmsg[BS_SHORT];
+    serror(errmsg, L"Unable to fork()");
+    winddown(ES_OPER_ERROR, errmsg);
+  }
+
+  return res;
+}
+
 int xsystem(const char *cmd, bool fail) {
   int res = system(cmd);
 
@@ -515,6 +539,28 @@ char *lzma_decompress(const char *pathname) {
 #endif
 }
 
+// Helper of `aropen()`. Try to memory-map the uncompressed file opened as
+// `a->fp_none`. On failure, or if the file isn't a regular non-empty file,
+// leave `a->map` set to NULL, so that reading falls back to `fp_none`.
+void armap(archive_t *a) {
+  struct stat st;
+  const int fd = fileno(a->fp_none);
+
+  a->map = NULL;
+  a->map_len = 0;
+  a->map_pos = 0;
+
+  if (-1 == fstat(fd, &st) || !S_ISREG(st.st_mode) || 0 == st.st_size)
+    return;
+
+  void *const map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (MAP_FAILED == map)
+    return;
+
+  a->map = map;
+  a->map_len = st.st_size;
+}
+
 archive_t aropen(const char *pathname) {
   archive_t a;
   char *pathext = strrchr(pathname, '.');
@@ -530,6 +576,11 @@ archive_t aropen(const char *pathname) {
   else
     a.type = AR_NONE;
 
+  a.map = NULL;
+  a.map_len = 0;
+  a.map_pos = 0;
+  a.buf = NULL;
+
   switch (a.type) {
   case AR_LZMA:
     a.path = lzma_decompress(pathname);
@@ -551,74 +602,112 @@ archive_t aropen(const char *pathname) {
   default:
     a.path = xstrdup(pathname);
     a.fp_none = xfopen(a.path, "r");
+    armap(&a);
     break;
   }
 
+  if (NULL == a.map)
+    a.buf = salloc(BS_LINE);
+
   return a;
 }
 
-void argets(archive_t ap, char *buf, int len) {
-  switch (ap.type) {
+void argets(archive_t *ap, char *buf, int len) {
+  switch (ap->type) {
   case AR_LZMA:
-    xfgets(buf, len, ap.fp_lzma);
+    xfgets(buf, len, ap->fp_lzma);
     break;
   case AR_BZIP2:
-    xfgets(buf, len, ap.fp_bzip2);
+    xfgets(buf, len, ap->fp_bzip2);
     break;
   case AR_GZIP:
 #ifdef QMAN_GZIP
-    xgzgets(ap.fp_gzip, buf, len);
+    xgzgets(ap->fp_gzip, buf, len);
 #endif
     break;
   case AR_NONE:
   default:
-    xfgets(buf, len, ap.fp_none);
+    if (NULL != ap->map) {
+      const char *line;
+      size_t line_len = arline(ap, &line);
+      if (line_len > len - 1)
+        line_len = len - 1;
+      memcpy(buf, line, line_len);
+      buf[line_len] = '\0';
+    } else
+      xfgets(buf, len, ap->fp_none);
+  }
+}
+
+size_t arline(archive_t *ap, const char **line) {
+  if (NULL != ap->map) {
+    // Memory-mapped: find the end of the current line using `memchr()`, and
+    // return a pointer into the map
+    const char *const beg = ap->map + ap->map_pos;
+    const size_t rem = ap->map_len - ap->map_pos;
+    const char *const nl = memchr(beg, '\n', rem);
+    const size_t len = NULL == nl ? rem : (size_t)(nl - beg) + 1;
+
+    ap->map_pos += len;
+    *line = beg;
+    return len;
   }
+
+  // Otherwise, read into `ap->buf`
+  ap->buf[0] = '\0';
+  argets(ap, ap->buf, BS_LINE);
+  *line = ap->buf;
+  return strlen(ap->buf);
 }
 
-bool areof(archive_t ap) {
-  switch (ap.type) {
+bool areof(archive_t *ap) {
+  switch (ap->type) {
   case AR_LZMA:
-    return feof(ap.fp_lzma);
+    return feof(ap->fp_lzma);
     break;
   case AR_BZIP2:
-    return feof(ap.fp_bzip2);
+    return feof(ap->fp_bzip2);
     break;
   case AR_GZIP:
 #ifdef QMAN_GZIP
-    return gzeof(ap.fp_gzip);
+    return gzeof(ap->fp_gzip);
 #else
     return false;
 #endif
     break;
   case AR_NONE:
   default:
-    return feof(ap.fp_none);
+    if (NULL != ap->map)
+      return ap->map_pos >= ap->map_len;
+    return feof(ap->fp_none);
   }
 }
 
-void arclose(archive_t ap) {
-  switch (ap.type) {
+void arclose(archive_t *ap) {
+  switch (ap->type) {
   case AR_LZMA:
-    xfclose(ap.fp_lzma);
-    unlink(ap.path);
+    xfclose(ap->fp_lzma);
+    unlink(ap->path);
     break;
   case AR_BZIP2:
-    xfclose(ap.fp_bzip2);
-    unlink(ap.path);
+    xfclose(ap->fp_bzip2);
+    unlink(ap->path);
     break;
   case AR_GZIP:
 #ifdef QMAN_GZIP
-    xgzclose(ap.fp_gzip);
+    xgzclose(ap->fp_gzip);
 #endif
     break;
   case AR_NONE:
   default:
-    xfclose(ap.fp_none);
+    if (NULL != ap->map)
+      munmap(ap->map, ap->map_len);
+    xfclose(ap->fp_none);
     break;
   }
 
-  free(ap.path);
+  free(ap->buf);
+  free(ap->path);
 }
 
 void wafree(wchar_t **buf, unsigned buf_len) {
@@ -755,6 +844,28 @@ void wwrap(wchar_t *trgt, unsigned cols) {
   }
 }
 
+unsigned wwrap_count(const wchar_t *src, unsigned len, unsigned cols) {
+  unsigned line_start = 0, line_end;
+  unsigned res = 0;
+
+  if (0 == len)
+    return 0;
+
+  while (len > line_start + cols) {
+    for (line_end = line_start + cols;
+         line_end > line_start && src[line_end] != L' ' &&
+         src[line_end] != L'\t';
+         line_end--)
+      ;
+    if (line_end == line_start)
+      break;
+    res++;
+    line_start = line_end + 1;
+  }
+
+  return res + 1;
+}
+
 bool wmemberof(const wchar_t *const *hayst, const wchar_t *needle,
                unsigned hayst_len) {
   unsigned i;
@@ -1061,6 +1172,218 @@ range_t fr_search(const full_regex_t *re, const wchar_t *src) {
   return res;
 }
 
+void ac_init(ac_t *ac, const wchar_t *const *terms, unsigned terms_len,
+             bool cs) {
+  unsigned t, j;      // iterators
+  unsigned n, u;      // nodes
+  unsigned size = 1;  // maximum number of nodes
+
+  for (t = 0; t < terms_len; t++)
+    size += wcslen(terms[t]);
+  ac->nodes = aalloc(size, ac_node_t);
+  ac->nodes[0].term = -1;
+  ac->nodes_len = 1;
+
+  // Build the trie
+  for (t = 0; t < terms_len; t++) {
+    if (L'\0' == terms[t][0])
+      continue;
+    u = 0;
+    for (j = 0; L'\0' != terms[t][j]; j++) {
+      const wchar_t c = cs ? towlower(terms[t][j]) : terms[t][j];
+      for (n = ac->nodes[u].child; 0 != n && c != ac->nodes[n].c;
+           n = ac->nodes[n].sibling)
+        ;
+      if (0 == n) {
+        n = ac->nodes_len++;
+        ac->nodes[n].c = c;
+        ac->nodes[n].sibling = ac->nodes[u].child;
+        ac->nodes[n].term = -1;
+        ac->nodes[n].depth = ac->nodes[u].depth + 1;
+        ac->nodes[u].child = n;
+      }
+      u = n;
+    }
+    if (-1 == ac->nodes[u].term)
+      ac->nodes[u].term = t;
+  }
+
+  // Set the `fail` and `out` links in breadth-first order, so that the links
+  // of all shallower nodes are already in place when a node is visited
+  unsigned *queue = aalloc(ac->nodes_len, unsigned); // nodes to visit
+  unsigned qhead = 0, qtail = 0;                     // `queue` head and tail
+  for (n = ac->nodes[0].child; 0 != n; n = ac->nodes[n].sibling)
+    queue[qtail++] = n;
+  while (qhead < qtail) {
+    u = queue[qhead++];
+    for (n = ac->nodes[u].child; 0 != n; n = ac->nodes[n].sibling) {
+      const unsigned f = ac_next(ac, ac->nodes[u].fail, ac->nodes[n].c);
+      ac->nodes[n].fail = f;
+      ac->nodes[n].out = -1 == ac->nodes[f].term ? ac->nodes[f].out : f;
+      queue[qtail++] = n;
+    }
+  }
+  free(queue);
+}
+
+unsigned ac_next(const ac_t *ac, unsigned state, wchar_t c) {
+  unsigned n; // iterator
+
+  while (true) {
+    for (n = ac->nodes[state].child; 0 != n; n = ac->nodes[n].sibling)
+      if (c == ac->nodes[n].c)
+        return n;
+    if (0 == state)
+      return 0;
+    state = ac->nodes[state].fail;
+  }
+}
+
+void ac_free(ac_t *ac) {
+  if (NULL != ac->nodes)
+    free(ac->nodes);
+  ac->nodes = NULL;
+  ac->nodes_len = 0;
+}
+
+// Helper of `fz_mask()` and `fz_score()`. Return `c` in lower case (ASCII
+// characters, which most page names consist of, are converted without
+// consulting the locale).
+wchar_t fz_lower(wchar_t c) {
+  if (c < 0x80)
+    return c >= L'A' && c <= L'Z' ? c + (L'a' - L'A') : c;
+  return towlower(c);
+}
+
+// Helper of `fz_score()`. Return the class of character `c`.
+fz_class_t fz_class(wchar_t c) {
+  if (c < 0x80) {
+    if (c >= L'a' && c <= L'z')
+      return FZ_LOWER;
+    if (c >= L'A' && c <= L'Z')
+      return FZ_UPPER;
+    if (c >= L'0' && c <= L'9')
+      return FZ_NUMBER;
+  }
+  if (iswspace(c))
+    return FZ_WHITE;
+  if (iswlower(c))
+    return FZ_LOWER;
+  if (iswupper(c))
+    return FZ_UPPER;
+  if (iswdigit(c))
+    return FZ_NUMBER;
+  if (NULL != wcschr(L"/,:;|-_.(", c))
+    return FZ_DELIMITER;
+  if (iswalpha(c))
+    return FZ_LOWER;
+  return FZ_NONWORD;
+}
+
+// Helper of `fz_score()`. Return the bonus for matching a character of class
+// `class` that follows a character of class `prev_class`.
+int fz_bonus(fz_class_t prev_class, fz_class_t class) {
+  if (class > FZ_DELIMITER) {
+    // Word characters
+    if (FZ_WHITE == prev_class)
+      return FZ_BOUNDARY_WHITE;
+    if (FZ_DELIMITER == prev_class)
+      return FZ_BOUNDARY_DELIM;
+    if (FZ_NONWORD == prev_class)
+      return FZ_BOUNDARY;
+  }
+  if ((FZ_LOWER == prev_class && FZ_UPPER == class) ||
+      (FZ_NUMBER != prev_class && FZ_NUMBER == class))
+    return FZ_CAMEL;
+  if (FZ_WHITE == class)
+    return FZ_BOUNDARY_WHITE;
+  if (FZ_NONWORD == class || FZ_DELIMITER == class)
+    return FZ_BOUNDARY;
+  return 0;
+}
+
+unsigned long long fz_mask(const wchar_t *src) {
+  unsigned long long res = 0; // return value
+  wchar_t c;                  // current character
+
+  for (; L'\0' != *src; src++) {
+    c = fz_lower(*src);
+    if (c >= L'a' && c <= L'z')
+      res |= 1ULL << (c - L'a');
+    else if (c >= L'0' && c <= L'9')
+      res |= 1ULL << (26 + c - L'0');
+    else
+      res |= 1ULL << (36 + c % 28);
+  }
+
+  return res;
+}
+
+int fz_score(const wchar_t *needle, const wchar_t *hayst, bool cs) {
+  const unsigned needle_len = wcslen(needle); // length of `needle`
+  int sidx = -1, eidx = -1; // beginning and end of the matched part of `hayst`
+  unsigned i, j;            // iterators
+  wchar_t c;                // current character of `hayst`
+
+  if (0 == needle_len)
+    return 0;
+
+  // Find the end of the first occurence of `needle` as a subsequence of
+  // `hayst`, and then scan backwards from there, to find the shortest such
+  // occurence that ends there
+  for (i = 0, j = 0; L'\0' != hayst[i]; i++) {
+    c = cs ? fz_lower(hayst[i]) : hayst[i];
+    if (c == needle[j] && ++j == needle_len) {
+      eidx = i + 1;
+      break;
+    }
+  }
+  if (-1 == eidx)
+    return -1;
+  for (i = eidx, j = needle_len; i > 0; i--) {
+    c = cs ? fz_lower(hayst[i - 1]) : hayst[i - 1];
+    if (c == needle[j - 1] && 0 == --j) {
+      sidx = i - 1;
+      break;
+    }
+  }
+
+  // Score the characters in between
+  int res = 0;                   // return value
+  bool in_gap = false;           // whether a gap has started
+  unsigned consecutive = 0;      // length of current run of matched characters
+  int bonus, first_bonus = 0;    // bonus of current, and of first run character
+  fz_class_t class, prev_class;  // classes of current and previous characters
+  prev_class = sidx > 0 ? fz_class(hayst[sidx - 1]) : FZ_WHITE;
+  for (i = sidx, j = 0; i < eidx; i++) {
+    c = cs ? fz_lower(hayst[i]) : hayst[i];
+    class = fz_class(hayst[i]);
+    if (j < needle_len && c == needle[j]) {
+      res += FZ_MATCH;
+      bonus = fz_bonus(prev_class, class);
+      if (0 == consecutive)
+        first_bonus = bonus;
+      else {
+        if (bonus >= FZ_BOUNDARY && bonus > first_bonus)
+          first_bonus = bonus;
+        bonus = MAX(bonus, MAX(first_bonus, FZ_CONSECUTIVE));
+      }
+      res += 0 == j ? 2 * bonus : bonus;
+      in_gap = false;
+      consecutive++;
+      j++;
+    } else {
+      res += in_gap ? FZ_GAP_EXTENSION : FZ_GAP_START;
+      in_gap = true;
+      consecutive = 0;
+      first_bonus = 0;
+    }
+    prev_class = class;
+  }
+
+  return MAX(0, res);
+}
+
 void loggit(const char *msg) {
   static FILE *lfp = NULL;
 
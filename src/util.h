@@ -41,6 +41,34 @@ typedef struct {
                  // to improve performance, as `regexec()` is quite expensive)
 } full_regex_t;
 
+// A node of an Aho-Corasick automaton (see `ac_t`)
+typedef struct {
+  wchar_t c;        // character on the edge that leads to this node
+  unsigned child;   // first child, or 0
+  unsigned sibling; // next sibling, or 0
+  unsigned fail;    // node of the longest proper suffix that's in the trie
+  unsigned out;     // nearest node on the `fail` chain that ends a term, or 0
+  int term;         // no. of the term that ends at this node, or -1
+  unsigned depth;   // length of the string that leads to this node
+} ac_node_t;
+
+// An Aho-Corasick automaton, that finds all occurrences of several terms in a
+// single pass over some text
+typedef struct {
+  ac_node_t *nodes;   // nodes (node 0 is the root)
+  unsigned nodes_len; // number of nodes
+} ac_t;
+
+// Classes of characters, as far as fuzzy matching is concerned
+typedef enum {
+  FZ_WHITE,     // whitespace
+  FZ_NONWORD,   // punctuation, other than `FZ_DELIMITER`
+  FZ_DELIMITER, // a character that separates words in names (e.g. '-' or '.')
+  FZ_LOWER,     // lower-case letter
+  FZ_UPPER,     // upper-case letter
+  FZ_NUMBER     // digit
+} fz_class_t;
+
 // A range
 typedef struct {
   unsigned beg; // beginning
@@ -66,6 +94,10 @@ typedef struct {
 #endif
   FILE *fp_bzip2; // file pointer if bzip2
   FILE *fp_lzma;  // file pointer if xz
+  char *map;      // memory-mapped contents if uncompressed (or NULL)
+  size_t map_len; // length of `map`
+  size_t map_pos; // current read position in `map`
+  char *buf;      // line buffer used by `arline()` if `map` is NULL
 } archive_t;
 
 //
@@ -77,6 +109,16 @@ typedef struct {
 #define BS_LINE 1024   // length of an array that is suitable for a line of text
 #define BS_LONG 131072 // length of a long array
 
+// Fuzzy matching scores (see `fz_score()`)
+#define FZ_MATCH 16          // a matched character
+#define FZ_GAP_START -3      // the first unmatched character after a match
+#define FZ_GAP_EXTENSION -1  // any other unmatched character
+#define FZ_BOUNDARY 8        // a match at the beginning of a word
+#define FZ_BOUNDARY_WHITE 10 // a match that follows whitespace
+#define FZ_BOUNDARY_DELIM 9  // a match that follows a delimiter
+#define FZ_CAMEL 7           // a match at a camelCase or letter-digit boundary
+#define FZ_CONSECUTIVE 4     // a match that continues a run of matches
+
 // Rudimentary logging, used for debugging
 #define F_LOG "./qman.log" // log file
 
@@ -264,6 +306,12 @@ extern size_t xwcstombs(char *dest, const wchar_t *src, size_t n);
 // Safely call mbstowcs()
 size_t xmbstowcs(wchar_t *dest, const char *src, size_t n);
 
+// Safely call `pipe()`
+extern int xpipe(int pipefd[2]);
+
+// Safely call `fork()`
+extern pid_t xfork();
+
 // Safely call `system(cmd)`, to execute `cmd` in a new shell. If `fail` is
 // true, and the return value of `system()` is non-zero, terminate. Otherwise
 // return said return value.
@@ -305,13 +353,19 @@ extern archive_t aropen(const char *pathname);
 
 // Read a line of text from "fat" file pointer `ap`, and place it into `buf`,
 // `len` being the length of `buf`
-extern void argets(archive_t ap, char *buf, int len);
+extern void argets(archive_t *ap, char *buf, int len);
+
+// Read a line of text from "fat" file pointer `ap` without copying it if
+// possible. Set `line` to point to its beginning, and return its length
+// (including the trailing newline, if any), or 0 on `EOF`. The line is not
+// NUL-terminated, and remains valid until the next call.
+extern size_t arline(archive_t *ap, const char **line);
 
 // Return true if "fat" file pointer `ap` has reached `EOF`, false otherwise
-extern bool areof(archive_t ap);
+extern bool areof(archive_t *ap);
 
 // Close "fat" pointer `ap`
-extern void arclose(archive_t ap);
+extern void arclose(archive_t *ap);
 
 // Free all memory in an array of (wide) strings `buf`. `buf_len` is the length
 // of `buf`.
@@ -346,6 +400,11 @@ extern void wcrepl(wchar_t *dst, const wchar_t *hayst, wchar_t needle,
 // columns.
 extern void wwrap(wchar_t *trgt, unsigned cols);
 
+// Return the number of non-empty lines `wwrap()` would split the first `len`
+// characters of `src` into, without modifying it. `src` must not contain any
+// newlines.
+extern unsigned wwrap_count(const wchar_t *src, unsigned len, unsigned cols);
+
 // Return true if `needle` is in array of (wide) strings `hayst`, false
 // otherwise. `hayst_length` is the length of `hayst`.
 extern bool wmemberof(const wchar_t *const *hayst, const wchar_t *needle,
@@ -410,6 +469,33 @@ extern void fr_init(full_regex_t *re, char *str, wchar_t *snpt);
 // regular expressions, and has plumbing to make it work on `wchar_t*` strings.
 extern range_t fr_search(const full_regex_t *re, const wchar_t *src);
 
+// Build an Aho-Corasick automaton for `terms` (of length `terms_len`) into
+// `ac`. Empty terms are ignored. If `cs` is true, the terms are converted to
+// lower case, and text fed to `ac_next()` must be too.
+extern void ac_init(ac_t *ac, const wchar_t *const *terms, unsigned terms_len,
+                    bool cs);
+
+// Return the state `ac` moves to from `state` when fed character `c`. State 0
+// is the initial state. The terms that end at `c` are those of the returned
+// node (if its `term` isn't -1), and of all nodes on its `out` chain.
+extern unsigned ac_next(const ac_t *ac, unsigned state, wchar_t c);
+
+// Free the memory occupied by `ac`
+extern void ac_free(ac_t *ac);
+
+// Return the character signature of `src`: a bit mask with one bit set for each
+// class of (lower-cased) characters that occurs in `src`. `src` can't contain a
+// string as a subsequence, unless that string's signature is a subset of its
+// own.
+extern unsigned long long fz_mask(const wchar_t *src);
+
+// If `needle` is a subsequence of `hayst`, return a score that signifies how
+// well it matches, otherwise return -1. Matched characters that begin words,
+// follow separators, or continue a run of matched characters score higher, and
+// gaps between matched characters are penalized (as in fzf). If `cs` is true,
+// the match is case-insensitive, and `needle` must be in lower case.
+extern int fz_score(const wchar_t *needle, const wchar_t *hayst, bool cs);
+
 // Log `msg`, together with a timestamp, into `F_LOG`. Use this function only
 // temporarily for debugging, not in production.
 extern void loggit(const char *msg);